@@ -28,15 +28,18 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <string>
 #include <fstream>
 #include <functional>
 #include <streambuf>
+#include <thread>
 
 #include <simgrid/s4u.hpp>
 #include <smpi/smpi.h>
 #include <simgrid/plugins/energy.h>
 #include <simgrid/version.h>
+#include <xbt/config.hpp>
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string.hpp>
@@ -207,12 +210,34 @@ Execution context options:
                                      [default: 6379]
   --redis-prefix <prefix>            The Redis prefix. Ignored if --enable-redis is not set.
                                      [default: default]
+  --redis-verify-writes              Reads back every value written to Redis to check it.
+                                     This doubles the number of round trips with Redis.
+                                     Ignored if --enable-redis is not set.
+                                     [default: false]
 
 Output options:
   -e, --export <prefix>              The export filename prefix used to generate
                                      simulation output [default: out].
   --disable-schedule-tracing         Disables the Pajé schedule outputting.
   --disable-machine-state-tracing    Disables the machine state outputting.
+  --machine-states-sampling-period <period>
+                                     If strictly positive, at most one machine state
+                                     row is written per <period> seconds (the last
+                                     state of the period). Otherwise, one row is
+                                     written per distinct date [default: 0].
+  --export-buffer-size <size>        The size (in bytes) of the buffers used to write
+                                     output files. Files are written by background
+                                     I/O threads with double buffering [default: 65536].
+  --export-compression <format>      The compression format of the output files.
+                                     Available values: none, gzip.
+                                     Compressed files are suffixed by their
+                                     format extension (e.g., .gz) [default: none].
+  --export-jobs-columns <columns>    The comma-separated list of columns written
+                                     in the jobs output file, in order
+                                     (e.g., job_id,success,finish_time) [default: all].
+  --export-columnar                  Also writes the jobs, machine states and energy
+                                     outputs as typed columns in NumPy .npy files,
+                                     which can be memory-mapped by analysis tools.
 
 Platform size limit options:
   --mmax <nb>                        Limits the number of machines to <nb>.
@@ -236,6 +261,11 @@ Job-related options:
                                      garbage collected.
                                      The option --enable-dynamic-jobs must be set for this option to work.
                                      [default: false]
+  --compact-profile-tombstones       Forget the content of garbage collected profiles entirely.
+                                     Only their names are remembered (compactly) so that they
+                                     cannot be reused, which bounds memory usage when millions
+                                     of profiles are dynamically registered.
+                                     [default: false]
 
 Verbosity options:
   -v, --verbosity <verbosity_level>  Sets the Batsim verbosity level. Available
@@ -249,6 +279,14 @@ Workflow options:
                                      [default: 0].
   --ignore-beyond-last-workflow      Ignores workload jobs that occur after all
                                      workflows have completed.
+  --workflow-task-order <order>      The order in which the ready tasks of workflows
+                                     are submitted. Available values: fifo (in the
+                                     order they became ready), depth (smallest
+                                     top level first), critical-path (largest
+                                     bottom level first) [default: fifo].
+  --workflow-parsing-threads <nb>    The number of threads that read the workflow
+                                     files concurrently before the simulation
+                                     starts [default: 1].
 
 Other options:
   --dump-execution-context           Does not run the actual simulation but dumps the execution
@@ -267,6 +305,32 @@ Other options:
                                      Refer to SimGrid configuring documentation for more information.
   --sg-log <log_option>              Forwards a given logging option to SimGrid.
                                      Refer to SimGrid simulation logging documentation for more information.
+  --machine-properties-format <format>  How machine properties are sent to the scheduler
+                                     in SIMULATION_BEGINS. Available values: full
+                                     (properties of each machine), table (distinct
+                                     property sets sent once and referenced by index),
+                                     grouped (table, and machines of consecutive ids
+                                     with the same state and properties grouped by
+                                     interval) [default: full].
+  --sweep <sweep_file>               Runs a parameter sweep: Inputs are loaded once, then one
+                                     worker process per entry of the <sweep_file> JSON array is
+                                     forked to run its own simulation. Entries can override the
+                                     socket_endpoint, export_prefix, redis_prefix and sched_config
+                                     options. By default, the export and Redis prefixes of a worker
+                                     are suffixed by its index (e.g., out_3).
+                                     Please refer to Batsim's documentation for more information.
+  --sweep-parallelism <nb>           The maximum number of sweep workers that run at the
+                                     same time. 0 means no limit [default: 0].
+  --branch-at <time>                 Forks the whole simulation at simulated time <time>
+                                     into what-if branches, that continue the simulation
+                                     with their own scheduler (one branch per entry of the
+                                     --sweep file, or --branches). The original process goes
+                                     on with the original scheduler. Incompatible with Redis
+                                     and compressed outputs.
+  --branches <nb>                    The number of branches created by --branch-at if no
+                                     --sweep file is given. Branch i (from 1) connects to the
+                                     port of --socket-endpoint plus i, and its export prefix
+                                     is suffixed by _i [default: 0].
   --forward-unknown-events           Enables the forwarding to the scheduler of external events that
                                      are unknown to Batsim. Ignored if there were no event inputs with --events.
                                      [default: false]
@@ -474,12 +538,85 @@ Other options:
         error = true;
     }
     main_args.redis_prefix = args["--redis-prefix"].asString();
+    main_args.redis_verify_writes = args["--redis-verify-writes"].asBool();
 
     // Output options
     // **************
     main_args.export_prefix = args["--export"].asString();
     main_args.enable_schedule_tracing = !args["--disable-schedule-tracing"].asBool();
     main_args.enable_machine_state_tracing = !args["--disable-machine-state-tracing"].asBool();
+    main_args.export_columnar = args["--export-columnar"].asBool();
+
+    string sampling_period_str = args["--machine-states-sampling-period"].asString();
+    try
+    {
+        main_args.machine_state_sampling_period = std::stod(sampling_period_str);
+        if (main_args.machine_state_sampling_period < 0)
+        {
+            XBT_ERROR("The machine states sampling period %g ('%s') must be positive.",
+                      main_args.machine_state_sampling_period, sampling_period_str.c_str());
+            error = true;
+        }
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Cannot read the machine states sampling period '%s' as a number.", sampling_period_str.c_str());
+        error = true;
+    }
+
+    string export_buffer_size_str = args["--export-buffer-size"].asString();
+    try
+    {
+        long long export_buffer_size = std::stoll(export_buffer_size_str);
+        if (export_buffer_size <= 0)
+        {
+            XBT_ERROR("The export buffer size %lld ('%s') must be strictly positive.",
+                      export_buffer_size, export_buffer_size_str.c_str());
+            error = true;
+        }
+        else
+        {
+            main_args.export_buffer_size = static_cast<size_t>(export_buffer_size);
+        }
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Cannot read the export buffer size '%s' as an integer.", export_buffer_size_str.c_str());
+        error = true;
+    }
+
+    try
+    {
+        main_args.machine_properties_format = machine_properties_format_from_string(args["--machine-properties-format"].asString());
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Invalid machine properties format '%s'. Available values: full, table, grouped.",
+                  args["--machine-properties-format"].asString().c_str());
+        error = true;
+    }
+
+    try
+    {
+        main_args.export_compression = output_compression_from_string(args["--export-compression"].asString());
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Invalid export compression '%s'. Available values: none, gzip.",
+                  args["--export-compression"].asString().c_str());
+        error = true;
+    }
+
+    try
+    {
+        main_args.export_jobs_columns = jobs_columns_from_string(args["--export-jobs-columns"].asString());
+    }
+    catch (const std::exception & e)
+    {
+        XBT_ERROR("Invalid export jobs columns '%s': %s.",
+                  args["--export-jobs-columns"].asString().c_str(), e.what());
+        error = true;
+    }
 
     // Job-related options
     // *******************
@@ -487,6 +624,7 @@ Other options:
     main_args.dynamic_registration_enabled = args["--enable-dynamic-jobs"].asBool();
     main_args.ack_dynamic_registration = args["--acknowledge-dynamic-jobs"].asBool();
     main_args.profile_reuse_enabled = args["--enable-profile-reuse"].asBool();
+    main_args.compact_profile_tombstones = args["--compact-profile-tombstones"].asBool();
 
     if (main_args.profile_reuse_enabled && !main_args.dynamic_registration_enabled)
     {
@@ -546,6 +684,35 @@ Other options:
 
     main_args.terminate_with_last_workflow = args["--ignore-beyond-last-workflow"].asBool();
 
+    try
+    {
+        main_args.workflow_task_order = workflow_task_order_from_string(args["--workflow-task-order"].asString());
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Invalid workflow task order '%s'. Available values: fifo, depth, critical-path.",
+                  args["--workflow-task-order"].asString().c_str());
+        error = true;
+    }
+
+    string workflow_parsing_threads = args["--workflow-parsing-threads"].asString();
+    try
+    {
+        main_args.workflow_parsing_threads = std::stoi(workflow_parsing_threads);
+        if (main_args.workflow_parsing_threads <= 0)
+        {
+            XBT_ERROR("The number of workflow parsing threads %d ('%s') must be strictly positive.",
+                      main_args.workflow_parsing_threads, workflow_parsing_threads.c_str());
+            error = true;
+        }
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Cannot read the number of workflow parsing threads '%s' as an integer.",
+                  workflow_parsing_threads.c_str());
+        error = true;
+    }
+
     // Other options
     // *************
     main_args.dump_execution_context = args["--dump-execution-context"].asBool();
@@ -573,6 +740,111 @@ Other options:
         main_args.sched_config_file = args["--sched-cfg-file"].asString();
     }
 
+    if (args["--sweep"].isString())
+    {
+        const string sweep_file = args["--sweep"].asString();
+        if (!file_exists(sweep_file))
+        {
+            XBT_ERROR("Sweep file '%s' cannot be read.", sweep_file.c_str());
+            error = true;
+        }
+        else
+        {
+            try
+            {
+                main_args.sweep_workers = sweep_workers_from_json(read_whole_file_as_string(sweep_file));
+            }
+            catch (const std::exception & e)
+            {
+                XBT_ERROR("Invalid sweep file '%s': %s.", sweep_file.c_str(), e.what());
+                error = true;
+            }
+
+            // Workers connected to the same scheduler would mix their requests
+            for (size_t i = 0; i < main_args.sweep_workers.size(); ++i)
+            {
+                if (main_args.program_type == ProgramType::BATSIM && main_args.sweep_workers[i].socket_endpoint.empty())
+                {
+                    XBT_ERROR("Invalid sweep file '%s': worker %zu has no 'socket_endpoint'.", sweep_file.c_str(), i);
+                    error = true;
+                }
+            }
+        }
+    }
+
+    string sweep_parallelism = args["--sweep-parallelism"].asString();
+    try
+    {
+        main_args.sweep_parallelism = std::stoi(sweep_parallelism);
+        if (main_args.sweep_parallelism < 0)
+        {
+            XBT_ERROR("The sweep parallelism %d ('%s') must be positive.", main_args.sweep_parallelism,
+                      sweep_parallelism.c_str());
+            error = true;
+        }
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Cannot read the sweep parallelism '%s' as an integer.", sweep_parallelism.c_str());
+        error = true;
+    }
+
+    if (args["--branch-at"].isString())
+    {
+        string branch_at = args["--branch-at"].asString();
+        string branches = args["--branches"].asString();
+        try
+        {
+            main_args.branch_at = std::stod(branch_at);
+            if (main_args.branch_at < 0)
+            {
+                XBT_ERROR("The branch time %g ('%s') must be positive.", main_args.branch_at, branch_at.c_str());
+                error = true;
+            }
+
+            int nb_branches = std::stoi(branches);
+            if (nb_branches > 0 && main_args.sweep_workers.empty())
+            {
+                // Branch i uses the port of the main socket endpoint plus i
+                const size_t port_position = main_args.socket_endpoint.rfind(':');
+                const int port = std::stoi(main_args.socket_endpoint.substr(port_position + 1));
+                for (int branch = 1; branch <= nb_branches; ++branch)
+                {
+                    SweepWorker worker;
+                    worker.socket_endpoint = main_args.socket_endpoint.substr(0, port_position + 1) + to_string(port + branch);
+                    main_args.sweep_workers.push_back(worker);
+                }
+            }
+        }
+        catch (const std::exception &)
+        {
+            XBT_ERROR("Cannot read the branch time '%s' as a double, the number of branches '%s' as an integer, "
+                      "or the port of the socket endpoint '%s' as an integer.",
+                      branch_at.c_str(), branches.c_str(), main_args.socket_endpoint.c_str());
+            error = true;
+        }
+
+        if (main_args.sweep_workers.empty())
+        {
+            XBT_ERROR("--branch-at requires branches (via --sweep or --branches).");
+            error = true;
+        }
+        if (main_args.program_type != ProgramType::BATSIM || main_args.redis_enabled ||
+            main_args.export_compression != OutputCompression::NONE)
+        {
+            XBT_ERROR("--branch-at cannot be used with --no-sched, --enable-redis nor compressed outputs.");
+            error = true;
+        }
+        for (size_t i = 0; i < main_args.sweep_workers.size(); ++i)
+        {
+            if (!main_args.sweep_workers[i].redis_prefix.empty() || !main_args.sweep_workers[i].sched_config.empty())
+            {
+                XBT_ERROR("Branch %zu cannot set 'redis_prefix' nor 'sched_config', as branches continue an ongoing simulation.", i + 1);
+                error = true;
+            }
+        }
+    }
+
     main_args.simgrid_config = args["--sg-cfg"].asStringList();
     main_args.simgrid_logging = args["--sg-log"].asStringList();
 
@@ -584,7 +856,7 @@ void configure_batsim_logging_output(const MainArguments & main_args)
     vector<string> log_categories_to_set = {"workload", "job_submitter", "redis", "jobs", "machines", "pstate",
                                             "workflow", "jobs_execution", "server", "export", "profiles", "machine_range",
                                             "events", "event_submitter", "protocol",
-                                            "network", "ipp", "task_execution"};
+                                            "network", "ipp", "task_execution", "sweep"};
     string log_threshold_to_set = "critical";
 
     if (main_args.verbosity == VerbosityLevel::QUIET || main_args.verbosity == VerbosityLevel::NETWORK_ONLY)
@@ -640,6 +912,7 @@ void load_workloads_and_workflows(const MainArguments & main_args, BatsimContext
     }
 
     // Let's create the workflows
+    vector<pair<Workflow *, string>> workflows_to_load;
     for (const MainArguments::WorkflowDescription & desc : main_args.workflow_descriptions)
     {
         Workload * workload = Workload::new_static_workload(desc.workload_name, desc.filename);
@@ -651,8 +924,55 @@ void load_workloads_and_workflows(const MainArguments & main_args, BatsimContext
 
         Workflow * workflow = new Workflow(desc.name);
         workflow->start_time = desc.start_time;
-        workflow->load_from_xml(desc.filename);
         context->workflows.insert_workflow(desc.name, workflow);
+        workflows_to_load.emplace_back(workflow, desc.filename);
+    }
+
+    // Workflow files are independent: they can be read concurrently (before any simulation process exists).
+    // Workflow::load_from_xml neither logs nor aborts: errors are collected and reported by the main thread.
+    vector<string> workflow_loading_errors(workflows_to_load.size());
+    std::atomic<size_t> next_workflow_to_load(0);
+    auto load_workflows = [&workflows_to_load, &workflow_loading_errors, &next_workflow_to_load]()
+    {
+        for (size_t i = next_workflow_to_load++; i < workflows_to_load.size(); i = next_workflow_to_load++)
+        {
+            try
+            {
+                workflows_to_load[i].first->load_from_xml(workflows_to_load[i].second);
+            }
+            catch (const std::exception & e)
+            {
+                workflow_loading_errors[i] = e.what();
+            }
+        }
+    };
+
+    size_t nb_parsing_threads = std::min(static_cast<size_t>(main_args.workflow_parsing_threads), workflows_to_load.size());
+    vector<std::thread> parsing_threads;
+    for (size_t i = 1; i < nb_parsing_threads; ++i)
+    {
+        parsing_threads.emplace_back(load_workflows);
+    }
+    load_workflows();
+    for (std::thread & parsing_thread : parsing_threads)
+    {
+        parsing_thread.join();
+    }
+
+    for (size_t i = 0; i < workflows_to_load.size(); ++i)
+    {
+        Workflow * workflow = workflows_to_load[i].first;
+        const string & workflow_filename = workflows_to_load[i].second;
+        if (!workflow_loading_errors[i].empty())
+        {
+            xbt_die("Cannot load XML workflow '%s': %s", workflow_filename.c_str(), workflow_loading_errors[i].c_str());
+        }
+
+        XBT_INFO("XML workflow '%s' parsed sucessfully (%d tasks, %zu edges).",
+                 workflow_filename.c_str(), workflow->nb_tasks(), workflow->children_indexes.size());
+        XBT_INFO("Checking workflow validity...");
+        workflow->check_validity();
+        XBT_INFO("Workflow seems to be valid.");
     }
 
     // Let's compute how the number of machines to use should be limited
@@ -823,6 +1143,24 @@ int main(int argc, char * argv[])
     BatsimContext context;
     set_configuration(&context, main_args);
 
+    // Actors that run in parallel must not access the context at the same time
+    if (simgrid::config::get_value<int>("contexts/nthreads") > 1)
+    {
+        XBT_INFO("SimGrid actors run in parallel (contexts/nthreads=%d).",
+                 simgrid::config::get_value<int>("contexts/nthreads"));
+        context.shared_state_mutex = simgrid::s4u::Mutex::create();
+    }
+
+    // Branching forks the process, which duplicates the calling thread only
+    if (main_args.branch_at >= 0 &&
+        (simgrid::config::get_value<std::string>("contexts/factory") == "thread" ||
+         simgrid::config::get_value<int>("contexts/nthreads") > 1))
+    {
+        XBT_ERROR("--branch-at cannot be used if SimGrid actors run in threads "
+                  "(contexts/factory:thread or contexts/nthreads > 1).");
+        return 1;
+    }
+
     context.batsim_version = STR(BATSIM_VERSION);
     XBT_INFO("Batsim version: %s", context.batsim_version.c_str());
 
@@ -853,6 +1191,31 @@ int main(int argc, char * argv[])
     // Let's create the machines
     create_machines(main_args, &context, max_nb_machines_to_use);
 
+    // In sweep mode, workers are forked once inputs have been loaded so that they share them (copy-on-write).
+    // Outputs, Redis and the socket are worker-specific and are thus set up by each worker.
+    if (!main_args.sweep_workers.empty() && main_args.branch_at < 0)
+    {
+        int worker_index = -1;
+        if (!fork_workers(static_cast<int>(main_args.sweep_workers.size()), main_args.sweep_parallelism,
+                          worker_index, return_code))
+        {
+            return return_code;
+        }
+
+        const SweepWorker & worker = main_args.sweep_workers[static_cast<size_t>(worker_index)];
+        main_args.socket_endpoint = worker.socket_endpoint.empty() ? main_args.socket_endpoint : worker.socket_endpoint;
+        main_args.export_prefix = worker.export_prefix.empty() ? main_args.export_prefix + "_" + to_string(worker_index) : worker.export_prefix;
+        main_args.redis_prefix = worker.redis_prefix.empty() ? main_args.redis_prefix + "_" + to_string(worker_index) : worker.redis_prefix;
+        if (!worker.sched_config.empty())
+        {
+            main_args.sched_config = worker.sched_config;
+            main_args.sched_config_file.clear();
+        }
+        set_configuration(&context, main_args);
+
+        XBT_INFO("Running sweep worker %d (socket endpoint: '%s').", worker_index, main_args.socket_endpoint.c_str());
+    }
+
     // Let's prepare Batsim's outputs
     XBT_INFO("Batsim's export prefix is '%s'.", context.export_prefix.c_str());
     prepare_batsim_outputs(&context);
@@ -863,6 +1226,7 @@ int main(int argc, char * argv[])
         {
             // Let's prepare Redis' connection
             context.storage.set_instance_key_prefix(main_args.redis_prefix);
+            context.storage.set_write_verification(main_args.redis_verify_writes);
             context.storage.connect_to_server(main_args.redis_hostname, main_args.redis_port);
 
             // Let's store some metadata about the current instance in the data storage
@@ -883,6 +1247,14 @@ int main(int argc, char * argv[])
 
         // Let's execute the initial processes
         start_initial_simulation_processes(main_args, &context);
+
+        if (main_args.branch_at >= 0)
+        {
+            // The branching process must not keep the simulation alive if it ends before the branch time
+            auto branch_actor = simgrid::s4u::Actor::create("branch", context.machines.master_machine()->host,
+                                                            branch_process, &context, &main_args);
+            branch_actor->daemonize();
+        }
     }
     else if (main_args.program_type == ProgramType::BATEXEC)
     {
@@ -914,7 +1286,8 @@ int main(int argc, char * argv[])
     // Let's finalize Batsim's outputs
     finalize_batsim_outputs(&context);
 
-    return 0;
+    // The process that has branched the simulation ends with its branches
+    return wait_for_branches();
 }
 
 void set_configuration(BatsimContext *context,
@@ -932,10 +1305,13 @@ void set_configuration(BatsimContext *context,
     // *************************************
     // Let's update the BatsimContext values
     // *************************************
+    // Sweep workers are configured again, and may not unsubscribe from the same events as the command line
+    context->event_subscription = EventSubscription();
     context->redis_enabled = main_args.redis_enabled;
     context->submission_forward_profiles = main_args.forward_profiles_on_submission;
     context->registration_sched_enabled = main_args.dynamic_registration_enabled;
     context->registration_sched_ack = main_args.ack_dynamic_registration;
+    context->workloads.set_compact_profile_tombstones(main_args.compact_profile_tombstones);
     if (main_args.dynamic_registration_enabled && main_args.profile_reuse_enabled)
     {
         context->garbage_collect_profiles = false; // It is true by default
@@ -943,12 +1319,19 @@ void set_configuration(BatsimContext *context,
 
     context->platform_filename = main_args.platform_filename;
     context->export_prefix = main_args.export_prefix;
+    context->export_buffer_size = main_args.export_buffer_size;
+    context->export_compression = main_args.export_compression;
+    context->machine_properties_format = main_args.machine_properties_format;
+    context->export_jobs_columns = main_args.export_jobs_columns;
+    context->export_columnar = main_args.export_columnar;
     context->workflow_nb_concurrent_jobs_limit = main_args.workflow_nb_concurrent_jobs_limit;
+    context->workflow_task_order = main_args.workflow_task_order;
     context->energy_used = main_args.energy_used;
     context->allow_compute_sharing = main_args.allow_compute_sharing;
     context->allow_storage_sharing = main_args.allow_storage_sharing;
     context->trace_schedule = main_args.enable_schedule_tracing;
     context->trace_machine_states = main_args.enable_machine_state_tracing;
+    context->machine_state_sampling_period = main_args.machine_state_sampling_period;
     context->simulation_start_time = chrono::high_resolution_clock::now();
     context->terminate_with_last_workflow = main_args.terminate_with_last_workflow;
 
@@ -981,5 +1364,16 @@ void set_configuration(BatsimContext *context,
         sched_config = read_whole_file_as_string(main_args.sched_config_file);
     }
     context->config_json.AddMember("sched-config", Value().SetString(sched_config.c_str(), alloc), alloc);
+
+    // The scheduler can unsubscribe from events or event fields it does not use in its configuration
+    Document sched_config_doc;
+    sched_config_doc.Parse(sched_config.c_str());
+    if (!sched_config_doc.HasParseError() && sched_config_doc.IsObject() &&
+        sched_config_doc.HasMember("batsim-subscription"))
+    {
+        context->event_subscription = EventSubscription::from_json(sched_config_doc["batsim-subscription"],
+            "Invalid scheduler configuration: invalid 'batsim-subscription' value");
+    }
     context->config_json.AddMember("forward-unknown-events", Value().SetBool(main_args.forward_unknown_events), alloc);
+    context->config_json.AddMember("machine-properties-format", Value().SetString(machine_properties_format_to_string(main_args.machine_properties_format).c_str(), alloc), alloc);
 }
@@ -7,6 +7,11 @@
 
 #include <rapidjson/document.h>
 
+#include "export.hpp"
+#include "protocol.hpp"
+#include "sweep.hpp"
+#include "workflow.hpp"
+
 struct BatsimContext;
 
 /**
@@ -77,17 +82,24 @@ struct MainArguments
     std::string redis_hostname;                             //!< The Redis (data storage) server host name
     int redis_port = 0;                                     //!< The Redis (data storage) server port
     std::string redis_prefix;                               //!< The Redis (data storage) instance prefix
+    bool redis_verify_writes = false;                       //!< Whether the values written to Redis should be read back to check them
 
     // Job related
     bool forward_profiles_on_submission = false;            //!< Stores whether the profile information of submitted jobs should be sent to the scheduler
     bool dynamic_registration_enabled = false;              //!< Stores whether the scheduler will be able to register jobs and profiles during the simulation
     bool ack_dynamic_registration = false;                  //!< Stores whether Batsim will acknowledge dynamic job registrations (emit JOB_SUBMITTED events)
     bool profile_reuse_enabled = false;                     //!< Stores whether Batsim will garbage collect the Profiles or they can be re-used by dynamic jobs.
+    bool compact_profile_tombstones = false;                //!< Stores whether the entries of garbage collected profiles should be removed (only their names are remembered)
 
     // Output
     std::string export_prefix;                              //!< The filename prefix used to export simulation information
     bool enable_schedule_tracing = false;                   //!< If set to true, the schedule is exported to a Pajé trace file
     bool enable_machine_state_tracing = false;              //!< If set to true, this option enables the tracing of the machine states into a CSV time series.
+    double machine_state_sampling_period = 0;               //!< If strictly positive, at most one machine state row is written per period of this duration
+    size_t export_buffer_size = 64*1024;                    //!< The size (in bytes) of the buffers used to write output files
+    OutputCompression export_compression = OutputCompression::NONE; //!< The compression format of the output files
+    std::vector<JobsColumn> export_jobs_columns;            //!< The columns of the jobs output file. Empty means all columns.
+    bool export_columnar = false;                           //!< If set to true, the jobs, machine states and energy outputs are also written as NumPy columns
 
     // Platform size limit
     int limit_machines_count = 0;                           //!< The number of machines to use to compute jobs. 0 : no limit. > 0 : the number of computation machines
@@ -98,6 +110,8 @@ struct MainArguments
 
     // Workflow
     int workflow_nb_concurrent_jobs_limit = 0;              //!< Limits the number of concurrent jobs for workflows
+    WorkflowTaskOrder workflow_task_order = WorkflowTaskOrder::FIFO; //!< The order in which the ready tasks of workflows are submitted
+    int workflow_parsing_threads = 1;                       //!< The number of threads that read the workflow files concurrently
     bool terminate_with_last_workflow = false;              //!< If true, allows to ignore the jobs submitted after the last workflow termination
 
     // Other
@@ -109,6 +123,10 @@ struct MainArguments
     bool allow_compute_sharing = false;                     //!< Allows/forbids sharing on compute machines. Two jobs can run concurrently on the same machine if and only if sharing is allowed.
     bool allow_storage_sharing = false;                     //!< Allows/forbids sharing on storage machines. Two jobs can run concurrently on the same machine if and only if sharing is allowed.
     bool forward_unknown_events = false;                    //!< Whether the unknown external events should be forwarded to the scheduler.
+    MachinePropertiesFormat machine_properties_format = MachinePropertiesFormat::FULL; //!< How machine properties are sent to the scheduler in SIMULATION_BEGINS
+    std::vector<SweepWorker> sweep_workers;                 //!< The workers of the parameter sweep. Empty if no sweep should be done.
+    int sweep_parallelism = 0;                              //!< The maximum number of sweep workers that run at the same time. 0 means no limit.
+    double branch_at = -1;                                  //!< If non-negative, the simulated time at which the simulation is forked into one branch per sweep worker
     ProgramType program_type = ProgramType::BATSIM;         //!< The program type (Batsim or Batexec at the moment)
     std::string pfs_host_name;                              //!< The name of the SimGrid host which serves as parallel file system (a.k.a. large-capacity storage tier)
     std::string hpst_host_name;                             //!< The name of the SimGrid host which serves as the high-performance storage tier
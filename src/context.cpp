@@ -10,3 +10,29 @@ BatsimContext::~BatsimContext()
         delete it.second;
     }
 }
+
+std::unique_lock<simgrid::s4u::Mutex> lock_shared_state(BatsimContext * context)
+{
+    if (context->shared_state_mutex == nullptr)
+    {
+        return std::unique_lock<simgrid::s4u::Mutex>();
+    }
+
+    return std::unique_lock<simgrid::s4u::Mutex>(*context->shared_state_mutex);
+}
+
+void release_shared_state(std::unique_lock<simgrid::s4u::Mutex> & lock)
+{
+    if (lock.owns_lock())
+    {
+        lock.unlock();
+    }
+}
+
+void reacquire_shared_state(std::unique_lock<simgrid::s4u::Mutex> & lock)
+{
+    if (lock.mutex() != nullptr && !lock.owns_lock())
+    {
+        lock.lock();
+    }
+}
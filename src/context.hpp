@@ -6,12 +6,15 @@
 #pragma once
 
 #include <chrono>
+#include <mutex>
 #include <vector>
 
 #include <zmq.h>
 
 #include <rapidjson/document.h>
 
+#include <simgrid/s4u.hpp>
+
 #include "events.hpp"
 #include "export.hpp"
 #include "jobs.hpp"
@@ -38,6 +41,7 @@ struct BatsimContext
     void * zmq_socket = nullptr;                    //!< The Zero MQ socket (REQ)
     AbstractProtocolReader * proto_reader = nullptr;//!< The protocol reader
     AbstractProtocolWriter * proto_writer = nullptr;//!< The protocol writer
+    simgrid::s4u::MutexPtr shared_state_mutex = nullptr; //!< Serializes the accesses to the context if SimGrid actors run in parallel (contexts/nthreads > 1). nullptr otherwise.
 
     Machines machines;                              //!< The machines
     Workloads workloads;                            //!< The workloads
@@ -53,6 +57,8 @@ struct BatsimContext
     RedisStorage storage;                           //!< The RedisStorage
 
     rapidjson::Document config_json;                //!< The configuration information sent to the scheduler
+    EventSubscription event_subscription;           //!< The events and event fields sent to the scheduler
+    MachinePropertiesFormat machine_properties_format = MachinePropertiesFormat::FULL; //!< How machine properties are sent to the scheduler in SIMULATION_BEGINS
     bool redis_enabled;                             //!< Stores whether Redis should be used
     bool submission_forward_profiles;               //!< Stores whether the profile information of submitted jobs should be sent to the scheduler
     bool registration_sched_enabled;                //!< Stores whether the scheduler will be able to register jobs and profiles during the simulation
@@ -78,11 +84,40 @@ struct BatsimContext
     bool allow_storage_sharing;                     //!< Stores whether sharing (using the same machine to run different jobs concurrently) should be allowed on storage machines
     bool trace_schedule;                            //!< Stores whether the resulting schedule should be outputted
     bool trace_machine_states;                      //!< Stores whether the machines states should be outputted
+    double machine_state_sampling_period = 0;       //!< If strictly positive, at most one machine state row is written per period of this duration
     std::string platform_filename;                  //!< The name of the platform file
     std::string export_prefix;                      //!< The output export prefix
+    size_t export_buffer_size = 64*1024;            //!< The size (in bytes) of the buffers used to write output files
+    OutputCompression export_compression = OutputCompression::NONE; //!< The compression format of the output files
+    std::vector<JobsColumn> export_jobs_columns;    //!< The columns of the jobs output file. Empty means all columns.
+    bool export_columnar = false;                   //!< Stores whether the jobs, machine states and energy outputs are also written as NumPy columns
+    bool outputs_finalized = false;                 //!< Stores whether the outputs have already been finalized (e.g., on abort)
     int workflow_nb_concurrent_jobs_limit;          //!< Limits the number of concurrent jobs for workflows
+    WorkflowTaskOrder workflow_task_order = WorkflowTaskOrder::FIFO; //!< The order in which the ready tasks of workflows are submitted
 
     std::string batsim_version;                     //!< The Batsim version (got from the BATSIM_VERSION variable that is usually set by the build system)
 
     ~BatsimContext();
 };
+
+/**
+ * @brief Locks the shared simulation state (the BatsimContext and the jobs, machines... it stores)
+ * @details The state is only locked if SimGrid actors run in parallel (see BatsimContext::shared_state_mutex),
+ *          otherwise the returned lock owns nothing. The lock must be released before the calling actor waits
+ *          for anything (communication, sleep...), as the actor it waits for may need the lock to progress.
+ * @param[in] context The BatsimContext
+ * @return A lock on the shared simulation state
+ */
+std::unique_lock<simgrid::s4u::Mutex> lock_shared_state(BatsimContext * context);
+
+/**
+ * @brief Temporarily releases a lock got from lock_shared_state, e.g., before waiting for another actor
+ * @param[in,out] lock The lock on the shared simulation state
+ */
+void release_shared_state(std::unique_lock<simgrid::s4u::Mutex> & lock);
+
+/**
+ * @brief Acquires again a lock released by release_shared_state
+ * @param[in,out] lock The lock on the shared simulation state
+ */
+void reacquire_shared_state(std::unique_lock<simgrid::s4u::Mutex> & lock);
@@ -7,10 +7,16 @@
 #include "export.hpp"
 
 #include <algorithm>
+#include <charconv>
 #include <fstream>
+#include <limits>
 #include <random>
+#include <set>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
 
 #include <intervalset.hpp>
 #include <stdlib.h>
@@ -22,6 +28,8 @@
 #include <simgrid/host.h>
 #include <simgrid/plugins/energy.h>
 
+#include <zlib.h>
+
 #include "context.hpp"
 #include "jobs.hpp"
 #include "machines.hpp"
@@ -35,7 +43,7 @@ void prepare_batsim_outputs(BatsimContext * context)
 {
     if (context->trace_schedule)
     {
-        context->paje_tracer.set_filename(context->export_prefix + "_schedule.trace");
+        context->paje_tracer.set_filename(output_filename(context, context->export_prefix + "_schedule.trace"), context->export_buffer_size);
         context->machines.set_tracer(&context->paje_tracer);
         context->paje_tracer.initialize(context, simgrid::s4u::Engine::get_clock());
     }
@@ -43,17 +51,26 @@ void prepare_batsim_outputs(BatsimContext * context)
     if (context->trace_machine_states)
     {
         context->machine_state_tracer.set_context(context);
-        context->machine_state_tracer.set_filename(context->export_prefix + "_machine_states.csv");
+        context->machine_state_tracer.set_filename(output_filename(context, context->export_prefix + "_machine_states.csv"));
+        context->machine_state_tracer.set_sampling_period(context->machine_state_sampling_period);
+        if (context->export_columnar)
+        {
+            context->machine_state_tracer.enable_columnar_export(context->export_prefix + "_machine_states");
+        }
     }
 
     if (context->energy_used)
     {
         // Energy consumption tracing
         context->energy_tracer.set_context(context);
-        context->energy_tracer.set_filename(context->export_prefix + "_consumed_energy.csv");
+        context->energy_tracer.set_filename(output_filename(context, context->export_prefix + "_consumed_energy.csv"));
+        if (context->export_columnar)
+        {
+            context->energy_tracer.enable_columnar_export(context->export_prefix + "_consumed_energy");
+        }
 
         // Power state tracing
-        context->pstate_tracer.setFilename(context->export_prefix + "_pstate_changes.csv");
+        context->pstate_tracer.setFilename(output_filename(context, context->export_prefix + "_pstate_changes.csv"), context->export_buffer_size);
 
         std::map<int, IntervalSet> pstate_to_machine_set;
         for (const Machine * machine : context->machines.machines())
@@ -82,13 +99,24 @@ void prepare_batsim_outputs(BatsimContext * context)
     }
 
     context->jobs_tracer.initialize(context,
-                                    context->export_prefix + "_jobs.csv",
+                                    output_filename(context, context->export_prefix + "_jobs.csv"),
                                     context->export_prefix + "_schedule.csv",
                                     context->export_prefix + "_machines_energy.csv");
+    if (context->export_columnar)
+    {
+        context->jobs_tracer.enable_columnar_export(context->export_prefix + "_jobs");
+    }
 }
 
 void finalize_batsim_outputs(BatsimContext * context)
 {
+    // Outputs may be finalized early if the simulation is aborted
+    if (context->outputs_finalized)
+    {
+        return;
+    }
+    context->outputs_finalized = true;
+
     // Let's say the simulation is ended now
     context->simulation_end_time = chrono::high_resolution_clock::now();
 
@@ -119,36 +147,265 @@ void finalize_batsim_outputs(BatsimContext * context)
 }
 
 
-WriteBuffer::WriteBuffer(const std::string & filename, size_t buffer_size)
-    : buffer_size(buffer_size)
+//! The output files that are currently open, so that they can be suspended and resumed around a fork
+static std::set<WriteBuffer *> open_write_buffers;
+//! The .npy columns that are currently open, so that they can be suspended and resumed around a fork
+static std::set<NpyColumnWriter *> open_npy_columns;
+
+/**
+ * @brief Copies the content of a file into another file (overwritten if it exists)
+ * @param[in] source_filename The name of the copied file
+ * @param[in] destination_filename The name of the copy
+ */
+static void copy_output_file(const std::string & source_filename, const std::string & destination_filename)
+{
+    ifstream source(source_filename, ios_base::binary);
+    xbt_assert(source.is_open(), "Cannot read file '%s'", source_filename.c_str());
+    ofstream destination(destination_filename, ios_base::trunc | ios_base::binary);
+    xbt_assert(destination.is_open(), "Cannot write file '%s'", destination_filename.c_str());
+
+    // Copying an empty file sets the failbit of destination, which is not an error
+    if (source.peek() != ifstream::traits_type::eof())
+    {
+        destination << source.rdbuf();
+        xbt_assert(destination.good(), "Cannot write file '%s'", destination_filename.c_str());
+    }
+}
+
+/**
+ * @brief Returns the name of an output file once the export prefix has changed
+ * @param[in] filename The name of the output file
+ * @param[in] old_prefix The previous export prefix
+ * @param[in] new_prefix The new export prefix
+ * @return The name of the output file with the new prefix (filename is returned as is if it does not start with old_prefix)
+ */
+static std::string rename_output_file(const std::string & filename, const std::string & old_prefix, const std::string & new_prefix)
+{
+    if (filename.compare(0, old_prefix.size(), old_prefix) != 0)
+    {
+        return filename;
+    }
+    return new_prefix + filename.substr(old_prefix.size());
+}
+
+void suspend_batsim_outputs()
+{
+    for (WriteBuffer * write_buffer : open_write_buffers)
+    {
+        write_buffer->suspend();
+    }
+
+    for (NpyColumnWriter * column : open_npy_columns)
+    {
+        column->suspend();
+    }
+}
+
+void copy_batsim_outputs(const BatsimContext * context, const std::string & new_export_prefix)
+{
+    for (const WriteBuffer * write_buffer : open_write_buffers)
+    {
+        const string & filename = write_buffer->get_filename();
+        const string new_filename = rename_output_file(filename, context->export_prefix, new_export_prefix);
+        if (new_filename != filename)
+        {
+            xbt_assert(output_compression_from_filename(filename) == OutputCompression::NONE,
+                       "Compressed file '%s' cannot be copied to '%s'", filename.c_str(), new_filename.c_str());
+            copy_output_file(filename, new_filename);
+        }
+    }
+
+    for (const NpyColumnWriter * column : open_npy_columns)
+    {
+        const string & filename = column->get_filename();
+        const string new_filename = rename_output_file(filename, context->export_prefix, new_export_prefix);
+        if (new_filename != filename)
+        {
+            copy_output_file(filename, new_filename);
+        }
+    }
+}
+
+void resume_batsim_outputs(BatsimContext * context, const std::string & new_export_prefix)
+{
+    const string old_export_prefix = context->export_prefix;
+
+    for (WriteBuffer * write_buffer : open_write_buffers)
+    {
+        write_buffer->resume(rename_output_file(write_buffer->get_filename(), old_export_prefix, new_export_prefix));
+    }
+
+    for (NpyColumnWriter * column : open_npy_columns)
+    {
+        column->resume(rename_output_file(column->get_filename(), old_export_prefix, new_export_prefix));
+    }
+
+    context->export_prefix = new_export_prefix;
+    context->jobs_tracer.set_summary_filenames(new_export_prefix + "_schedule.csv",
+                                               new_export_prefix + "_machines_energy.csv");
+}
+
+OutputCompression output_compression_from_string(const std::string & str)
+{
+    if (str == "none")
+    {
+        return OutputCompression::NONE;
+    }
+    else if (str == "gzip")
+    {
+        return OutputCompression::GZIP;
+    }
+    else
+    {
+        throw std::runtime_error("Invalid output compression string");
+    }
+}
+
+OutputCompression output_compression_from_filename(const std::string & filename)
+{
+    if (boost::algorithm::ends_with(filename, ".gz"))
+    {
+        return OutputCompression::GZIP;
+    }
+    return OutputCompression::NONE;
+}
+
+std::string output_filename(const BatsimContext * context, const std::string & filename)
+{
+    switch (context->export_compression)
+    {
+    case OutputCompression::NONE:
+        return filename;
+    case OutputCompression::GZIP:
+        return filename + ".gz";
+    }
+
+    xbt_die("Unhandled output compression");
+}
+
+WriteBuffer::WriteBuffer(const std::string & filename, size_t buffer_size, bool asynchronous)
+    : buffer_size(buffer_size), asynchronous(asynchronous), filename(filename)
 {
     xbt_assert(buffer_size > 0, "Invalid buffer size (%zu)", buffer_size);
     buffer = new char[buffer_size];
 
-    f.open(filename, ios_base::trunc);
-    xbt_assert(f.is_open(), "Cannot write file '%s'", filename.c_str());
+    if (output_compression_from_filename(filename) == OutputCompression::GZIP)
+    {
+        gz_file = gzopen(filename.c_str(), "wb");
+        xbt_assert(gz_file != nullptr, "Cannot write file '%s'", filename.c_str());
+    }
+    else
+    {
+        f.open(filename, ios_base::trunc);
+        xbt_assert(f.is_open(), "Cannot write file '%s'", filename.c_str());
+    }
+
+    if (asynchronous)
+    {
+        back_buffer = new char[buffer_size];
+        writer = std::thread(&WriteBuffer::writer_loop, this);
+    }
+
+    open_write_buffers.insert(this);
 }
 
 WriteBuffer::~WriteBuffer()
 {
-    if (buffer_pos > 0)
+    close();
+}
+
+void WriteBuffer::close()
+{
+    if (closed)
+    {
+        return;
+    }
+
+    flush_buffer();
+
+    if (asynchronous)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop_writer = true;
+        }
+        cv.notify_all();
+        writer.join();
+
+        delete[] back_buffer;
+        back_buffer = nullptr;
+    }
+
+    delete[] buffer;
+    buffer = nullptr;
+
+    if (gz_file != nullptr)
+    {
+        int ret = gzclose(gz_file);
+        (void) ret; // Avoids a warning if assertions are ignored
+        xbt_assert(ret == Z_OK, "Cannot write file '%s' (gzclose failed: %d)", filename.c_str(), ret);
+        gz_file = nullptr;
+    }
+    else
+    {
+        f.close();
+    }
+    closed = true;
+    open_write_buffers.erase(this);
+}
+
+void WriteBuffer::suspend()
+{
+    flush_buffer();
+
+    if (asynchronous)
     {
-        flush_buffer();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop_writer = true;
+        }
+        cv.notify_all();
+        writer.join();
+        stop_writer = false;
     }
 
-    if (buffer != nullptr)
+    // The file may be copied before being resumed
+    if (gz_file == nullptr)
     {
-        delete[] buffer;
-        buffer = nullptr;
+        f.flush();
+        xbt_assert(f.good(), "Cannot write file '%s'", filename.c_str());
+    }
+}
 
+void WriteBuffer::resume(const std::string & new_filename)
+{
+    if (new_filename != filename)
+    {
+        xbt_assert(gz_file == nullptr, "Compressed file '%s' cannot be moved to '%s'", filename.c_str(), new_filename.c_str());
         f.close();
+        f.open(new_filename, ios_base::app);
+        xbt_assert(f.is_open(), "Cannot write file '%s'", new_filename.c_str());
+        filename = new_filename;
+    }
+
+    if (asynchronous)
+    {
+        writer = std::thread(&WriteBuffer::writer_loop, this);
     }
 }
 
+const std::string & WriteBuffer::get_filename() const
+{
+    return filename;
+}
+
 void WriteBuffer::append_text(const char * text)
 {
-    const size_t text_length = strlen(text);
+    append_text(text, strlen(text));
+}
 
+void WriteBuffer::append_text(const char * text, size_t text_length)
+{
     // Is the buffer big enough?
     if (buffer_pos + text_length < buffer_size)
     {
@@ -159,7 +416,7 @@ void WriteBuffer::append_text(const char * text)
     else
     {
         // Write the current buffer content in the file
-        flush_buffer();
+        submit_buffer();
 
         // Does the text fit in the (now empty) buffer?
         if (text_length < buffer_size)
@@ -170,16 +427,285 @@ void WriteBuffer::append_text(const char * text)
         }
         else
         {
-            // Directly write the text into the file
-            f.write(text, static_cast<std::streamsize>(text_length));
+            // Directly write the text into the file, once previous content has been written
+            wait_for_writer();
+            bool write_ok = write_to_file(text, text_length);
+            (void) write_ok; // Avoids a warning if assertions are ignored
+            xbt_assert(write_ok, "Cannot write file '%s'", filename.c_str());
         }
     }
 }
 
 void WriteBuffer::flush_buffer()
 {
-    f.write(buffer, static_cast<std::streamsize>(buffer_pos));
-    buffer_pos = 0;
+    if (buffer_pos > 0)
+    {
+        submit_buffer();
+    }
+    wait_for_writer();
+
+    // Compressed data is flushed on close, as flushing a gzip stream degrades compression
+    if (gz_file == nullptr)
+    {
+        f.flush();
+        xbt_assert(f.good(), "Cannot write file '%s'", filename.c_str());
+    }
+}
+
+void WriteBuffer::submit_buffer()
+{
+    if (!asynchronous)
+    {
+        bool write_ok = write_to_file(buffer, buffer_pos);
+        (void) write_ok; // Avoids a warning if assertions are ignored
+        xbt_assert(write_ok, "Cannot write file '%s'", filename.c_str());
+        buffer_pos = 0;
+        return;
+    }
+
+    // The back buffer must have been written before it can be reused
+    wait_for_writer();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(buffer, back_buffer);
+        back_buffer_pos = buffer_pos;
+        buffer_pos = 0;
+        write_pending = true;
+    }
+    cv.notify_all();
+}
+
+void WriteBuffer::wait_for_writer()
+{
+    if (!asynchronous)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]{ return !write_pending; });
+    xbt_assert(!write_failed, "Cannot write file '%s'", filename.c_str());
+}
+
+void WriteBuffer::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [this]{ return write_pending || stop_writer; });
+
+        if (write_pending)
+        {
+            // The file is written without holding the lock, so that the simulation can fill the other buffer meanwhile
+            lock.unlock();
+            const bool write_ok = write_to_file(back_buffer, back_buffer_pos);
+            lock.lock();
+
+            write_failed = write_failed || !write_ok;
+            write_pending = false;
+            cv.notify_all();
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+bool WriteBuffer::write_to_file(const char * data, size_t size)
+{
+    if (size == 0)
+    {
+        return true;
+    }
+
+    if (gz_file != nullptr)
+    {
+        return gzwrite(gz_file, data, static_cast<unsigned int>(size)) == static_cast<int>(size);
+    }
+
+    f.write(data, static_cast<std::streamsize>(size));
+    return f.good();
+}
+
+
+
+//! The size (in bytes) of the .npy headers written by NpyColumnWriter. Big enough for any 2D shape.
+static const size_t npy_header_size = 128;
+
+NpyColumnWriter::NpyColumnWriter(const std::string & filename,
+                                 char kind,
+                                 size_t value_size,
+                                 size_t width,
+                                 size_t nb_rows_per_group) :
+    _filename(filename),
+    _value_size(value_size),
+    _width(width)
+{
+    xbt_assert(kind == 'f' || kind == 'i' || kind == 'u' || kind == 'S', "Invalid npy kind '%c'", kind);
+    xbt_assert(value_size > 0 && width > 0 && nb_rows_per_group > 0, "Invalid npy column dimensions");
+
+    const uint16_t endianness_test = 1;
+    const bool little_endian = *reinterpret_cast<const char*>(&endianness_test) == 1;
+    char byte_order = little_endian ? '<' : '>';
+    if (value_size == 1 || kind == 'S')
+    {
+        byte_order = '|';
+    }
+    _descr = string(1, byte_order) + kind + std::to_string(value_size);
+
+    _group_size = value_size * width * nb_rows_per_group;
+    _buffer.reserve(_group_size);
+
+    _f.open(filename, ios_base::trunc | ios_base::binary);
+    xbt_assert(_f.is_open(), "Cannot write file '%s'", filename.c_str());
+    write_header();
+
+    open_npy_columns.insert(this);
+}
+
+NpyColumnWriter::~NpyColumnWriter()
+{
+    close();
+}
+
+void NpyColumnWriter::append_raw(const void * data, size_t size)
+{
+    xbt_assert(!_closed, "Cannot append to closed npy file '%s'", _filename.c_str());
+    xbt_assert(size % _value_size == 0, "Invalid value size appended to npy file '%s'", _filename.c_str());
+
+    const char * bytes = static_cast<const char*>(data);
+    _buffer.insert(_buffer.end(), bytes, bytes + size);
+    _nb_values += size / _value_size;
+
+    if (_buffer.size() >= _group_size)
+    {
+        flush();
+    }
+}
+
+uint64_t NpyColumnWriter::nb_rows() const
+{
+    return (_nb_values + _width - 1) / _width;
+}
+
+void NpyColumnWriter::flush()
+{
+    if (!_buffer.empty())
+    {
+        _f.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        xbt_assert(_f.good(), "Cannot write file '%s'", _filename.c_str());
+        _buffer.clear();
+    }
+}
+
+void NpyColumnWriter::close()
+{
+    if (_closed)
+    {
+        return;
+    }
+
+    xbt_assert(_nb_values % _width == 0, "Incomplete row in npy file '%s'", _filename.c_str());
+    flush();
+
+    // Rewrite the header now that the number of rows is known
+    _f.seekp(0);
+    write_header();
+    _f.close();
+    _closed = true;
+    open_npy_columns.erase(this);
+}
+
+void NpyColumnWriter::suspend()
+{
+    flush();
+    _f.flush();
+    xbt_assert(_f.good(), "Cannot write file '%s'", _filename.c_str());
+}
+
+void NpyColumnWriter::resume(const std::string & new_filename)
+{
+    if (new_filename == _filename)
+    {
+        return;
+    }
+
+    // The header is rewritten on close, the file must thus not be opened in append mode
+    _f.close();
+    _f.open(new_filename, ios_base::in | ios_base::out | ios_base::binary);
+    xbt_assert(_f.is_open(), "Cannot write file '%s'", new_filename.c_str());
+    _f.seekp(0, ios_base::end);
+    _filename = new_filename;
+}
+
+const std::string & NpyColumnWriter::get_filename() const
+{
+    return _filename;
+}
+
+void NpyColumnWriter::write_header()
+{
+    // See https://numpy.org/doc/stable/reference/generated/numpy.lib.format.html
+    string shape = "(" + std::to_string(_nb_values / _width) + ",";
+    if (_width > 1)
+    {
+        shape += " " + std::to_string(_width);
+    }
+    shape += ")";
+
+    string dict = "{'descr': '" + _descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+    const size_t preamble_size = 10; // magic string (6), version (2), header length (2)
+    xbt_assert(preamble_size + dict.size() + 1 <= npy_header_size, "npy header too long");
+    dict.append(npy_header_size - preamble_size - dict.size() - 1, ' ');
+    dict.push_back('\n');
+
+    const uint16_t header_length = static_cast<uint16_t>(dict.size());
+    const char preamble[preamble_size] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                                          static_cast<char>(header_length & 0xff),
+                                          static_cast<char>(header_length >> 8)};
+    _f.write(preamble, preamble_size);
+    _f.write(dict.data(), static_cast<std::streamsize>(dict.size()));
+    xbt_assert(_f.good(), "Cannot write file '%s'", _filename.c_str());
+}
+
+NpyListColumnWriter::NpyListColumnWriter(const std::string & filename_prefix,
+                                         char kind,
+                                         size_t value_size,
+                                         size_t width) :
+    _offsets(filename_prefix + ".offsets.npy", 'i', sizeof(int64_t)),
+    _values(filename_prefix + ".values.npy", kind, value_size, width)
+{
+    _offsets.append(static_cast<int64_t>(0));
+}
+
+NpyColumnWriter & NpyListColumnWriter::values()
+{
+    return _values;
+}
+
+void NpyListColumnWriter::end_row()
+{
+    _offsets.append(static_cast<int64_t>(_values.nb_rows()));
+}
+
+void NpyListColumnWriter::append_string(const std::string & str)
+{
+    _values.append_raw(str.data(), str.size());
+    end_row();
+}
+
+void NpyListColumnWriter::flush()
+{
+    _offsets.flush();
+    _values.flush();
+}
+
+void NpyListColumnWriter::close()
+{
+    _offsets.close();
+    _values.close();
 }
 
 
@@ -193,10 +719,10 @@ PajeTracer::PajeTracer(bool log_launchings) :
     shuffle_colors();
 }
 
-void PajeTracer::set_filename(const string &filename)
+void PajeTracer::set_filename(const string &filename, size_t buffer_size)
 {
     xbt_assert(_wbuf == nullptr, "Double call of PajeTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, buffer_size);
 }
 
 PajeTracer::~PajeTracer()
@@ -531,24 +1057,21 @@ void PajeTracer::register_new_job(const JobIdentifier & job_id)
 
 void PajeTracer::set_machine_idle(int machine_id, double time)
 {
-    const int buf_size = 256;
-    int nb_printed;
-    (void) nb_printed; // Avoids a warning if assertions are ignored
-    char * buf = static_cast<char*>(malloc(sizeof(char) * buf_size));
-    xbt_assert(buf != NULL, "Couldn't allocate memory");
+    set_machines_state(machine_id, machine_id, mstateWaiting, time);
+}
 
-    nb_printed = snprintf(buf, buf_size,
-                          "%d %lf %s %s%d %s\n",
-                          SET_STATE, time, machineState, machinePrefix, machine_id, mstateWaiting);
-    xbt_assert(nb_printed < buf_size - 1,
-               "Writing error: buffer has been completely filled, some information might "
-               "have been lost. Please increase Batsim's output temporary buffers' size");
-    _wbuf->append_text(buf);
+void PajeTracer::set_machine_as_computing_job(int machine_id, const JobIdentifier & job_id, double time)
+{
+    set_machines_as_computing_job(machine_id, machine_id, job_id, time);
+}
 
-    free(buf);
+void PajeTracer::set_machines_idle(int first_machine_id, int last_machine_id, double time)
+{
+    set_machines_state(first_machine_id, last_machine_id, mstateWaiting, time);
 }
 
-void PajeTracer::set_machine_as_computing_job(int machine_id, const JobIdentifier & job_id, double time)
+void PajeTracer::set_machines_as_computing_job(int first_machine_id, int last_machine_id,
+                                               const JobIdentifier & job_id, double time)
 {
     auto mit = _jobs.find(job_id);
     if (mit == _jobs.end())
@@ -557,22 +1080,44 @@ void PajeTracer::set_machine_as_computing_job(int machine_id, const JobIdentifie
         mit = _jobs.find(job_id);
     }
 
-    const int buf_size = 256;
-    int nb_printed;
-    (void) nb_printed; // Avoids a warning if assertions are ignored
-    char * buf = static_cast<char*>(malloc(sizeof(char) * buf_size));
-    xbt_assert(buf != NULL, "Couldn't allocate memory");
+    set_machines_state(first_machine_id, last_machine_id, mit->second.c_str(), time);
+}
 
-    nb_printed = snprintf(buf, buf_size,
-                          "%d %lf %s %s%d %s\n",
-                          SET_STATE, time, machineState, machinePrefix, machine_id,
-                          mit->second.c_str());
-    xbt_assert(nb_printed < buf_size - 1,
+void PajeTracer::set_machines_state(int first_machine_id, int last_machine_id, const char * value, double time)
+{
+    xbt_assert(first_machine_id <= last_machine_id, "Invalid machine range [%d,%d]", first_machine_id, last_machine_id);
+
+    // The line prefix is the same for all the machines of the range
+    const int buf_size = 256;
+    char prefix[buf_size];
+    int prefix_length = snprintf(prefix, buf_size, "%d %lf %s %s", SET_STATE, time, machineState, machinePrefix);
+    xbt_assert(prefix_length < buf_size - 1,
                "Writing error: buffer has been completely filled, some information might "
                "have been lost. Please increase Batsim's output temporary buffers' size");
-    _wbuf->append_text(buf);
+    const size_t value_length = strlen(value);
 
-    free(buf);
+    _lines.clear();
+    for (int machine_id = first_machine_id; machine_id <= last_machine_id; ++machine_id)
+    {
+        _lines.append(prefix, static_cast<size_t>(prefix_length));
+
+        char id_buf[16];
+        auto ret = std::to_chars(id_buf, id_buf + sizeof(id_buf), machine_id);
+        _lines.append(id_buf, static_cast<size_t>(ret.ptr - id_buf));
+
+        _lines.push_back(' ');
+        _lines.append(value, value_length);
+        _lines.push_back('\n');
+
+        // Bounds the memory used for very wide ranges
+        if (_lines.size() >= 64*1024)
+        {
+            _wbuf->append_text(_lines.data(), _lines.size());
+            _lines.clear();
+        }
+    }
+
+    _wbuf->append_text(_lines.data(), _lines.size());
 }
 
 void PajeTracer::add_job_kill(const JobIdentifier & job_id, const IntervalSet & used_machine_ids,
@@ -709,10 +1254,10 @@ PStateChangeTracer::PStateChangeTracer()
     xbt_assert(_temporary_buffer != NULL, "Couldn't allocate memory");
 }
 
-void PStateChangeTracer::setFilename(const string &filename)
+void PStateChangeTracer::setFilename(const string &filename, size_t buffer_size)
 {
     xbt_assert(_wbuf == nullptr, "Double call of PStateChangeTracer::setFilename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, buffer_size);
 
     _wbuf->append_text("time,machine_id,new_pstate\n");
 }
@@ -789,11 +1334,21 @@ void EnergyConsumptionTracer::set_context(BatsimContext *context)
 void EnergyConsumptionTracer::set_filename(const string &filename)
 {
     xbt_assert(_wbuf == nullptr, "Double call of EnergyConsumptionTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, _context->export_buffer_size);
 
     _wbuf->append_text("time,energy,event_type,wattmin,epower\n");
 }
 
+void EnergyConsumptionTracer::enable_columnar_export(const string & filename_prefix)
+{
+    xbt_assert(_npy_columns.empty(), "Double call of EnergyConsumptionTracer::enable_columnar_export");
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".time.npy", 'f', sizeof(double)));
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".energy.npy", 'f', sizeof(double)));
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".event_type.npy", 'S', sizeof(char)));
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".wattmin.npy", 'f', sizeof(double)));
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".epower.npy", 'f', sizeof(double)));
+}
+
 void EnergyConsumptionTracer::add_job_start(double date, JobIdentifier job_id)
 {
     (void) job_id;
@@ -818,6 +1373,10 @@ void EnergyConsumptionTracer::flush()
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
 
     _wbuf->flush_buffer();
+    for (auto & column : _npy_columns)
+    {
+        column->flush();
+    }
 }
 
 void EnergyConsumptionTracer::close_buffer()
@@ -826,6 +1385,7 @@ void EnergyConsumptionTracer::close_buffer()
 
     delete _wbuf;
     _wbuf = nullptr;
+    _npy_columns.clear();
 }
 
 long double EnergyConsumptionTracer::add_entry(double date, char event_type)
@@ -868,6 +1428,15 @@ long double EnergyConsumptionTracer::add_entry(double date, char event_type)
 
     free(buf);
 
+    if (!_npy_columns.empty())
+    {
+        _npy_columns[0]->append(date);
+        _npy_columns[1]->append(static_cast<double>(energy));
+        _npy_columns[2]->append(event_type);
+        _npy_columns[3]->append(static_cast<double>(wattmin));
+        _npy_columns[4]->append(epower != -1 ? static_cast<double>(epower) : std::numeric_limits<double>::quiet_NaN());
+    }
+
     _last_entry_date = static_cast<long double>(date);
     _last_entry_energy = energy;
 
@@ -895,7 +1464,7 @@ void MachineStateTracer::set_context(BatsimContext *context)
 void MachineStateTracer::set_filename(const string &filename)
 {
     xbt_assert(_wbuf == nullptr, "Double call of MachineStateTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, _context->export_buffer_size);
 
     vector<string> header_substrings;
     const vector<MachineState> machine_states = {MachineState::SLEEPING,
@@ -914,40 +1483,102 @@ void MachineStateTracer::set_filename(const string &filename)
     _wbuf->flush_buffer();
 }
 
+void MachineStateTracer::enable_columnar_export(const string & filename_prefix)
+{
+    xbt_assert(_npy_columns.empty(), "Double call of MachineStateTracer::enable_columnar_export");
+    _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".time.npy", 'f', sizeof(double)));
+    for (const MachineState & state : {MachineState::SLEEPING,
+                                       MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING,
+                                       MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING,
+                                       MachineState::IDLE,
+                                       MachineState::COMPUTING})
+    {
+        _npy_columns.emplace_back(new NpyColumnWriter(filename_prefix + ".nb_" + machine_state_to_string(state) + ".npy",
+                                                      'i', sizeof(int32_t)));
+    }
+}
+
+void MachineStateTracer::set_sampling_period(double sampling_period)
+{
+    _sampling_period = sampling_period;
+}
+
 void MachineStateTracer::write_machine_states(double date)
 {
     xbt_assert(_context != nullptr, "wrong call: _context is null");
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
 
-    const std::map<MachineState, int> & numbers = _context->machines.nb_machines_in_each_state();
+    if (_has_pending_row)
+    {
+        const bool same_row = (_sampling_period > 0) ? (date < _pending_period_begin + _sampling_period)
+                                                     : (date == _pending_date);
+        if (!same_row)
+        {
+            write_pending_row();
+        }
+    }
+
+    if (!_has_pending_row)
+    {
+        _pending_period_begin = date;
+        _has_pending_row = true;
+    }
+
+    const MachineStateArray<int> & numbers = _context->machines.nb_machines_in_each_state();
+    _pending_date = date;
+    _pending_numbers = {numbers.at(MachineState::SLEEPING),
+                        numbers.at(MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING),
+                        numbers.at(MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING),
+                        numbers.at(MachineState::IDLE),
+                        numbers.at(MachineState::COMPUTING)};
+}
+
+void MachineStateTracer::write_pending_row()
+{
+    xbt_assert(_has_pending_row, "wrong call: no pending row");
+    xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
 
     const int buf_size = 256;
-    int nb_printed;
+    char buf[buf_size];
+    int nb_printed = snprintf(buf, buf_size, "%g,%d,%d,%d,%d,%d\n",
+                              _pending_date,
+                              _pending_numbers[0],
+                              _pending_numbers[1],
+                              _pending_numbers[2],
+                              _pending_numbers[3],
+                              _pending_numbers[4]);
     (void) nb_printed; // Avoids a warning if assertions are ignored
-    char * buf = static_cast<char*>(malloc(sizeof(char) * buf_size));
-    xbt_assert(buf != NULL, "Couldn't allocate memory");
-
-    nb_printed = snprintf(buf, buf_size, "%g,%d,%d,%d,%d,%d\n",
-                          date,
-                          numbers.at(MachineState::SLEEPING),
-                          numbers.at(MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING),
-                          numbers.at(MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING),
-                          numbers.at(MachineState::IDLE),
-                          numbers.at(MachineState::COMPUTING));
     xbt_assert(nb_printed < buf_size - 1,
                "Writing error: buffer has been completely filled, some information might "
                "have been lost. Please increase Batsim's output temporary buffers' size");
-    xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
-    _wbuf->append_text(buf);
+    _wbuf->append_text(buf, static_cast<size_t>(nb_printed));
 
-    free(buf);
+    if (!_npy_columns.empty())
+    {
+        _npy_columns[0]->append(_pending_date);
+        for (size_t i = 0; i < _pending_numbers.size(); ++i)
+        {
+            _npy_columns[i+1]->append(static_cast<int32_t>(_pending_numbers[i]));
+        }
+    }
+
+    _has_pending_row = false;
 }
 
 void MachineStateTracer::flush()
 {
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
 
+    if (_has_pending_row)
+    {
+        write_pending_row();
+    }
+
     _wbuf->flush_buffer();
+    for (auto & column : _npy_columns)
+    {
+        column->flush();
+    }
 }
 
 void MachineStateTracer::close_buffer()
@@ -956,10 +1587,151 @@ void MachineStateTracer::close_buffer()
 
     delete _wbuf;
     _wbuf = nullptr;
+    _npy_columns.clear();
 }
 
 /* Part related to JobsTracer */
 
+//! The names of the columns of the jobs output file, indexed by JobsColumn
+static constexpr const char * jobs_column_names[] = {
+    "job_id",
+    "workload_name",
+    "profile",
+    "submission_time",
+    "requested_number_of_resources",
+    "requested_time",
+    "success",
+    "final_state",
+    "starting_time",
+    "execution_time",
+    "finish_time",
+    "waiting_time",
+    "turnaround_time",
+    "stretch",
+    "allocated_resources",
+    "consumed_energy",
+    "metadata"
+};
+static_assert(sizeof(jobs_column_names) / sizeof(jobs_column_names[0]) == static_cast<size_t>(JobsColumn::NB_COLUMNS),
+              "jobs_column_names does not match JobsColumn");
+
+const char * jobs_column_to_string(JobsColumn column)
+{
+    xbt_assert(column < JobsColumn::NB_COLUMNS, "Invalid jobs column %d", static_cast<int>(column));
+    return jobs_column_names[static_cast<size_t>(column)];
+}
+
+std::vector<JobsColumn> all_jobs_columns()
+{
+    std::vector<JobsColumn> columns;
+    columns.reserve(static_cast<size_t>(JobsColumn::NB_COLUMNS));
+    for (size_t i = 0; i < static_cast<size_t>(JobsColumn::NB_COLUMNS); ++i)
+    {
+        columns.push_back(static_cast<JobsColumn>(i));
+    }
+    return columns;
+}
+
+std::vector<JobsColumn> jobs_columns_from_string(const std::string & str)
+{
+    if (str == "all")
+    {
+        return all_jobs_columns();
+    }
+
+    vector<string> names;
+    boost::split(names, str, boost::is_any_of(","), boost::token_compress_off);
+
+    std::vector<JobsColumn> columns;
+    std::vector<bool> already_selected(static_cast<size_t>(JobsColumn::NB_COLUMNS), false);
+    for (const string & name : names)
+    {
+        const auto * name_it = std::find_if(std::begin(jobs_column_names), std::end(jobs_column_names),
+                                            [&name](const char * column_name) { return name == column_name; });
+        if (name_it == std::end(jobs_column_names))
+        {
+            throw std::runtime_error("Unknown jobs column '" + name + "'");
+        }
+
+        const size_t column_index = static_cast<size_t>(name_it - std::begin(jobs_column_names));
+        if (already_selected[column_index])
+        {
+            throw std::runtime_error("Duplicated jobs column '" + name + "'");
+        }
+        already_selected[column_index] = true;
+        columns.push_back(static_cast<JobsColumn>(column_index));
+    }
+
+    return columns;
+}
+
+/**
+ * @brief Appends an integer at the end of a string, without intermediate allocation
+ * @param[in,out] row The string to append to
+ * @param[in] value The value to append
+ */
+static void append_integer(string & row, long long value)
+{
+    char buf[32];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), value);
+    xbt_assert(ret.ec == std::errc(), "Cannot format integer %lld", value);
+    row.append(buf, static_cast<size_t>(ret.ptr - buf));
+}
+
+/**
+ * @brief Appends a floating-point number at the end of a string, without intermediate allocation.
+ * @details The format is the same as std::to_string (fixed notation, 6 decimals).
+ * @param[in,out] row The string to append to
+ * @param[in] value The value to append
+ */
+static void append_double(string & row, double value)
+{
+    char buf[DBL_MAX_10_EXP + 32];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 6);
+    xbt_assert(ret.ec == std::errc(), "Cannot format floating-point number %g", value);
+    row.append(buf, static_cast<size_t>(ret.ptr - buf));
+}
+
+/**
+ * @brief Calls a function on each maximal interval [first,last] of an IntervalSet, in increasing order
+ * @param[in] machines The IntervalSet
+ * @param[in] f The function, called as f(first, last)
+ */
+template <typename Function>
+static void for_each_interval(const IntervalSet & machines, Function f)
+{
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        f(it->lower(), it->upper());
+    }
+}
+
+/**
+ * @brief Appends the hyphen representation of an IntervalSet at the end of a string (e.g., "0-3 7 9-10")
+ * @details The result is the same as IntervalSet::to_string_hyphen(" "), without intermediate allocation.
+ * @param[in,out] row The string to append to
+ * @param[in] machines The IntervalSet
+ */
+static void append_intervalset(string & row, const IntervalSet & machines)
+{
+    bool first = true;
+    for_each_interval(machines, [&](int range_begin, int range_end)
+    {
+        if (!first)
+        {
+            row.push_back(' ');
+        }
+        first = false;
+
+        append_integer(row, range_begin);
+        if (range_end != range_begin)
+        {
+            row.push_back('-');
+            append_integer(row, range_end);
+        }
+    });
+}
+
 JobsTracer::~JobsTracer()
 {
     if (_wbuf != nullptr)
@@ -975,34 +1747,29 @@ void JobsTracer::initialize(BatsimContext *context,
                        const string & machines_energy_filename)
 {
     xbt_assert(_wbuf == nullptr, "Double call of JobsTracer::initialize");
-    _wbuf = new WriteBuffer(jobs_filename);
+    _wbuf = new WriteBuffer(jobs_filename, context->export_buffer_size);
     _context = context;
     _schedule_filename = schedule_filename;
     _machines_energy_filename = machines_energy_filename;
 
     // Prepare for jobs output file
-    _job_keys = {
-        "job_id",
-        "workload_name",
-        "profile",
-        "submission_time",
-        "requested_number_of_resources",
-        "requested_time",
-        "success",
-        "final_state",
-        "starting_time",
-        "execution_time",
-        "finish_time",
-        "waiting_time",
-        "turnaround_time",
-        "stretch",
-        "allocated_resources",
-        "consumed_energy",
-        "metadata"
-    };
-    string header = boost::algorithm::join(_job_keys, ",") + "\n";
-    _row_content.reserve(_job_keys.size());
-    _wbuf->append_text(header.c_str());
+    _columns = context->export_jobs_columns;
+    if (_columns.empty())
+    {
+        _columns = all_jobs_columns();
+    }
+
+    string header;
+    for (size_t i = 0; i < _columns.size(); ++i)
+    {
+        if (i > 0)
+        {
+            header.push_back(',');
+        }
+        header += jobs_column_to_string(_columns[i]);
+    }
+    header.push_back('\n');
+    _wbuf->append_text(header.c_str(), header.size());
     _wbuf->flush_buffer();
 
     // Prepare for schedule output file
@@ -1012,6 +1779,13 @@ void JobsTracer::initialize(BatsimContext *context,
     }
 }
 
+void JobsTracer::set_summary_filenames(const std::string & schedule_filename,
+                                       const std::string & machines_energy_filename)
+{
+    _schedule_filename = schedule_filename;
+    _machines_energy_filename = machines_energy_filename;
+}
+
 void JobsTracer::finalize()
 {
     // Finalize jobs output file
@@ -1096,7 +1870,6 @@ void JobsTracer::finalize()
     output_map["nb_grouped_switches"] = to_string(_context->nb_grouped_switches);
 
     // Let's compute machine-related metrics
-    map<MachineState, long double> time_spent_in_each_state;
     const vector<MachineState> machine_states = {MachineState::SLEEPING, MachineState::IDLE,
                                                  MachineState::COMPUTING,
                                                  MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING,
@@ -1104,20 +1877,8 @@ void JobsTracer::finalize()
                                                  MachineState::UNAVAILABLE};
     for (const MachineState & state : machine_states)
     {
-        time_spent_in_each_state[state] = 0;
-    }
-
-    for (const Machine * machine : _context->machines.machines())
-    {
-        for (const MachineState & state : machine_states)
-        {
-            time_spent_in_each_state[state] += machine->time_spent_in_each_state.at(state);
-        }
-    }
-
-    for (const MachineState & state : machine_states)
-    {
-        output_map["time_" + machine_state_to_string(state)] = to_string(static_cast<double>(time_spent_in_each_state[state]));
+        const long double time_spent = _context->machines.total_time_spent_in_state(state);
+        output_map["time_" + machine_state_to_string(state)] = to_string(static_cast<double>(time_spent));
     }
 
     // Let's write the output map into the file
@@ -1202,37 +1963,247 @@ void JobsTracer::write_job(const JobPtr job)
         xbt_die("Job %s did not complete", job->id.job_name().c_str());
     }
 
-    // Set all values to be written
-    _job_map["job_id"] = job->id.job_name();
-    _job_map["workload_name"] = job->workload->name;
-    _job_map["profile"] = (job->profile)->name;
-    _job_map["submission_time"] = to_string(static_cast<double>(job->submission_time));
-    _job_map["requested_number_of_resources"] = to_string(job->requested_nb_res);
-    _job_map["requested_time"] = to_string(static_cast<double>(job->walltime));
-    _job_map["success"] = to_string(success);
-    _job_map["final_state"] = job_state_to_string(job->state);
-    _job_map["starting_time"] = rejected ? "" : to_string(static_cast<double>(job->starting_time));
-    _job_map["execution_time"] = rejected ? "" : to_string(static_cast<double>(job->runtime));
-    _job_map["finish_time"] = rejected ? "" : to_string(static_cast<double>(job->starting_time + job->runtime));
-    _job_map["waiting_time"] = rejected ? "" : to_string(static_cast<double>(job->starting_time - job->submission_time));
-    _job_map["turnaround_time"] = rejected ? "" : to_string(static_cast<double>(job->starting_time + job->runtime - job->submission_time));
-    _job_map["stretch"] = rejected ? "" : to_string(static_cast<double>((job->starting_time + job->runtime - job->submission_time) / job->runtime));
-    _job_map["consumed_energy"] = rejected ? "" : to_string(job->consumed_energy);
-    _job_map["allocated_resources"] = job->allocation.to_string_hyphen(" ");
-    _job_map["metadata"] = '"' + job->metadata + '"';
-    // And then write them
-    for (string & mit : _job_keys)
-    {
-        _row_content.push_back(_job_map[mit]);
-    }
-    _wbuf->append_text((boost::algorithm::join(_row_content, ",") + "\n").c_str());
-    _row_content.clear();
+    // Format the row directly from the job, in the order of the selected columns
+    const long double finish_time = job->starting_time + job->runtime;
+    _row.clear();
+    for (size_t i = 0; i < _columns.size(); ++i)
+    {
+        if (i > 0)
+        {
+            _row.push_back(',');
+        }
+
+        switch (_columns[i])
+        {
+        case JobsColumn::JOB_ID:
+            _row += job->id.job_name();
+            break;
+        case JobsColumn::WORKLOAD_NAME:
+            _row += job->workload->name;
+            break;
+        case JobsColumn::PROFILE:
+            _row += job->profile->name;
+            break;
+        case JobsColumn::SUBMISSION_TIME:
+            append_double(_row, static_cast<double>(job->submission_time));
+            break;
+        case JobsColumn::REQUESTED_NUMBER_OF_RESOURCES:
+            append_integer(_row, job->requested_nb_res);
+            break;
+        case JobsColumn::REQUESTED_TIME:
+            append_double(_row, static_cast<double>(job->walltime));
+            break;
+        case JobsColumn::SUCCESS:
+            append_integer(_row, success);
+            break;
+        case JobsColumn::FINAL_STATE:
+            _row += job_state_to_cstring(job->state);
+            break;
+        case JobsColumn::STARTING_TIME:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(job->starting_time));
+            }
+            break;
+        case JobsColumn::EXECUTION_TIME:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(job->runtime));
+            }
+            break;
+        case JobsColumn::FINISH_TIME:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(finish_time));
+            }
+            break;
+        case JobsColumn::WAITING_TIME:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(job->starting_time - job->submission_time));
+            }
+            break;
+        case JobsColumn::TURNAROUND_TIME:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(finish_time - job->submission_time));
+            }
+            break;
+        case JobsColumn::STRETCH:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>((finish_time - job->submission_time) / job->runtime));
+            }
+            break;
+        case JobsColumn::ALLOCATED_RESOURCES:
+            append_intervalset(_row, job->allocation);
+            break;
+        case JobsColumn::CONSUMED_ENERGY:
+            if (!rejected)
+            {
+                append_double(_row, static_cast<double>(job->consumed_energy));
+            }
+            break;
+        case JobsColumn::METADATA:
+            _row.push_back('"');
+            _row += job->metadata;
+            _row.push_back('"');
+            break;
+        case JobsColumn::NB_COLUMNS:
+            xbt_die("Invalid jobs column");
+        }
+    }
+    _row.push_back('\n');
+    _wbuf->append_text(_row.data(), _row.size());
+
+    if (!_npy_columns.empty())
+    {
+        write_job_columns(job, success, rejected);
+    }
+}
+
+void JobsTracer::enable_columnar_export(const string & filename_prefix)
+{
+    xbt_assert(_wbuf != nullptr, "JobsTracer::enable_columnar_export must be called after JobsTracer::initialize");
+    xbt_assert(_npy_columns.empty(), "Double call of JobsTracer::enable_columnar_export");
+
+    _npy_columns.resize(_columns.size());
+    _npy_list_columns.resize(_columns.size());
+    for (size_t i = 0; i < _columns.size(); ++i)
+    {
+        const string column_prefix = filename_prefix + "." + jobs_column_to_string(_columns[i]);
+        switch (_columns[i])
+        {
+        case JobsColumn::JOB_ID:
+        case JobsColumn::WORKLOAD_NAME:
+        case JobsColumn::PROFILE:
+        case JobsColumn::FINAL_STATE:
+        case JobsColumn::METADATA:
+            _npy_list_columns[i].reset(new NpyListColumnWriter(column_prefix, 'S', sizeof(char)));
+            break;
+        case JobsColumn::ALLOCATED_RESOURCES:
+            _npy_list_columns[i].reset(new NpyListColumnWriter(column_prefix, 'i', sizeof(int32_t), 2));
+            break;
+        case JobsColumn::REQUESTED_NUMBER_OF_RESOURCES:
+            _npy_columns[i].reset(new NpyColumnWriter(column_prefix + ".npy", 'i', sizeof(int32_t)));
+            break;
+        case JobsColumn::SUCCESS:
+            _npy_columns[i].reset(new NpyColumnWriter(column_prefix + ".npy", 'u', sizeof(uint8_t)));
+            break;
+        case JobsColumn::SUBMISSION_TIME:
+        case JobsColumn::REQUESTED_TIME:
+        case JobsColumn::STARTING_TIME:
+        case JobsColumn::EXECUTION_TIME:
+        case JobsColumn::FINISH_TIME:
+        case JobsColumn::WAITING_TIME:
+        case JobsColumn::TURNAROUND_TIME:
+        case JobsColumn::STRETCH:
+        case JobsColumn::CONSUMED_ENERGY:
+            _npy_columns[i].reset(new NpyColumnWriter(column_prefix + ".npy", 'f', sizeof(double)));
+            break;
+        case JobsColumn::NB_COLUMNS:
+            xbt_die("Invalid jobs column");
+        }
+    }
+}
+
+void JobsTracer::write_job_columns(const JobPtr job, bool success, bool rejected)
+{
+    // Values that do not exist for rejected jobs are set to NaN
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const long double finish_time = job->starting_time + job->runtime;
+
+    for (size_t i = 0; i < _columns.size(); ++i)
+    {
+        NpyColumnWriter * column = _npy_columns[i].get();
+        NpyListColumnWriter * list_column = _npy_list_columns[i].get();
+
+        switch (_columns[i])
+        {
+        case JobsColumn::JOB_ID:
+            list_column->append_string(job->id.job_name());
+            break;
+        case JobsColumn::WORKLOAD_NAME:
+            list_column->append_string(job->workload->name);
+            break;
+        case JobsColumn::PROFILE:
+            list_column->append_string(job->profile->name);
+            break;
+        case JobsColumn::SUBMISSION_TIME:
+            column->append(static_cast<double>(job->submission_time));
+            break;
+        case JobsColumn::REQUESTED_NUMBER_OF_RESOURCES:
+            column->append(static_cast<int32_t>(job->requested_nb_res));
+            break;
+        case JobsColumn::REQUESTED_TIME:
+            column->append(static_cast<double>(job->walltime));
+            break;
+        case JobsColumn::SUCCESS:
+            column->append(static_cast<uint8_t>(success));
+            break;
+        case JobsColumn::FINAL_STATE:
+        {
+            const char * state = job_state_to_cstring(job->state);
+            list_column->values().append_raw(state, strlen(state));
+            list_column->end_row();
+        } break;
+        case JobsColumn::STARTING_TIME:
+            column->append(rejected ? nan : static_cast<double>(job->starting_time));
+            break;
+        case JobsColumn::EXECUTION_TIME:
+            column->append(rejected ? nan : static_cast<double>(job->runtime));
+            break;
+        case JobsColumn::FINISH_TIME:
+            column->append(rejected ? nan : static_cast<double>(finish_time));
+            break;
+        case JobsColumn::WAITING_TIME:
+            column->append(rejected ? nan : static_cast<double>(job->starting_time - job->submission_time));
+            break;
+        case JobsColumn::TURNAROUND_TIME:
+            column->append(rejected ? nan : static_cast<double>(finish_time - job->submission_time));
+            break;
+        case JobsColumn::STRETCH:
+            column->append(rejected ? nan : static_cast<double>((finish_time - job->submission_time) / job->runtime));
+            break;
+        case JobsColumn::ALLOCATED_RESOURCES:
+            for_each_interval(job->allocation, [list_column](int first, int last)
+            {
+                list_column->values().append(static_cast<int32_t>(first));
+                list_column->values().append(static_cast<int32_t>(last));
+            });
+            list_column->end_row();
+            break;
+        case JobsColumn::CONSUMED_ENERGY:
+            column->append(rejected ? nan : static_cast<double>(job->consumed_energy));
+            break;
+        case JobsColumn::METADATA:
+            list_column->append_string(job->metadata);
+            break;
+        case JobsColumn::NB_COLUMNS:
+            xbt_die("Invalid jobs column");
+        }
+    }
 }
 
 void JobsTracer::flush()
 {
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
     _wbuf->flush_buffer();
+
+    for (auto & column : _npy_columns)
+    {
+        if (column != nullptr)
+        {
+            column->flush();
+        }
+    }
+    for (auto & list_column : _npy_list_columns)
+    {
+        if (list_column != nullptr)
+        {
+            list_column->flush();
+        }
+    }
 }
 
 void JobsTracer::close_buffer()
@@ -1240,4 +2211,7 @@ void JobsTracer::close_buffer()
     xbt_assert(_wbuf != nullptr, "wrong call: _wbuf is null");
     delete _wbuf;
     _wbuf = nullptr;
+
+    _npy_columns.clear();
+    _npy_list_columns.clear();
 }
@@ -8,11 +8,16 @@
 
 #include <stdio.h>
 #include <sys/types.h> /* ssize_t, needed by xbt/str.h, included by msg/msg.h */
+#include <array>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
 
 #include "pointers.hpp"
 #include "machines.hpp"
@@ -20,6 +25,38 @@
 
 struct BatsimContext;
 struct Job;
+struct gzFile_s;
+
+/**
+ * @brief Enumerates the compression formats of the output files
+ */
+enum class OutputCompression
+{
+    NONE    //!< Output files are not compressed
+    ,GZIP   //!< Output files are compressed with gzip (zlib)
+};
+
+/**
+ * @brief Returns the OutputCompression corresponding to a string
+ * @param[in] str The string ("none" or "gzip")
+ * @return The matching OutputCompression. An exception is thrown if str is invalid.
+ */
+OutputCompression output_compression_from_string(const std::string & str);
+
+/**
+ * @brief Returns the OutputCompression that should be used to write a file, depending on its suffix
+ * @param[in] filename The name of the file
+ * @return OutputCompression::GZIP if filename ends with ".gz", OutputCompression::NONE otherwise
+ */
+OutputCompression output_compression_from_filename(const std::string & filename);
+
+/**
+ * @brief Returns the name of an output file, with the suffix of the output compression of the context
+ * @param[in] context The BatsimContext
+ * @param[in] filename The name of the output file, without compression suffix
+ * @return The name of the output file, with its compression suffix (if any)
+ */
+std::string output_filename(const BatsimContext * context, const std::string & filename);
 
 /**
  * @brief Prepares Batsim's outputting
@@ -33,8 +70,38 @@ void prepare_batsim_outputs(BatsimContext * context);
  */
 void finalize_batsim_outputs(BatsimContext * context);
 
+/**
+ * @brief Prepares the open output files so that the process can be forked
+ * @details Buffered data is written into the files and the I/O threads are stopped, as fork does not duplicate threads.
+ *          resume_batsim_outputs must then be called in both the parent and the child processes.
+ */
+void suspend_batsim_outputs();
+
+/**
+ * @brief Copies the content of the output files suspended by suspend_batsim_outputs into files with another prefix
+ * @details This must be done before forking, as the parent process appends to its files once resumed.
+ *          Compressed output files cannot be copied.
+ * @param[in] context The BatsimContext
+ * @param[in] new_export_prefix The export prefix of the copies
+ */
+void copy_batsim_outputs(const BatsimContext * context, const std::string & new_export_prefix);
+
+/**
+ * @brief Resumes the output files suspended by suspend_batsim_outputs
+ * @details If the export prefix changes, the files with the new prefix (copied by copy_batsim_outputs)
+ *          are written from now on. Compressed output files cannot be moved to another prefix.
+ * @param[in,out] context The BatsimContext
+ * @param[in] new_export_prefix The export prefix of the output files from now on
+ */
+void resume_batsim_outputs(BatsimContext * context, const std::string & new_export_prefix);
+
 /**
  * @brief Buffered-write output file
+ * @details In asynchronous mode (default), the buffer is double: the simulation fills one buffer
+ *          while a background I/O thread writes the other one into the file.
+ *          The I/O thread only writes into the file and never touches the simulation state.
+ *          Files whose name ends with ".gz" are compressed with gzip. The compression is done by the I/O thread
+ *          in asynchronous mode. Compressed files are only guaranteed to be complete once closed.
  */
 class WriteBuffer
 {
@@ -42,10 +109,12 @@ public:
     /**
      * @brief Builds a WriteBuffer
      * @param[in] filename The file that will be written
-     * @param[in] buffer_size The size of the buffer (in bytes).
+     * @param[in] buffer_size The size of each buffer (in bytes).
+     * @param[in] asynchronous Whether the file should be written by a background I/O thread
      */
     explicit WriteBuffer(const std::string & filename,
-                         size_t buffer_size = 64*1024);
+                         size_t buffer_size = 64*1024,
+                         bool asynchronous = true);
 
     /**
      * @brief WriteBuffers cannot be copied.
@@ -65,16 +134,241 @@ public:
      */
     void append_text(const char * text);
 
+    /**
+     * @brief Appends a text of known length at the end of the buffer. If the buffer is full, it is automatically flushed into the disk.
+     * @param[in] text The text to append (does not need to be null-terminated)
+     * @param[in] text_length The number of characters to append
+     */
+    void append_text(const char * text, size_t text_length);
+
     /**
      * @brief Write the current content of the buffer into the file
+     * @details This method blocks until the content has been handed to the operating system.
      */
     void flush_buffer();
 
+    /**
+     * @brief Flushes the buffer, stops the I/O thread and closes the file. Called by the destructor.
+     */
+    void close();
+
+    /**
+     * @brief Flushes the buffer and the file stream, and stops the I/O thread (the file remains open)
+     */
+    void suspend();
+
+    /**
+     * @brief Restarts the I/O thread stopped by suspend
+     * @param[in] new_filename If different from the current file name, this file (a copy of the current one)
+     *                         is appended to from now on
+     */
+    void resume(const std::string & new_filename);
+
+    /**
+     * @brief Returns the name of the written file
+     * @return The name of the written file
+     */
+    const std::string & get_filename() const;
+
 private:
-    std::ofstream f;            //!< The file stream on which the buffer is outputted
+    /**
+     * @brief Hands the current buffer over to the I/O thread (or writes it directly in synchronous mode)
+     */
+    void submit_buffer();
+
+    /**
+     * @brief Waits until the I/O thread has no pending write
+     */
+    void wait_for_writer();
+
+    /**
+     * @brief The function executed by the I/O thread
+     */
+    void writer_loop();
+
+    /**
+     * @brief Writes data into the file, compressing it if needed
+     * @param[in] data The data to write
+     * @param[in] size The number of bytes to write
+     * @return Whether the write succeeded
+     */
+    bool write_to_file(const char * data, size_t size);
+
+private:
+    std::ofstream f;            //!< The file stream on which the buffer is outputted (if not compressed)
+    gzFile_s * gz_file = nullptr;   //!< The gzip file on which the buffer is outputted (if compressed)
     const size_t buffer_size;   //!< The buffer maximum size
     char * buffer = nullptr;    //!< The buffer
     size_t buffer_pos = 0;         //!< The current position of the buffer (previous positions are already written)
+
+    const bool asynchronous;            //!< Whether the file is written by a background I/O thread
+    char * back_buffer = nullptr;       //!< The buffer being written by the I/O thread
+    size_t back_buffer_pos = 0;         //!< The number of bytes to write from back_buffer
+    std::thread writer;                 //!< The I/O thread
+    std::mutex mutex;                   //!< Protects the variables shared with the I/O thread
+    std::condition_variable cv;         //!< Used to synchronize the simulation and the I/O thread
+    bool write_pending = false;         //!< Whether back_buffer must be written by the I/O thread
+    bool write_failed = false;          //!< Whether a write of the I/O thread has failed
+    bool stop_writer = false;           //!< Whether the I/O thread should stop
+    bool closed = false;                //!< Whether close has been called
+    std::string filename;               //!< The name of the written file
+};
+
+/**
+ * @brief Writes a typed column into a NumPy .npy file, so that analysis tools can memory-map it
+ * @details Values are buffered and written by groups of rows. The .npy header, which contains the number of rows,
+ *          is written with a fixed size when the file is opened then rewritten when the file is closed.
+ *          Each row contains width values (the column is one-dimensional if width is 1, two-dimensional otherwise).
+ */
+class NpyColumnWriter
+{
+public:
+    /**
+     * @brief Creates a NpyColumnWriter
+     * @param[in] filename The name of the .npy file
+     * @param[in] kind The NumPy kind of the values ('f' for floats, 'i' for signed integers, 'u' for unsigned integers, 'S' for bytes)
+     * @param[in] value_size The size (in bytes) of each value
+     * @param[in] width The number of values in each row
+     * @param[in] nb_rows_per_group The number of rows buffered before being written into the file
+     */
+    NpyColumnWriter(const std::string & filename,
+                    char kind,
+                    size_t value_size,
+                    size_t width = 1,
+                    size_t nb_rows_per_group = 4096);
+
+    /**
+     * @brief NpyColumnWriter cannot be copied.
+     * @param[in] other Another instance
+     */
+    NpyColumnWriter(const NpyColumnWriter & other) = delete;
+
+    /**
+     * @brief Destroys a NpyColumnWriter. Closes the file if needed.
+     */
+    ~NpyColumnWriter();
+
+    /**
+     * @brief Appends a value at the end of the column
+     * @param[in] value The value. Its size must be the value size of the column.
+     */
+    template <typename T>
+    void append(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Only arithmetic values can be appended");
+        append_raw(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Appends raw values at the end of the column
+     * @param[in] data The values, in the native byte order
+     * @param[in] size The size (in bytes) of the data. Must be a multiple of the value size of the column.
+     */
+    void append_raw(const void * data, size_t size);
+
+    /**
+     * @brief Returns the number of rows of the column (complete or not)
+     * @return The number of rows of the column
+     */
+    uint64_t nb_rows() const;
+
+    /**
+     * @brief Writes the buffered values into the file
+     */
+    void flush();
+
+    /**
+     * @brief Writes the buffered values and the final header, then closes the file
+     */
+    void close();
+
+    /**
+     * @brief Writes the buffered values into the file and flushes the file stream
+     */
+    void suspend();
+
+    /**
+     * @brief Resumes the writing of a column suspended by suspend
+     * @param[in] new_filename If different from the current file name, this file (a copy of the current one)
+     *                         is written from now on
+     */
+    void resume(const std::string & new_filename);
+
+    /**
+     * @brief Returns the name of the written file
+     * @return The name of the written file
+     */
+    const std::string & get_filename() const;
+
+private:
+    /**
+     * @brief Writes the .npy header at the beginning of the file
+     */
+    void write_header();
+
+private:
+    std::ofstream _f;               //!< The file stream
+    std::string _filename;          //!< The name of the file
+    std::string _descr;             //!< The NumPy type descriptor of the values (e.g., '<f8')
+    size_t _value_size;             //!< The size (in bytes) of each value
+    size_t _width;                  //!< The number of values in each row
+    std::vector<char> _buffer;      //!< The buffered values
+    size_t _group_size;             //!< The size (in bytes) of a group of rows
+    uint64_t _nb_values = 0;        //!< The number of values appended so far
+    bool _closed = false;           //!< Whether the file has been closed
+};
+
+/**
+ * @brief Writes a column whose rows are variable-length lists (e.g., strings or interval lists)
+ * @details The column is stored in two .npy files, as in Arrow's list layout:
+ *          prefix + ".values.npy" contains the concatenation of all the lists, and
+ *          prefix + ".offsets.npy" contains nb_rows+1 int64 offsets such that row i is values[offsets[i]:offsets[i+1]].
+ */
+class NpyListColumnWriter
+{
+public:
+    /**
+     * @brief Creates a NpyListColumnWriter
+     * @param[in] filename_prefix The prefix of the two .npy files
+     * @param[in] kind The NumPy kind of the values (see NpyColumnWriter)
+     * @param[in] value_size The size (in bytes) of each value
+     * @param[in] width The number of values in each list element (e.g., 2 for intervals)
+     */
+    NpyListColumnWriter(const std::string & filename_prefix,
+                        char kind,
+                        size_t value_size,
+                        size_t width = 1);
+
+    /**
+     * @brief Returns the column where the elements of the current row should be appended
+     * @return The values column
+     */
+    NpyColumnWriter & values();
+
+    /**
+     * @brief Ends the current row. Must be called once all its elements have been appended to values().
+     */
+    void end_row();
+
+    /**
+     * @brief Appends a string as a row (to use on 'S' columns of value size 1)
+     * @param[in] str The string
+     */
+    void append_string(const std::string & str);
+
+    /**
+     * @brief Writes the buffered values into the files
+     */
+    void flush();
+
+    /**
+     * @brief Closes the files
+     */
+    void close();
+
+private:
+    NpyColumnWriter _offsets;   //!< The offsets column
+    NpyColumnWriter _values;    //!< The values column
 };
 
 
@@ -127,8 +421,9 @@ public:
     /**
      * @brief Sets the filename of a PajeTracer
      * @param[in] filename The name of the output file
+     * @param[in] buffer_size The size of the output buffers (in bytes)
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename, size_t buffer_size = 64*1024);
 
     /**
      * @brief PajeTracer destructor.
@@ -180,6 +475,23 @@ public:
      */
     void set_machine_as_computing_job(int machine_id, const JobIdentifier & job_id, double time);
 
+    /**
+     * @brief Sets a range of contiguous machines in the idle state
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @param[in] time The time at which the machines should be marked as idle
+     */
+    void set_machines_idle(int first_machine_id, int last_machine_id, double time);
+
+    /**
+     * @brief Sets a range of contiguous machines in the computing state
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @param[in] job_id The job identifier
+     * @param[in] time The time at which the machines should be marked as computing the job
+     */
+    void set_machines_as_computing_job(int first_machine_id, int last_machine_id, const JobIdentifier & job_id, double time);
+
     /**
      * @brief Adds a job kill in the file trace.
      * @details Please note that this method can only be called when the PajeTracer object has been initialized and had not been finalized yet.
@@ -217,6 +529,15 @@ private:
      */
     void shuffle_colors();
 
+    /**
+     * @brief Sets the state of a range of contiguous machines
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @param[in] value The Pajé value of the state
+     * @param[in] time The time at which the state is set
+     */
+    void set_machines_state(int first_machine_id, int last_machine_id, const char * value, double time);
+
 private:
     const char * rootType = "root_ct";                  //!< The root type output name
     const char * machineType = "machine_ct";            //!< The machine type output name
@@ -245,6 +566,7 @@ private:
 
     std::map<JobIdentifier, std::string> _jobs; //!< Maps jobs to their Pajé representation
     std::vector<std::string> _colors; //!< Strings associated with colors, used for the jobs
+    std::string _lines; //!< The lines being formatted by range operations. Reused to avoid allocations.
 
     PajeTracerState state = UNINITIALIZED; //!< The state of the PajeTracer
     unsigned int nb_total_jobs = 0; //!< The total number of jobs added to Paje
@@ -277,8 +599,9 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param filename The name of the output file of the tracer
+     * @param buffer_size The size of the output buffers (in bytes)
      */
-    void setFilename(const std::string & filename);
+    void setFilename(const std::string & filename, size_t buffer_size = 64*1024);
 
     /**
      * @brief Adds a power state change in the tracer
@@ -338,6 +661,12 @@ public:
      */
     void set_filename(const std::string & filename);
 
+    /**
+     * @brief Additionally writes the entries as typed columns into filename_prefix + ".<column>.npy" files
+     * @param[in] filename_prefix The prefix of the column files
+     */
+    void enable_columnar_export(const std::string & filename_prefix);
+
     /**
      * @brief Adds a job start in the tracer
      * @param[in] date The date at which the job has been started
@@ -385,6 +714,7 @@ private:
 private:
     BatsimContext * _context = nullptr; //!< The Batsim context
     WriteBuffer * _wbuf = nullptr; //!< The buffer used to handle the output file
+    std::vector<std::unique_ptr<NpyColumnWriter>> _npy_columns; //!< The columnar output (time, energy, event_type, wattmin, epower). Empty if disabled.
 };
 
 /**
@@ -422,13 +752,29 @@ public:
     void set_filename(const std::string & filename);
 
     /**
-     * @brief Writes a line in the output file, corresponding to the current state, at the given date
+     * @brief Additionally writes the machine states as typed columns into filename_prefix + ".<column>.npy" files
+     * @param[in] filename_prefix The prefix of the column files
+     */
+    void enable_columnar_export(const std::string & filename_prefix);
+
+    /**
+     * @brief Sets the sampling period of the tracer
+     * @param[in] sampling_period If strictly positive, at most one row is written per period of this duration
+     *            (the last state of the period, at the date it was reached).
+     *            Otherwise, one row is written per distinct date.
+     */
+    void set_sampling_period(double sampling_period);
+
+    /**
+     * @brief Records the current state at the given date.
+     * @details The corresponding line is written in the output file once the date (or the sampling period) is over,
+     *          so that only the last state of each date (or sampling period) is written.
      * @param[in] date The current date
      */
     void write_machine_states(double date);
 
     /**
-     * @brief Flushes the pending writings to the output file
+     * @brief Writes the pending state then flushes the pending writings to the output file
      */
     void flush();
 
@@ -437,11 +783,70 @@ public:
      */
     void close_buffer();
 
+private:
+    /**
+     * @brief Writes the pending state into the output file(s)
+     */
+    void write_pending_row();
+
 private:
     BatsimContext * _context = nullptr; //!< The Batsim context
     WriteBuffer * _wbuf = nullptr; //!< The buffer used to handle the output file
+    std::vector<std::unique_ptr<NpyColumnWriter>> _npy_columns; //!< The columnar output (time then one column per state). Empty if disabled.
+
+    double _sampling_period = 0; //!< If strictly positive, at most one row is written per sampling period
+    bool _has_pending_row = false; //!< Whether a state has been recorded but not written yet
+    double _pending_date = 0; //!< The date of the pending state
+    double _pending_period_begin = 0; //!< The date at which the sampling period of the pending state began
+    std::array<int, 5> _pending_numbers; //!< The number of machines in each state of the pending state (in the column order)
+};
+
+/**
+ * @brief Enumerates the columns of the jobs output file, in their default order
+ */
+enum class JobsColumn
+{
+    JOB_ID
+    ,WORKLOAD_NAME
+    ,PROFILE
+    ,SUBMISSION_TIME
+    ,REQUESTED_NUMBER_OF_RESOURCES
+    ,REQUESTED_TIME
+    ,SUCCESS
+    ,FINAL_STATE
+    ,STARTING_TIME
+    ,EXECUTION_TIME
+    ,FINISH_TIME
+    ,WAITING_TIME
+    ,TURNAROUND_TIME
+    ,STRETCH
+    ,ALLOCATED_RESOURCES
+    ,CONSUMED_ENERGY
+    ,METADATA
+    ,NB_COLUMNS     //!< Not a column: the number of columns
 };
 
+/**
+ * @brief Returns the name of a column of the jobs output file, as written in its header
+ * @param[in] column The column
+ * @return The name of the column
+ */
+const char * jobs_column_to_string(JobsColumn column);
+
+/**
+ * @brief Parses a list of columns of the jobs output file
+ * @param[in] str A comma-separated list of column names (e.g., "job_id,success,finish_time"), or "all"
+ * @return The columns in the given order. "all" returns all the columns in their default order.
+ *         An exception is thrown if str contains an unknown or duplicated column.
+ */
+std::vector<JobsColumn> jobs_columns_from_string(const std::string & str);
+
+/**
+ * @brief Returns all the columns of the jobs output file, in their default order
+ * @return All the columns of the jobs output file
+ */
+std::vector<JobsColumn> all_jobs_columns();
+
 /**
  * @brief Traces the jobs execution over time to export to a CSV file. Also exports schedule metrics to a second CSV file
  */
@@ -475,11 +880,27 @@ public:
                     const std::string & schedule_filename,
                     const std::string & machines_energy_filename);
 
+    /**
+     * @brief Additionally writes the jobs as typed columns into filename_prefix + ".<column>[.offsets|.values].npy" files
+     * @details Must be called after initialize. Only the selected columns are written.
+     *          Strings, and allocations (as [first,last] interval lists) are written as list columns (see NpyListColumnWriter).
+     * @param[in] filename_prefix The prefix of the column files
+     */
+    void enable_columnar_export(const std::string & filename_prefix);
+
     /**
      * @brief Finalizes the tracer. Writes schedule output file
      */
     void finalize();
 
+    /**
+     * @brief Sets the names of the files written when the tracer is finalized
+     * @param[in] schedule_filename The name of the schedule output file
+     * @param[in] machines_energy_filename The name of the machines energy output file
+     */
+    void set_summary_filenames(const std::string & schedule_filename,
+                               const std::string & machines_energy_filename);
+
     /**
      * @brief Writes a line in the jobs output file and updates schedule metrics.
      * @param[in] job The Job involved
@@ -496,6 +917,14 @@ public:
      */
     void close_buffer();
 
+private:
+    /**
+     * @brief Appends a job to the columnar outputs
+     * @param[in] job The Job involved
+     * @param[in] success Whether the job completed successfully
+     * @param[in] rejected Whether the job has been rejected
+     */
+    void write_job_columns(const JobPtr job, bool success, bool rejected);
 
 private:
     BatsimContext * _context = nullptr; //!< The Batsim context
@@ -504,9 +933,10 @@ private:
     std::string _machines_energy_filename; //!< The filename of the schedule output file
 
     // Jobs-related
-    std::vector<std::string> _job_keys; //!< The list of keys in the map
-    std::map<std::string, std::string> _job_map; //!< The map holding info of the Job to write
-    std::vector<std::string> _row_content; //!< The vector containing string to write
+    std::vector<JobsColumn> _columns; //!< The columns written in the jobs output file
+    std::string _row; //!< The row being formatted. Reused to avoid allocations.
+    std::vector<std::unique_ptr<NpyColumnWriter>> _npy_columns; //!< The fixed-size columnar outputs, indexed like _columns (nullptr for list columns)
+    std::vector<std::unique_ptr<NpyListColumnWriter>> _npy_list_columns; //!< The list columnar outputs, indexed like _columns (nullptr for fixed-size columns)
 
     // Schedule-related
     int _nb_jobs = 0; //!< The number of jobs.
@@ -4,6 +4,7 @@
  */
 
 #include "ipp.hpp"
+#include "protocol.hpp"
 
 using namespace std;
 
@@ -59,6 +60,9 @@ std::string ip_message_type_to_string(IPMessageType type)
         case IPMessageType::PROFILE_REGISTERED_BY_DP:
             s = "PROFILE_REGISTERED_BY_DP";
             break;
+        case IPMessageType::JOBS_REGISTERED_BY_DP:
+            s = "JOBS_REGISTERED_BY_DP";
+            break;
         case IPMessageType::JOB_COMPLETED:
             s = "JOB_COMPLETED";
             break;
@@ -89,6 +93,9 @@ std::string ip_message_type_to_string(IPMessageType type)
         case IPMessageType::SCHED_SET_JOB_METADATA:
             s = "SCHED_SET_JOB_METADATA";
             break;
+        case IPMessageType::SCHED_SET_SUBSCRIPTION:
+            s = "SCHED_SET_SUBSCRIPTION";
+            break;
         case IPMessageType::WAIT_QUERY:
             s = "WAIT_QUERY";
             break;
@@ -131,6 +138,9 @@ std::string ip_message_type_to_string(IPMessageType type)
         case IPMessageType::EVENT_OCCURRED:
             s = "EVENT_OCCURRED";
             break;
+        case IPMessageType::SCHED_DECISIONS:
+            s = "SCHED_DECISIONS";
+            break;
     }
 
     return s;
@@ -163,6 +173,11 @@ IPMessage::~IPMessage()
             auto * msg = static_cast<ProfileRegisteredByDPMessage *>(data);
             delete msg;
         } break;
+        case IPMessageType::JOBS_REGISTERED_BY_DP:
+        {
+            auto * msg = static_cast<JobsRegisteredByDPMessage *>(data);
+            delete msg;
+        } break;
         case IPMessageType::JOB_COMPLETED:
         {
             auto * msg = static_cast<JobCompletedMessage *>(data);
@@ -207,6 +222,12 @@ IPMessage::~IPMessage()
             auto * msg = static_cast<SetJobMetadataMessage *>(data);
             delete msg;
         } break;
+        case IPMessageType::SCHED_SET_SUBSCRIPTION:
+        {
+            auto * msg = static_cast<SetSubscriptionMessage *>(data);
+            delete msg->subscription;
+            delete msg;
+        } break;
         case IPMessageType::WAIT_QUERY:
         {
             auto * msg = static_cast<WaitQueryMessage *>(data);
@@ -274,6 +295,15 @@ IPMessage::~IPMessage()
             auto * msg = static_cast<EventOccurredMessage *>(data);
             delete msg;
         } break;
+        case IPMessageType::SCHED_DECISIONS:
+        {
+            auto * msg = static_cast<SchedulerDecisionsMessage *>(data);
+            for (IPMessage * decision : msg->decisions)
+            {
+                delete decision;
+            }
+            delete msg;
+        } break;
     }
 
     data = nullptr;
@@ -21,6 +21,7 @@
 
 struct BatsimContext;
 struct ServerData;
+struct EventSubscription;
 
 /**
  * @brief Stores the different types of inter-process messages
@@ -30,6 +31,7 @@ enum class IPMessageType
     JOB_SUBMITTED          //!< Submitter -> Server. The submitter tells the server that one or several new jobs have been submitted.
     ,JOB_REGISTERED_BY_DP     //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register a job
     ,PROFILE_REGISTERED_BY_DP //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register a profile
+    ,JOBS_REGISTERED_BY_DP    //!< Scheduler -> Server. The scheduler tells the server that the decision process wants to register several jobs at once
     ,JOB_COMPLETED          //!< Launcher -> Server. The job launcher tells the server a job has been completed.
     ,PSTATE_MODIFICATION    //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (modify the state of some resources).
     ,SCHED_EXECUTE_JOB      //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (execute a job).
@@ -39,6 +41,7 @@ enum class IPMessageType
     ,SCHED_CALL_ME_LATER    //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (the scheduler wants to be called in the future).
     ,SCHED_TELL_ME_ENERGY   //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (the scheduler wants to know the platform consumed energy).
     ,SCHED_SET_JOB_METADATA //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (a SET_JOB_METADATA message).
+    ,SCHED_SET_SUBSCRIPTION //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (a SET_SUBSCRIPTION message).
     ,SCHED_WAIT_ANSWER      //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (a WAIT_ANSWER message).
     ,WAIT_QUERY             //!< Server -> Scheduler. The scheduler tells the server a scheduling event occured (a WAIT_ANSWER message).
     ,SCHED_READY            //!< Scheduler -> Server. The scheduler tells the server that the scheduler is ready (the scheduler is ready, messages can be sent to it).
@@ -54,6 +57,7 @@ enum class IPMessageType
     ,TO_JOB_MSG                //!< Scheduler -> Server. The scheduler sends a message to a job.
     ,FROM_JOB_MSG              //!< Job -> Server. The job wants to send a message to the scheduler via the server.
     ,EVENT_OCCURRED            //!< Sumbitter -> Server. The event submitter tells the server that one or several events have occurred.
+    ,SCHED_DECISIONS           //!< Scheduler -> Server. The scheduler sends several decisions that share the same date at once.
 };
 
 /**
@@ -119,7 +123,14 @@ struct JobSubmittedMessage
 struct JobRegisteredByDPMessage
 {
     JobPtr job; //!< The freshly registered job
-    std::string job_description; //!< The job description string (empty if redis is enabled)
+};
+
+/**
+ * @brief The content of the JobsRegisteredByDP message
+ */
+struct JobsRegisteredByDPMessage
+{
+    std::vector<JobPtr> jobs; //!< The freshly registered jobs, in registration order
 };
 
 /**
@@ -129,7 +140,6 @@ struct ProfileRegisteredByDPMessage
 {
     std::string workload_name; //!< The workload name
     std::string profile_name; //!< The profile name
-    std::string profile; //!< The registered profile data
 };
 
 /**
@@ -141,6 +151,14 @@ struct SetJobMetadataMessage
     std::string metadata; //!< The job metadata string (empty if redis is enabled)
 };
 
+/**
+ * @brief The content of the SetSubscriptionMessage message
+ */
+struct SetSubscriptionMessage
+{
+    EventSubscription * subscription = nullptr; //!< The new subscription, owned by the message
+};
+
 /**
  * @brief The content of the JobCompleted message
  */
@@ -281,6 +299,16 @@ struct EventOccurredMessage
     std::vector<const Event *> occurred_events; //!< The list of Event that occurred
 };
 
+struct IPMessage;
+
+/**
+ * @brief The content of the SchedulerDecisions message
+ */
+struct SchedulerDecisionsMessage
+{
+    std::vector<IPMessage *> decisions; //!< The decisions, in the order they must be applied. They are owned by this message.
+};
+
 /**
  * @brief The base struct sent in inter-process messages
  */
@@ -7,11 +7,13 @@
 
 #include <vector>
 #include <algorithm>
-#include <boost/bind.hpp>
 #include <memory>
 
 #include <simgrid/s4u.hpp>
 
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
 #include "jobs.hpp"
 #include "jobs_execution.hpp"
 #include "ipp.hpp"
@@ -19,24 +21,21 @@
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(job_submitter, "job_submitter"); //!< Logging
 
-Task* inc_child (Task *i)
-{
-  i->nb_parent_completed++;
-
-  return i;
-}
-
-Task* bottom_level_f (Task *child, Task *parent)
-{
-  child->depth = std::max( child->depth, (parent->depth)+1 );
-
-  return child;
-}
-
 using namespace std;
 
-static void submit_jobs_to_server(const vector<JobPtr> & jobs_to_submit, const std::string & submitter_name)
+static void submit_jobs_to_server(BatsimContext * context,
+                                  const vector<JobPtr> & jobs_to_submit,
+                                  vector<pair<string, string>> & storage_key_values,
+                                  const std::string & submitter_name)
 {
+    // The scheduler may read the jobs from the data storage as soon as it is notified of their submission,
+    // so the key-values of the whole submission batch are written (in one pipelined batch) first.
+    if (!storage_key_values.empty())
+    {
+        context->storage.set_many(storage_key_values);
+        storage_key_values.clear();
+    }
+
     if (!jobs_to_submit.empty())
     {
         JobSubmittedMessage * msg = new JobSubmittedMessage;
@@ -104,6 +103,7 @@ void static_job_submitter_process(BatsimContext * context,
     if (jobs_to_submit.size() > 0)
     {
         vector<JobPtr> jobs_to_send;
+        vector<pair<string, string>> storage_key_values;
         bool is_first_job = true;
 
         for ( ; !jobs_to_submit.empty() ; jobs_to_submit.pop_front())
@@ -112,7 +112,7 @@ void static_job_submitter_process(BatsimContext * context,
             if (job->submission_time > current_submission_date)
             {
                 // Next job submission time is after current time, send the message to the server for previous submitted jobs
-                submit_jobs_to_server(jobs_to_send, submitter_name);
+                submit_jobs_to_server(context, jobs_to_send, storage_key_values, submitter_name);
                 jobs_to_send.clear();
 
                 // Now let's sleep until it's time to submit the current job
@@ -128,19 +128,22 @@ void static_job_submitter_process(BatsimContext * context,
             // Let's put the metadata about the job into the data storage
             if (context->redis_enabled)
             {
+                // Template instances are stored under their own name (TEMPLATE@JOB_NAME), as their description
+                // differs from the template one
                 string job_key = RedisStorage::job_key(job->id);
                 string profile_key = RedisStorage::profile_key(workload->name, job->profile->name);
 
-                context->storage.set(job_key, job->json_description);
+                storage_key_values.emplace_back(job_key, job->json_description);
                 if (context->submission_forward_profiles)
                 {
-                    context->storage.set(profile_key, job->profile->json_description);
+                    storage_key_values.emplace_back(profile_key, job->profile->full_json_description());
                 }
             }
 
             if (is_first_job)
             {
                 is_first_job = false;
+                auto shared_state_lock = lock_shared_state(context);
                 if (context->energy_first_job_submission < 0)
                 {
                     context->energy_first_job_submission = context->machines.total_consumed_energy(context);
@@ -149,7 +152,7 @@ void static_job_submitter_process(BatsimContext * context,
         }
 
         // Send last vector of submitted jobs
-        submit_jobs_to_server(jobs_to_send, submitter_name);
+        submit_jobs_to_server(context, jobs_to_send, storage_key_values, submitter_name);
     }
 
     SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
@@ -160,13 +163,11 @@ void static_job_submitter_process(BatsimContext * context,
 }
 
 
-static string submit_workflow_task_as_job(BatsimContext *context, string workflow_name, string submitter_name, Task *task);
-static string wait_for_job_completion(string submitter_name);
+static JobIdentifier submit_workflow_task_as_job(BatsimContext *context, const Workflow * workflow, const string & submitter_name,
+                                                 const Task & task, int job_number);
+static JobIdentifier wait_for_job_completion(const string & submitter_name);
 static std::tuple<int,double,double> wait_for_query_answer(string submitter_name);
 
-/* Ugly Global */
-static std::map<std::string, int> task_id_counters;
-
 void workflow_submitter_process(BatsimContext * context,
                                 std::string workflow_name)
 {
@@ -174,7 +175,7 @@ void workflow_submitter_process(BatsimContext * context,
     xbt_assert(context->workflows.exists(workflow_name),
                "Error: a workflow_job_submitter_process is in charge of workload '%s', "
                "which does not exist", workflow_name.c_str());
-    Workflow * workflow = context->workflows.at(workflow_name);
+    const Workflow * workflow = context->workflows.at(workflow_name);
 
     int limit = context->workflow_nb_concurrent_jobs_limit;
     bool not_limiting = (limit == 0);
@@ -185,9 +186,6 @@ void workflow_submitter_process(BatsimContext * context,
     XBT_INFO("New Workflow submitter for workflow %s (start time = %lf)!",
              workflow_name.c_str(),workflow->start_time);
 
-    /* Initializing my task_id counter */
-    task_id_counters[workflow->name] = 0;
-
     /* Hello */
     SubmitterHelloMessage * hello_msg = new SubmitterHelloMessage;
     hello_msg->submitter_name = submitter_name;
@@ -195,11 +193,19 @@ void workflow_submitter_process(BatsimContext * context,
     hello_msg->submitter_type = SubmitterType::JOB_SUBMITTER;
     send_message("server", IPMessageType::SUBMITTER_HELLO, static_cast<void*>(hello_msg));
 
-    /* Create submitted_tasks map */
-    std::map<std::string, Task *> submitted_tasks;
+    /* The task of each submitted job (job names are the job numbers, in submission order) */
+    std::vector<int> task_of_job;
+    task_of_job.reserve(workflow->tasks.size());
 
-    /* Create ready_tasks vector */
-    std::vector<Task *> ready_tasks = workflow->get_source_tasks();
+    /* The number of parents of each task that have not completed yet */
+    std::vector<int> nb_parents_to_complete = workflow->nb_parents;
+
+    /* Create ready_tasks queue */
+    WorkflowReadyQueue ready_tasks(workflow, context->workflow_task_order);
+    for (int task : workflow->get_source_tasks())
+    {
+        ready_tasks.push(task);
+    }
 
     /* Wait until the workflow start-time */
     if (workflow->start_time > simgrid::s4u::Engine::get_clock())
@@ -211,54 +217,44 @@ void workflow_submitter_process(BatsimContext * context,
 
     /* Submit all the ready tasks */
 
-    while((!ready_tasks.empty())||(!submitted_tasks.empty())) /* Stops when there are no more ready tasks or tasks actually running */
+    while((!ready_tasks.empty())||(current_nb > 0)) /* Stops when there are no more ready tasks or tasks actually running */
     {
         while((!ready_tasks.empty())&&(not_limiting || (limit > current_nb))) /* we have some ready tasks to submit */
         {
-            Task *task = ready_tasks.at(0);
-            ready_tasks.erase(ready_tasks.begin() + 0);
+            int task = ready_tasks.pop();
 
             /* Send a Job corresponding to the Task Job */
-            string job_key = submit_workflow_task_as_job(context, workflow_name, submitter_name, task);
-
-            XBT_INFO("Inserting task %s", job_key.c_str());
+            JobIdentifier job_id = submit_workflow_task_as_job(context, workflow, submitter_name,
+                                                               workflow->tasks[static_cast<size_t>(task)],
+                                                               static_cast<int>(task_of_job.size()));
+            XBT_INFO("Inserting task %s", job_id.to_cstring());
 
-            /* Insert the task into the submitted_tasks map */
-            submitted_tasks[job_key] = task;
+            /* Remember which task the job executes */
+            task_of_job.push_back(task);
             current_nb++;
         }
 
-        if(!submitted_tasks.empty()) /* we are done submitting tasks, wait for one to complete */
+        if(current_nb > 0) /* we are done submitting tasks, wait for one to complete */
         {
             /* Wait for callback */
-            string completed_job_key = wait_for_job_completion(submitter_name);
+            JobIdentifier completed_job_id = wait_for_job_completion(submitter_name);
             current_nb--;
 
-            //XBT_INFO("TASK # %s has completed!!!\n", completed_job_key.c_str());
-
-            /* Look for the task in the map */
-            Task *completed_task = submitted_tasks[completed_job_key];
-
-            XBT_INFO("TASK %s has completed! (depth=%d)\n", completed_task->id.c_str(),completed_task->depth);
+            /* Look for the task of the job */
+            int completed_task = task_of_job.at(static_cast<size_t>(std::stoi(completed_job_id.job_name())));
 
-            /* All those poor hungry kids */
-            std::vector<Task *> my_kids = completed_task->children;
+            XBT_INFO("TASK %s has completed! (depth=%d)\n", workflow->tasks[static_cast<size_t>(completed_task)].id.c_str(),
+                     workflow->tasks[static_cast<size_t>(completed_task)].depth);
 
-            /* tell them they are closer to being elected */
-            std::transform (my_kids.begin(),my_kids.end(),my_kids.begin(),inc_child);
-            std::transform (my_kids.begin(),my_kids.end(),my_kids.begin(), boost::bind(&bottom_level_f, _1, completed_task));
-
-            /* look for ready kids */
-            for (std::vector<Task *>::iterator kiddo=my_kids.begin(); kiddo!=my_kids.end(); ++kiddo)
+            /* tell the children they are closer to being elected, and look for ready ones */
+            const int * children = workflow->children(completed_task);
+            for (int i = 0; i < workflow->nb_children(completed_task); ++i)
             {
-                if((*kiddo)->nb_parent_completed==static_cast<int>((*kiddo)->parents.size()))
+                if (--nb_parents_to_complete[static_cast<size_t>(children[i])] == 0)
                 {
-                    ready_tasks.push_back(*kiddo);
+                    ready_tasks.push(children[i]);
                 }
             }
-
-            /* Nothing left for this task */
-            submitted_tasks.erase(completed_job_key);
         }
     }
 
@@ -274,48 +270,79 @@ void workflow_submitter_process(BatsimContext * context,
 }
 
 /**
- * @brief TODO
- * @param context TODO
- * @param workflow_name TODO
- * @param submitter_name TODO
- * @param task TODO
- * @return TODO
+ * @brief Submits a job that executes a workflow task
+ * @param context The BatsimContext
+ * @param workflow The workflow (whose name is also the name of its workload)
+ * @param submitter_name The name of the workflow submitter
+ * @param task The task to execute
+ * @param job_number_int The number of the job in the workflow, used as job name
+ * @return The identifier of the submitted job
  */
-static string submit_workflow_task_as_job(BatsimContext *context, string workflow_name, string submitter_name, Task *task) {
+static JobIdentifier submit_workflow_task_as_job(BatsimContext *context, const Workflow * workflow, const string & submitter_name,
+                                                 const Task & task, int job_number_int) {
 
+    const string & workflow_name = workflow->name;
     const string workload_name = workflow_name;
 
-    string job_number = to_string(task_id_counters[workflow_name]);
-    task_id_counters[workflow_name]++;
-
+    string job_number = to_string(job_number_int);
 
     // Create a profile
     auto profile = make_shared<Profile>();
     profile->type = ProfileType::DELAY;
     DelayProfileData * data = new DelayProfileData;
-    data->delay = task->execution_time;
+    data->delay = task.execution_time;
     profile->data = data;
     profile->json_description = std::string() + "{" +
             "\"type\": \"delay\", "+
-            "\"delay\": " + std::to_string(task->execution_time) +
+            "\"delay\": " + std::to_string(task.execution_time) +
             "}";
-    string profile_name = workflow_name + "_" + task->id; // Create a profile name
+    string profile_name = workflow_name + "_" + task.id; // Create a profile name
     profile->name = profile_name;
     context->workloads.at(workload_name)->profiles->add_profile(profile_name, profile);
 
-    // Create JSON description of Job corresponding to Task
-    double walltime = task->execution_time + 10.0;
-    string job_json_description = std::string() + "{" +
-            "\"id\": \"" + workload_name + "!" + job_number +  "\", " +
-            "\"subtime\":" + std::to_string(simgrid::s4u::Engine::get_clock()) + ", " +
-            "\"walltime\":" + std::to_string(walltime) + ", " +
-            "\"res\":" + std::to_string(task->num_procs) + ", " +
-            "\"profile\": \"" + profile_name + "\"" +
-            "}";
+    // Create JSON description of Job corresponding to Task.
+    // The description is written by rapidjson, as task and workflow names may contain characters to escape.
+    double walltime = task.execution_time + 10.0;
+    const string job_id_str = workload_name + "!" + job_number;
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("id");
+    writer.String(job_id_str.c_str(), static_cast<rapidjson::SizeType>(job_id_str.size()));
+    writer.Key("subtime");
+    writer.Double(simgrid::s4u::Engine::get_clock());
+    writer.Key("walltime");
+    writer.Double(walltime);
+    writer.Key("res");
+    writer.Int(task.num_procs);
+    writer.Key("profile");
+    writer.String(profile_name.c_str(), static_cast<rapidjson::SizeType>(profile_name.size()));
+    writer.EndObject();
+    const string job_json_description(buffer.GetString(), buffer.GetSize());
+
+    // The position of the task in the DAG is forwarded to the scheduler, so that it can prioritize critical tasks.
+    // It is job metadata rather than part of the job description, so that it is sent even if job descriptions are not.
+    buffer.Clear();
+    writer.Reset(buffer);
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(workflow_name.c_str(), static_cast<rapidjson::SizeType>(workflow_name.size()));
+    writer.Key("task");
+    writer.String(task.id.c_str(), static_cast<rapidjson::SizeType>(task.id.size()));
+    writer.Key("depth");
+    writer.Int(task.depth);
+    writer.Key("top_level");
+    writer.Double(task.top_level);
+    writer.Key("bottom_level");
+    writer.Double(task.bottom_level);
+    writer.Key("critical_path_length");
+    writer.Double(workflow->critical_path_length);
+    writer.EndObject();
 
     // Puts the job into memory
     auto job = Job::from_json(job_json_description, context->workloads.at(workload_name),
                               "Invalid workflow-injected JSON job");
+    job->workflow_json_description = string(buffer.GetString(), buffer.GetSize());
     context->workloads.at(workload_name)->jobs->add_job(job);
 
     // Put the metadata about the job into the data storage
@@ -351,23 +378,23 @@ static string submit_workflow_task_as_job(BatsimContext *context, string workflo
     // XBT_INFO("Got my answer : %f", std::get<2>(answer));
     (void)wait_for_query_answer; // Horrible hack to silence "unused" warning.
 
-    // Return a key
-    return job_id.to_string();
+    return job_id;
 }
 
 /**
- * @brief TODO
- * @param submitter_name TODO
- * @return TODO
+ * @brief Waits for the completion of one of the jobs submitted by a submitter
+ * @param submitter_name The name of the submitter
+ * @return The identifier of the completed job
  */
-static string wait_for_job_completion(string submitter_name)
+static JobIdentifier wait_for_job_completion(const string & submitter_name)
 {
     IPMessage * notification = receive_message(submitter_name);
 
     auto * notification_data = static_cast<SubmitterJobCompletionCallbackMessage *>(notification->data);
+    JobIdentifier job_id = notification_data->job_id;
 
-    // TODO: memory cleanup
-    return notification_data->job_id.to_string();
+    delete notification;
+    return job_id;
 }
 
 /**
@@ -10,7 +10,7 @@
 #include <fstream>
 #include <streambuf>
 #include <algorithm>
-#include <regex>
+#include <cstring>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -21,6 +21,7 @@
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 
+#include "pool.hpp"
 #include "profiles.hpp"
 
 using namespace std;
@@ -92,12 +93,12 @@ void JobIdentifier::check_lexically_valid() const
     xbt_assert(is_lexically_valid(reason), "%s", reason.c_str());
 }
 
-string JobIdentifier::workload_name() const
+const string & JobIdentifier::workload_name() const
 {
     return _workload_name;
 }
 
-string JobIdentifier::job_name() const
+const string & JobIdentifier::job_name() const
 {
     return _job_name;
 }
@@ -138,6 +139,19 @@ BatTask::~BatTask()
     }
 }
 
+void * BatTask::operator new(size_t size)
+{
+    xbt_assert(size == sizeof(BatTask), "Unexpected BatTask allocation size (%zu)", size);
+    return pool_of<BatTask>().allocate();
+}
+
+void BatTask::operator delete(void * ptr, size_t size)
+{
+    (void) size; // Avoids a warning if assertions are ignored
+    xbt_assert(size == sizeof(BatTask), "Unexpected BatTask deallocation size (%zu)", size);
+    pool_of<BatTask>().deallocate(ptr);
+}
+
 void BatTask::compute_leaf_progress()
 {
     xbt_assert(sub_tasks.empty(), "Leaves should not contain sub tasks");
@@ -233,7 +247,7 @@ void Jobs::load_from_json(const rapidjson::Document &doc, const std::string &fil
         xbt_assert(!exists(j->id), "%s: duplication of job id '%s'",
                    error_prefix.c_str(), j->id.to_string().c_str());
         _jobs[j->id] = j;
-        _jobs_met.insert({j->id, true});
+        _jobs_met.insert(j->id.job_name());
     }
 }
 
@@ -270,7 +284,7 @@ void Jobs::add_job(JobPtr job)
                job->id.to_cstring());
 
     _jobs[job->id] = job;
-    _jobs_met.insert({job->id, true});
+    _jobs_met.insert(job->id.job_name());
 }
 
 void Jobs::delete_job(const JobIdentifier & job_id, const bool & garbage_collect_profiles)
@@ -279,9 +293,12 @@ void Jobs::delete_job(const JobIdentifier & job_id, const bool & garbage_collect
                "Bad Jobs::delete_job call: The job with name='%s' does not exist.",
                job_id.to_cstring());
 
-    std::string profile_name = _jobs[job_id]->profile->name;
+    // Template instances are freed with their jobs, but templates are never garbage collected (see remove_profile)
+    const ProfilePtr & profile = _jobs[job_id]->profile;
+    const bool is_template_instance = (profile->template_profile != nullptr);
+    std::string profile_name = profile->name;
     _jobs.erase(job_id);
-    if (garbage_collect_profiles)
+    if (garbage_collect_profiles && !is_template_instance)
     {
         _workload->profiles->remove_profile(profile_name);
     }
@@ -289,8 +306,7 @@ void Jobs::delete_job(const JobIdentifier & job_id, const bool & garbage_collect
 
 bool Jobs::exists(const JobIdentifier & job_id) const
 {
-    auto it = _jobs_met.find(job_id);
-    return it != _jobs_met.end();
+    return _jobs_met.contains(job_id.job_name());
 }
 
 bool Jobs::contains_smpi_job() const
@@ -364,6 +380,21 @@ Job::~Job()
     }
 }
 
+JobMessageChannel & Job::messages()
+{
+    if (incoming_messages == nullptr)
+    {
+        incoming_messages = std::make_unique<JobMessageChannel>();
+    }
+    return *incoming_messages;
+}
+
+void Job::release_submission_data()
+{
+    std::string().swap(json_description);
+    std::string().swap(workflow_json_description);
+}
+
 bool operator<(const Job &j1, const Job &j2)
 {
     return j1.id < j2.id;
@@ -383,8 +414,9 @@ JobPtr Job::from_json(const rapidjson::Value & json_desc,
                      Workload * workload,
                      const std::string & error_prefix)
 {
-    // Create and initialize with default values
-    auto j = std::make_shared<Job>();
+    // Create and initialize with default values.
+    // The job and its control block are allocated together from a slab pool.
+    auto j = std::allocate_shared<Job>(PoolAllocator<Job>());
     j->workload = workload;
     j->starting_time = -1;
     j->runtime = -1;
@@ -451,63 +483,55 @@ JobPtr Job::from_json(const rapidjson::Value & json_desc,
     // Get the job profile
     xbt_assert(json_desc.HasMember("profile"), "%s: job %s has no 'profile' field",
                error_prefix.c_str(), j->id.to_string().c_str());
-    xbt_assert(json_desc["profile"].IsString(), "%s: job %s has a non-string 'profile' field",
+    xbt_assert(json_desc["profile"].IsString() || json_desc["profile"].IsObject(),
+               "%s: job %s has a 'profile' field which is neither a string nor an object",
                error_prefix.c_str(), j->id.to_string().c_str());
 
-    // TODO raise exception when the profile does not exist.
-    std::string profile_name = json_desc["profile"].GetString();
-    xbt_assert(workload->profiles->exists(profile_name), "%s: the profile %s for job %s does not exist",
-               error_prefix.c_str(), profile_name.c_str(), j->id.to_string().c_str());
-    j->profile = workload->profiles->at(profile_name);
+    if (json_desc["profile"].IsString())
+    {
+        // TODO raise exception when the profile does not exist.
+        std::string profile_name = json_desc["profile"].GetString();
+        xbt_assert(workload->profiles->exists(profile_name), "%s: the profile %s for job %s does not exist",
+                   error_prefix.c_str(), profile_name.c_str(), j->id.to_string().c_str());
+        j->profile = workload->profiles->at(profile_name);
+    }
+    else
+    {
+        // The profile is an instance of a template, e.g. {"template": "phg", "cpu": 1e12}
+        const Value & binding = json_desc["profile"];
+        xbt_assert(binding.HasMember("template") && binding["template"].IsString(),
+                   "%s: job %s has an object 'profile' field without a string 'template' field",
+                   error_prefix.c_str(), j->id.to_string().c_str());
+        std::string template_name = binding["template"].GetString();
+        xbt_assert(workload->profiles->exists(template_name), "%s: the profile template %s for job %s does not exist",
+                   error_prefix.c_str(), template_name.c_str(), j->id.to_string().c_str());
+        j->profile = Profile::from_template(workload->profiles->at(template_name),
+                                            template_name + "@" + j->id.job_name(),
+                                            binding, error_prefix);
+    }
 
     // Let's get the JSON string which originally described the job
-    // (to conserve potential fields unused by Batsim)
+    // (to conserve potential fields unused by Batsim).
+    // The job ID is replaced by its WLOAD!NUMBER counterpart while writing the description,
+    // which avoids rewriting and parsing the description again.
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    json_desc.Accept(writer);
-
-    // Let's replace the job ID by its WLOAD!NUMBER counterpart if needed
-    // in the json raw description
-    string json_description_tmp(buffer.GetString(), buffer.GetSize());
-    /// @cond DOXYGEN_FAILS_PARSING_THIS_REGEX
-    std::regex r(R"("id"\s*:\s*(?:"*[^(,|})]*"*)\s*)");
-    /// @endcond
-    string replacement_str = "\"id\":\"" + j->id.to_string() + "\"";
-    // XBT_INFO("Before regexp: %s", json_description_tmp.c_str());
-    j->json_description = std::regex_replace(json_description_tmp, r, replacement_str);
-
-    // Let's check that the new description is a valid JSON string
-    rapidjson::Document check_doc;
-    check_doc.Parse(j->json_description.c_str());
-    xbt_assert(!check_doc.HasParseError(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart:"
-               "The output string '%s' is not valid JSON.", j->json_description.c_str());
-    xbt_assert(check_doc.IsObject(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output string '%s' is not valid JSON.", j->json_description.c_str());
-    xbt_assert(check_doc.HasMember("id"),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has no 'id' field.", j->json_description.c_str());
-    xbt_assert(check_doc["id"].IsString(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has a non-string 'id' field.", j->json_description.c_str());
-    xbt_assert(check_doc.HasMember("subtime") && check_doc["subtime"].IsNumber(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has no 'subtime' field (or it is not a number)",
-               j->json_description.c_str());
-    xbt_assert((check_doc.HasMember("walltime") && check_doc["walltime"].IsNumber())
-               || (!check_doc.HasMember("walltime")),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has no 'walltime' field (or it is not a number)",
-               j->json_description.c_str());
-    xbt_assert(check_doc.HasMember("res") && check_doc["res"].IsInt(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has no 'res' field (or it is not an integer)",
-               j->json_description.c_str());
-    xbt_assert(check_doc.HasMember("profile") && check_doc["profile"].IsString(),
-               "A problem occured when replacing the job_id by its WLOAD!job_name counterpart: "
-               "The output JSON '%s' has no 'profile' field (or it is not a string)",
-               j->json_description.c_str());
+    const string job_id_str_full = j->id.to_string();
+    writer.StartObject();
+    for (auto it = json_desc.MemberBegin(); it != json_desc.MemberEnd(); ++it)
+    {
+        writer.Key(it->name.GetString(), it->name.GetStringLength());
+        if (strcmp(it->name.GetString(), "id") == 0)
+        {
+            writer.String(job_id_str_full.c_str(), static_cast<rapidjson::SizeType>(job_id_str_full.size()));
+        }
+        else
+        {
+            it->value.Accept(writer);
+        }
+    }
+    writer.EndObject(static_cast<rapidjson::SizeType>(json_desc.MemberCount()));
+    j->json_description = string(buffer.GetString(), buffer.GetSize());
 
     if (json_desc.HasMember("smpi_ranks_to_hosts_mapping"))
     {
@@ -555,7 +579,12 @@ JobPtr Job::from_json(const std::string & json_str,
 
 std::string job_state_to_string(const JobState & state)
 {
-    string job_state("UNKNOWN");
+    return string(job_state_to_cstring(state));
+}
+
+const char * job_state_to_cstring(const JobState & state)
+{
+    const char * job_state = "UNKNOWN";
 
     switch (state)
     {
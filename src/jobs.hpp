@@ -16,6 +16,7 @@
 
 #include <intervalset.hpp>
 
+#include "name_set.hpp"
 #include "pointers.hpp"
 
 class Profiles;
@@ -79,13 +80,13 @@ public:
      * @brief Returns the workload name.
      * @return The workload name.
      */
-    std::string workload_name() const;
+    const std::string & workload_name() const;
 
     /**
      * @brief Returns the job name within the workload.
      * @return The job name within the workload.
      */
-    std::string job_name() const;
+    const std::string & job_name() const;
 
 private:
     /**
@@ -168,6 +169,20 @@ struct BatTask
       */
     ~BatTask();
 
+    /**
+     * @brief Allocates a BatTask from the BatTask slab pool
+     * @param[in] size The size of the object to allocate
+     * @return The allocated memory
+     */
+    static void * operator new(size_t size);
+
+    /**
+     * @brief Gives the memory of a BatTask back to the BatTask slab pool
+     * @param[in] ptr The memory to release
+     * @param[in] size The size of the released object
+     */
+    static void operator delete(void * ptr, size_t size);
+
     /**
      * @brief Computes the current progress of a task
      * @details This function does recursive calls if needed (composed tasks).
@@ -200,8 +215,20 @@ public:
 };
 
 
+/**
+ * @brief The messages sent by the scheduler to a job, and the synchronization needed to wait for them
+ * @details Most jobs never receive messages: this is allocated separately from the Job to keep jobs small.
+ */
+struct JobMessageChannel
+{
+    std::deque<std::string> buffer; //!< The buffer for incoming messages from the scheduler.
+    simgrid::s4u::MutexPtr mutex = simgrid::s4u::Mutex::create(); //!< Guards buffer while a SCHEDULER_RECV task waits on it
+    simgrid::s4u::ConditionVariablePtr cv = simgrid::s4u::ConditionVariable::create(); //!< Notified by the server when a message is pushed into buffer
+};
+
 /**
  * @brief Represents a job
+ * @details Jobs are allocated from a slab pool (see Job::from_json).
  */
 struct Job
 {
@@ -214,30 +241,32 @@ struct Job
 
     // Batsim internals
     Workload * workload = nullptr; //!< The workload the job belongs to
-    JobIdentifier id; //!< The job unique identifier
     BatTask * task = nullptr; //!< The root task be executed by this job (profile instantiation).
-    std::string json_description; //!< The JSON description of the job
+    JobIdentifier id; //!< The job unique identifier
+    std::string json_description; //!< The JSON description of the job. Released once the job has been submitted to the scheduler.
+    std::string workflow_json_description; //!< The position of the workflow task executed by the job in its DAG (empty for other jobs). Released once the job has been submitted to the scheduler.
     std::set<simgrid::s4u::ActorPtr> execution_actors; //!< The actors involved in running the job
-    std::deque<std::string> incoming_message_buffer; //!< The buffer for incoming messages from the scheduler.
+    std::unique_ptr<JobMessageChannel> incoming_messages = nullptr; //!< The messages sent to the job by the scheduler. Only created when the job receives its first message.
 
     // Scheduler allocation and metadata
     IntervalSet allocation; //!< The machines on which the job has been executed.
+    IntervalSet io_allocation; //!< The machines targeted by the additional IO job merged into the job, if any.
     std::vector<int> smpi_ranks_to_hosts_mapping; //!< If the job uses a SMPI profile, stores which host number each MPI rank should use. These numbers must be in [0,required_nb_res[.
     std::string metadata; //!< Metadata that the scheduler can set on the job
 
-    // Current state
-    JobState state; //!< The current state of the job
-    long double starting_time; //!< The time at which the job starts to be executed.
-    long double runtime; //!< The amount of time during which the job has been executed.
-    bool kill_requested = false; //!< Whether the job kill has been requested
-    long double consumed_energy; //!< The sum, for all machine on which the job has been allocated, of the consumed energy (in Joules) during the job execution time (consumed_energy_after_job_completion - consumed_energy_before_job_start)
-
     // User inputs
     ProfilePtr profile; //!< A pointer to the job profile. The profile tells how the job should be computed
     long double submission_time; //!< The job submission time: The time at which the becomes available
     long double walltime = -1; //!< The job walltime: if the job is executed for more than this amount of time, it will be killed. Set at -1 to disable this behavior
+
+    // Current state
+    long double starting_time; //!< The time at which the job starts to be executed.
+    long double runtime; //!< The amount of time during which the job has been executed.
+    long double consumed_energy; //!< The sum, for all machine on which the job has been allocated, of the consumed energy (in Joules) during the job execution time (consumed_energy_after_job_completion - consumed_energy_before_job_start)
+    JobState state; //!< The current state of the job
     unsigned int requested_nb_res; //!< The number of resources the job is requested to be executed on
     int return_code = -1; //!< The return code of the job
+    bool kill_requested = false; //!< Whether the job kill has been requested
 
 public:
     /**
@@ -274,6 +303,18 @@ public:
      * @return true if the job is complete (=has started then finished), false otherwise.
      */
     bool is_complete() const;
+
+    /**
+     * @brief Returns the messages sent to the job by the scheduler, creating them if needed
+     * @return The messages sent to the job by the scheduler
+     */
+    JobMessageChannel & messages();
+
+    /**
+     * @brief Releases the data that is only needed until the job has been submitted to the scheduler
+     * @details This is called once JOB_SUBMITTED has been sent, as the JSON descriptions are never read afterwards.
+     */
+    void release_submission_data();
 };
 
 /**
@@ -416,7 +457,7 @@ public:
 
 private:
     std::unordered_map<JobIdentifier, JobPtr, JobIdentifierHasher> _jobs; //!< The map that contains the jobs
-    std::unordered_map<JobIdentifier, bool, JobIdentifierHasher> _jobs_met; //!< Stores the jobs id already met during the simulation
+    NameSet _jobs_met; //!< Stores the names of the jobs already met during the simulation. Bounded memory for contiguous numeric names.
     Profiles * _profiles = nullptr; //!< The profiles associated with the jobs
     Workload * _workload = nullptr; //!< The Workload the jobs belong to
 };
@@ -428,6 +469,13 @@ private:
  */
 std::string job_state_to_string(const JobState & state);
 
+/**
+ * @brief Returns a null-terminated string corresponding to a given JobState, without allocation
+ * @param[in] state The JobState
+ * @return A static null-terminated string corresponding to a given JobState
+ */
+const char * job_state_to_cstring(const JobState & state);
+
 /**
  * @brief Returns a JobState corresponding to a given std::string
  * @param[in] state The std::string
@@ -7,6 +7,7 @@
 #include <regex>
 
 #include "jobs_execution.hpp"
+#include "context.hpp"
 #include "jobs.hpp"
 #include "task_execution.hpp"
 #include "server.hpp"
@@ -135,8 +136,11 @@ int execute_task(BatTask * btask,
                  profile_index_in_sequence++)
             {
                 // Traces how the execution is going so that progress can be retrieved if needed
+                // (the killer process of the job reads it)
+                auto shared_state_lock = lock_shared_state(context);
                 btask->current_task_index = sequence_iteration * static_cast<unsigned int>(data->sequence.size()) + profile_index_in_sequence;
                 BatTask * sub_btask = btask->sub_tasks[btask->current_task_index];
+                release_shared_state(shared_state_lock);
 
                 string task_name = "seq" + job->id.to_string() + "'" + sub_btask->profile->name + "'";
                 XBT_DEBUG("Creating sequential task '%s'", task_name.c_str());
@@ -181,25 +185,24 @@ int execute_task(BatTask * btask,
         bool has_messages = false;
 
         XBT_INFO("Trying to receive message from scheduler");
-        if (job->incoming_message_buffer.empty())
+        // The server creates the message channel of the job and pushes into it while holding the shared state
+        auto shared_state_lock = lock_shared_state(context);
+        JobMessageChannel & messages = job->messages();
+        if (messages.buffer.empty())
         {
             if (data->on_timeout == "")
             {
                 XBT_INFO("Waiting for message from scheduler");
-                while (true)
+                release_shared_state(shared_state_lock);
+                int wait_ret = wait_for_incoming_message(job, remaining_time);
+                reacquire_shared_state(shared_state_lock);
+                if (wait_ret == -1)
                 {
-                    if (do_delay_task(data->polltime, remaining_time) == -1)
-                    {
-                        return -1;
-                    }
-
-                    if (!job->incoming_message_buffer.empty())
-                    {
-                        XBT_INFO("Finally got message from scheduler");
-                        has_messages = true;
-                        break;
-                    }
+                    return -1;
                 }
+
+                XBT_INFO("Finally got message from scheduler");
+                has_messages = true;
             }
             else
             {
@@ -214,11 +217,10 @@ int execute_task(BatTask * btask,
 
         if (has_messages)
         {
-            string first_message = job->incoming_message_buffer.front();
-            job->incoming_message_buffer.pop_front();
+            string first_message = std::move(messages.buffer.front());
+            messages.buffer.pop_front();
 
-            regex msg_regex(data->regex);
-            if (regex_match(first_message, msg_regex))
+            if (regex_match(first_message, data->compiled_regex))
             {
                 XBT_INFO("Message from scheduler matches");
                 profile_to_execute = data->on_success;
@@ -238,6 +240,7 @@ int execute_task(BatTask * btask,
             BatTask * sub_btask = new BatTask(job,
                     job->workload->profiles->at(profile_to_execute));
             btask->sub_tasks.push_back(sub_btask);
+            release_shared_state(shared_state_lock);
 
             string task_name = "recv" + job->id.to_string() + "'" + job->profile->name + "'";
             XBT_INFO("Creating receive task '%s'", task_name.c_str());
@@ -256,8 +259,11 @@ int execute_task(BatTask * btask,
     {
         auto * data = static_cast<DelayProfileData *>(profile->data);
 
+        // The killer process of the job reads the progress of the delay
+        auto shared_state_lock = lock_shared_state(context);
         btask->delay_task_start = simgrid::s4u::Engine::get_clock();
         btask->delay_task_required = data->delay;
+        release_shared_state(shared_state_lock);
 
         if (do_delay_task(data->delay, remaining_time) == -1)
         {
@@ -305,6 +311,8 @@ int execute_task(BatTask * btask,
                    "use %d MPI ranks but the ranking states that there are %zu ranks.",
                    job->id.to_cstring(), nb_ranks, job->smpi_ranks_to_hosts_mapping.size());
 
+        // The killer process of the job reads its execution actors
+        auto shared_state_lock = lock_shared_state(context);
         for (unsigned int rank = 0; rank < nb_ranks; ++rank)
         {
             std::string actor_name = job->id.to_string() + "_" + std::to_string(rank);
@@ -323,6 +331,7 @@ int execute_task(BatTask * btask,
             child_actors[rank] = actor;
             job->execution_actors.insert(actor);
         }
+        release_shared_state(shared_state_lock);
 
         const bool has_walltime = (*remaining_time >= 0);
 
@@ -344,7 +353,9 @@ int execute_task(BatTask * btask,
                 }
 
                 xbt_assert(child_actors.count(*finished_rank) == 1, "Internal error: unexpected rank received (%u)", *finished_rank);
+                reacquire_shared_state(shared_state_lock);
                 job->execution_actors.erase(child_actors[*finished_rank]);
+                release_shared_state(shared_state_lock);
                 child_actors.erase(*finished_rank);
                 delete finished_rank;
 
@@ -358,6 +369,7 @@ int execute_task(BatTask * btask,
                 XBT_DEBUG("Timeout reached while executing SMPI profile '%s' (job's walltime reached).", job->profile->name.c_str());
 
                 // Kill all remaining child actors.
+                reacquire_shared_state(shared_state_lock);
                 for (auto mit : child_actors)
                 {
                     auto child_actor = mit.second;
@@ -365,6 +377,7 @@ int execute_task(BatTask * btask,
                     child_actor->kill();
                 }
                 child_actors.clear();
+                release_shared_state(shared_state_lock);
 
                 return -1;
             }
@@ -374,7 +387,7 @@ int execute_task(BatTask * btask,
     }
     else
         xbt_die("Cannot execute job %s: the profile '%s' is of unknown type: %s",
-                job->id.to_cstring(), job->profile->name.c_str(), profile->json_description.c_str());
+                job->id.to_cstring(), job->profile->name.c_str(), profile->full_json_description().c_str());
 
     return 1;
 }
@@ -403,6 +416,34 @@ int do_delay_task(double sleeptime, double * remaining_time)
     }
 }
 
+int wait_for_incoming_message(JobPtr job, double * remaining_time)
+{
+    JobMessageChannel & messages = job->messages();
+
+    std::unique_lock<simgrid::s4u::Mutex> lock(*messages.mutex);
+    while (messages.buffer.empty())
+    {
+        // if the walltime is not set
+        if (*remaining_time < 0)
+        {
+            messages.cv->wait(lock);
+        }
+        else
+        {
+            const double time_before_wait = simgrid::s4u::Engine::get_clock();
+            if (messages.cv->wait_for(lock, *remaining_time) == std::cv_status::timeout)
+            {
+                XBT_INFO("Job has reached walltime");
+                *remaining_time = 0;
+                return -1;
+            }
+            *remaining_time = std::max(0.0, *remaining_time - (simgrid::s4u::Engine::get_clock() - time_before_wait));
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief Initializes logging structures associated with a task (job execution)
  * @param[in] job The job that is about to be executed
@@ -457,6 +498,7 @@ void execute_job_process(BatsimContext * context,
                          ProfilePtr io_profile)
 {
     auto job = allocation->job;
+    auto shared_state_lock = lock_shared_state(context);
 
     job->starting_time = static_cast<long double>(simgrid::s4u::Engine::get_clock());
     job->allocation = allocation->machine_ids;
@@ -480,14 +522,26 @@ void execute_job_process(BatsimContext * context,
     allocation->hosts.clear();
     allocation->hosts.reserve(nb_allocated_resources);
 
+    // Flatten the allocation interval by interval, as random accesses into an IntervalSet are linear in its number of intervals
+    std::vector<simgrid::s4u::Host*> allocated_hosts;
+    allocated_hosts.reserve(nb_allocated_resources);
+    for (auto it = allocation->machine_ids.intervals_begin(); it != allocation->machine_ids.intervals_end(); ++it)
+    {
+        for (int machine_id = it->lower(); machine_id <= it->upper(); ++machine_id)
+        {
+            allocated_hosts.push_back(context->machines[machine_id]->host);
+        }
+    }
+
     // create hosts list from mapping
     for (unsigned int executor_id = 0; executor_id < allocation->mapping.size(); ++executor_id)
     {
         int machine_id_within_allocated_resources = allocation->mapping[executor_id];
-        int machine_id = allocation->machine_ids[machine_id_within_allocated_resources];
-
-        simgrid::s4u::Host* to_add = context->machines[machine_id]->host;
-        allocation->hosts.push_back(to_add);
+        xbt_assert(machine_id_within_allocated_resources >= 0 &&
+                   machine_id_within_allocated_resources < static_cast<int>(nb_allocated_resources),
+                   "Invalid mapping of job '%s': executor %u is mapped on resource %d, whereas the allocation has %u resources",
+                   job->id.to_cstring(), executor_id, machine_id_within_allocated_resources, nb_allocated_resources);
+        allocation->hosts.push_back(allocated_hosts[static_cast<size_t>(machine_id_within_allocated_resources)]);
     }
 
     // Also generate io hosts list if any
@@ -495,9 +549,19 @@ void execute_job_process(BatsimContext * context,
             allocation->io_allocation.to_string_hyphen().c_str(),
             allocation->io_allocation.size());
     allocation->io_hosts.reserve(allocation->io_allocation.size());
-    for (unsigned int id = 0; id < allocation->io_allocation.size(); ++id)
+    for (auto it = allocation->io_allocation.intervals_begin(); it != allocation->io_allocation.intervals_end(); ++it)
+    {
+        for (int machine_id = it->lower(); machine_id <= it->upper(); ++machine_id)
+        {
+            allocation->io_hosts.push_back(context->machines[machine_id]->host);
+        }
+    }
+
+    // The load of IO machines changes without any MachineState change while the job runs
+    job->io_allocation = allocation->io_allocation;
+    if (context->energy_used)
     {
-        allocation->io_hosts.push_back(context->machines[static_cast<int>(id)]->host);
+        context->machines.disable_energy_integration(job->io_allocation);
     }
 
     // If energy is enabled, let us compute the energy used by the machines before running the job
@@ -512,9 +576,12 @@ void execute_job_process(BatsimContext * context,
     context->machines.update_machines_on_job_run(job, allocation->machine_ids,
                                                  context);
 
-    // Execute the process
-    job->return_code = execute_task(job->task, context, allocation,
-                                    &remaining_time);
+    // Execute the process (the shared state is only locked by the task when needed)
+    release_shared_state(shared_state_lock);
+    int return_code = execute_task(job->task, context, allocation, &remaining_time);
+    reacquire_shared_state(shared_state_lock);
+
+    job->return_code = return_code;
     if (job->return_code == 0)
     {
         XBT_INFO("Job '%s' finished in time (success)", job->id.to_cstring());
@@ -552,6 +619,10 @@ void execute_job_process(BatsimContext * context,
     }
 
     context->machines.update_machines_on_job_end(job, allocation->machine_ids, context);
+    if (context->energy_used)
+    {
+        context->machines.enable_energy_integration(job->io_allocation);
+    }
     job->runtime = static_cast<long double>(simgrid::s4u::Engine::get_clock()) - job->starting_time;
     if (job->runtime == 0)
     {
@@ -578,7 +649,9 @@ void execute_job_process(BatsimContext * context,
         JobCompletedMessage * message = new JobCompletedMessage;
         message->job = allocation->job;
 
+        release_shared_state(shared_state_lock);
         send_message("server", IPMessageType::JOB_COMPLETED, static_cast<void*>(message));
+        reacquire_shared_state(shared_state_lock);
     }
 
     job->execution_actors.erase(simgrid::s4u::Actor::self());
@@ -646,6 +719,7 @@ void killer_process(BatsimContext * context,
     message->jobs_ids = jobs_ids;
     message->acknowledge_kill_on_protocol = acknowledge_kill_on_protocol;
 
+    auto shared_state_lock = lock_shared_state(context);
     for (const JobIdentifier & job_id : jobs_ids)
     {
         auto job = context->workloads.job_at(job_id);
@@ -690,6 +764,10 @@ void killer_process(BatsimContext * context,
                 job->state = killed_job_state;
 
                 context->machines.update_machines_on_job_end(job, job->allocation, context);
+                if (context->energy_used)
+                {
+                    context->machines.enable_energy_integration(job->io_allocation);
+                }
                 job->runtime = static_cast<long double>(simgrid::s4u::Engine::get_clock()) - job->starting_time;
 
                 xbt_assert(job->runtime >= 0, "Negative runtime of killed job '%s' (%Lg)!", job->id.to_cstring(), job->runtime);
@@ -718,5 +796,7 @@ void killer_process(BatsimContext * context,
         }
     }
 
+    release_shared_state(shared_state_lock);
+
     send_message("server", IPMessageType::KILLING_DONE, static_cast<void*>(message));
 }
@@ -45,6 +45,15 @@ void smpi_replay_process(JobPtr job, SmpiProfileData * profile_data, const std::
  */
 int do_delay_task(double sleeptime, double * remaining_time);
 
+/**
+ * @brief Blocks until a message from the scheduler is buffered for a job (or until walltime)
+ * @details The waiting is event-driven: the server notifies the job when a TO_JOB_MSG is received.
+ * @param[in] job The job that waits for a message
+ * @param[in,out] remaining_time The remaining amount of time before walltime
+ * @return 0 if a message is available, -1 in the case of a timeout
+ */
+int wait_for_incoming_message(JobPtr job, double * remaining_time);
+
 /**
  * @brief Execute a BatTask recursively regarding on its profile type
  * @param[in,out] btask the task to execute
@@ -27,15 +27,6 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(machines, "machines"); //!< Logging
 
 Machines::Machines()
 {
-    const vector<MachineState> machine_states = {MachineState::SLEEPING, MachineState::IDLE,
-                                                 MachineState::COMPUTING,
-                                                 MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING,
-                                                 MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING,
-                                                 MachineState::UNAVAILABLE};
-    for (const MachineState & state : machine_states)
-    {
-        _nb_machines_in_each_state[state] = 0;
-    }
 }
 
 Machines::~Machines()
@@ -145,13 +136,13 @@ void Machines::create_machines(const BatsimContext *context,
 
                     if (machine->has_pstate(sleep_ps))
                     {
-                        if (machine->pstates[sleep_ps] == PStateType::SLEEP_PSTATE)
+                        if (machine->pstate_type(sleep_ps) == PStateType::SLEEP_PSTATE)
                         {
                             XBT_ERROR("Invalid platform file '%s': host '%s' has an invalid 'sleep_pstates' property:"
                                       " the pstate %d is defined several times, which is forbidden.",
                                       context->platform_filename.c_str(), machine->name.c_str(), sleep_ps);
                         }
-                        else if (machine->pstates[sleep_ps] == PStateType::TRANSITION_VIRTUAL_PSTATE)
+                        else if (machine->pstate_type(sleep_ps) == PStateType::TRANSITION_VIRTUAL_PSTATE)
                         {
                             XBT_ERROR("Invalid platform file '%s': host '%s' has an invalid 'sleep_pstates' property:"
                                       " the pstate %d is defined as a sleep pstate and as a virtual transition pstate."
@@ -169,7 +160,7 @@ void Machines::create_machines(const BatsimContext *context,
 
                     if (machine->has_pstate(on_ps))
                     {
-                        xbt_assert(machine->pstates[on_ps] == PStateType::TRANSITION_VIRTUAL_PSTATE,
+                        xbt_assert(machine->pstate_type(on_ps) == PStateType::TRANSITION_VIRTUAL_PSTATE,
                                    "Invalid platform file '%s': host '%s' has an invalid 'sleep_pstates' property:"
                                    " a pstate can either be a computation one, a sleeping one or a virtual transition one, but combinations are forbidden."
                                    " Pstate %d is defined as a virtual transition pstate but also as another type of pstate.",
@@ -178,7 +169,7 @@ void Machines::create_machines(const BatsimContext *context,
 
                     if (machine->has_pstate(off_ps))
                     {
-                        xbt_assert(machine->pstates[off_ps] == PStateType::TRANSITION_VIRTUAL_PSTATE,
+                        xbt_assert(machine->pstate_type(off_ps) == PStateType::TRANSITION_VIRTUAL_PSTATE,
                                    "Invalid platform file '%s': host '%s' has an invalid 'sleep_pstates' property:"
                                    " a pstate can either be a computation one, a sleeping one or a virtual transition one, but combinations are forbidden."
                                    " Pstate %d is defined as a virtual transition pstate but also as another type of pstate.",
@@ -191,9 +182,9 @@ void Machines::create_machines(const BatsimContext *context,
                     sleep_pstate->switch_off_virtual_pstate = off_ps;
 
                     machine->sleep_pstates[sleep_ps] = sleep_pstate;
-                    machine->pstates[sleep_ps] = PStateType::SLEEP_PSTATE;
-                    machine->pstates[on_ps] = PStateType::TRANSITION_VIRTUAL_PSTATE;
-                    machine->pstates[off_ps] = PStateType::TRANSITION_VIRTUAL_PSTATE;
+                    machine->set_pstate_type(sleep_ps, PStateType::SLEEP_PSTATE);
+                    machine->set_pstate_type(on_ps, PStateType::TRANSITION_VIRTUAL_PSTATE);
+                    machine->set_pstate_type(off_ps, PStateType::TRANSITION_VIRTUAL_PSTATE);
                 }
             }
 
@@ -203,7 +194,7 @@ void Machines::create_machines(const BatsimContext *context,
                 if (!machine->has_pstate(ps))
                 {
                     // TODO: check that the pstate computational power is not null
-                    machine->pstates[ps] = PStateType::COMPUTATION_PSTATE;
+                    machine->set_pstate_type(ps, PStateType::COMPUTATION_PSTATE);
                 }
             }
         }
@@ -223,11 +214,9 @@ void Machines::create_machines(const BatsimContext *context,
             if (context->energy_used)
             {
                 // Check all computing pstates
-                for (auto mit : machine->pstates)
+                for (int pstate_id = 0; pstate_id < static_cast<int>(machine->pstates.size()); ++pstate_id)
                 {
-                    int pstate_id = mit.first;
-                    PStateType & pstate_type = mit.second;
-                    if (pstate_type == PStateType::COMPUTATION_PSTATE)
+                    if (machine->pstates[static_cast<size_t>(pstate_id)] == PStateType::COMPUTATION_PSTATE)
                     {
                         xbt_assert(machine->host->get_pstate_speed(pstate_id) > 0,
                                    "Invalid platform file '%s': host '%s' has an invalid (non-positive computing speed) computing pstate %d.",
@@ -309,6 +298,33 @@ void Machines::create_machines(const BatsimContext *context,
                "Cannot find the \"master\" role in the platform file");
 
     _nb_machines_in_each_state[MachineState::IDLE] = static_cast<int>(_compute_nodes.size());
+
+    // Prepare the dense per-machine state data
+    const size_t nb_machines = _machines.size();
+    _state_table.states.resize(nb_machines);
+    for (const Machine * machine : _machines)
+    {
+        _state_table.states[static_cast<size_t>(machine->id)] = machine->state;
+    }
+    _state_table.last_state_change_dates.assign(nb_machines, 0);
+    for (std::vector<long double> & time_spent : _state_table.time_spent_in_each_state.values)
+    {
+        time_spent.assign(nb_machines, 0);
+    }
+
+    // Prepare the bitmaps used to validate allocations
+    for (MachineBitmap * bitmap : {&_busy_machines, &_available_machines, &_computation_pstate_machines,
+                                   &_compute_node_machines, &_storage_machines})
+    {
+        bitmap->resize(nb_machines);
+    }
+    for (const Machine * machine : _machines)
+    {
+        _available_machines.set(machine->id, machine->state == MachineState::IDLE || machine->state == MachineState::COMPUTING);
+        _compute_node_machines.set(machine->id, machine->has_role(roles::Permissions::COMPUTE_NODE));
+        _storage_machines.set(machine->id, machine->has_role(roles::Permissions::STORAGE));
+        update_computation_pstate_bit(machine);
+    }
 }
 
 
@@ -412,40 +428,137 @@ const Machine *Machines::master_machine() const
 
 long double Machines::total_consumed_energy(const BatsimContext *context) const
 {
-    long double total_consumed_energy = 0;
-
-    if (context->energy_used)
+    if (!context->energy_used)
     {
-        for (const Machine * m : _machines)
-        {
-            total_consumed_energy += static_cast<long double>(sg_host_get_consumed_energy(m->host));
-        }
+        return -1;
     }
-    else
+
+    if (!_energy_integrator.is_initialized())
     {
-        total_consumed_energy = -1;
+        _energy_integrator.initialize(_machines);
     }
 
-    return total_consumed_energy;
+    return _energy_integrator.total_consumed_energy();
 }
 
 long double Machines::total_wattmin(const BatsimContext *context) const
 {
-    long double total_wattmin = 0;
+    if (!context->energy_used)
+    {
+        return -1;
+    }
+
+    if (!_energy_integrator.is_initialized())
+    {
+        _energy_integrator.initialize(_machines);
+    }
+
+    return _energy_integrator.total_wattmin();
+}
+
+long double Machines::consumed_energy(const BatsimContext *context, const Machine *machine) const
+{
+    xbt_assert(context->energy_used, "wrong call: energy is disabled");
+    (void) context; // Avoids a warning if assertions are ignored
+
+    if (!_energy_integrator.is_initialized())
+    {
+        _energy_integrator.initialize(_machines);
+    }
+
+    return _energy_integrator.consumed_energy(machine);
+}
+
+long double Machines::consumed_energy(const BatsimContext *context, const IntervalSet & machines) const
+{
+    xbt_assert(context->energy_used, "wrong call: energy is disabled");
+    (void) context; // Avoids a warning if assertions are ignored
+
+    if (!_energy_integrator.is_initialized())
+    {
+        _energy_integrator.initialize(_machines);
+    }
+
+    long double consumed_energy = 0;
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        consumed_energy += _energy_integrator.consumed_energy(it->lower(), it->upper());
+    }
+
+    return consumed_energy;
+}
+
+void Machines::notify_machine_power_change(const Machine *machine)
+{
+    _energy_integrator.on_power_change(machine);
+    update_computation_pstate_bit(machine);
+}
 
-    if (context->energy_used)
+void Machines::update_computation_pstate_bit(const Machine * machine)
+{
+    if (machine->id < 0 || static_cast<size_t>(machine->id) >= _computation_pstate_machines.size())
+    {
+        return;
+    }
+
+    const int pstate = static_cast<int>(machine->host->get_pstate());
+    _computation_pstate_machines.set(machine->id, machine->has_pstate(pstate) &&
+                                                  machine->pstate_type(pstate) == PStateType::COMPUTATION_PSTATE);
+}
+
+bool Machines::can_execute_job_on(const IntervalSet & machines,
+                                  bool allow_compute_sharing,
+                                  bool allow_storage_sharing,
+                                  bool check_pstates) const
+{
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
     {
-        for (const Machine * m : _machines)
+        const int first = it->lower();
+        const int last = it->upper();
+
+        if (!_available_machines.all_in_range(first, last))
+        {
+            return false;
+        }
+
+        if (!allow_compute_sharing && !_busy_machines.none_in_range_of_both(_compute_node_machines, first, last))
+        {
+            return false;
+        }
+
+        if (!allow_storage_sharing && !_busy_machines.none_in_range_of_both(_storage_machines, first, last))
+        {
+            return false;
+        }
+
+        if (check_pstates && !_computation_pstate_machines.all_in_range(first, last))
         {
-            total_wattmin += static_cast<long double>(sg_host_get_wattmin_at(m->host, sg_host_get_pstate(m->host)));
+            return false;
         }
     }
-    else
+
+    return true;
+}
+
+void Machines::disable_energy_integration(const IntervalSet & machines)
+{
+    if (!_energy_integrator.is_initialized())
+    {
+        _energy_integrator.initialize(_machines);
+    }
+
+    for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
     {
-        total_wattmin = -1;
+        _energy_integrator.begin_exact_period(_machines[static_cast<size_t>(*it)]);
     }
+}
 
-    return total_wattmin;
+void Machines::enable_energy_integration(const IntervalSet & machines)
+{
+    for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
+    {
+        _energy_integrator.end_exact_period(_machines[static_cast<size_t>(*it)]);
+    }
 }
 
 unsigned int Machines::nb_machines() const
@@ -463,49 +576,139 @@ unsigned int Machines::nb_storage_machines() const
     return static_cast<unsigned int>(_storage_nodes.size());
 }
 
-void Machines::update_nb_machines_in_each_state(MachineState old_state, MachineState new_state)
+void Machines::update_machine_state(Machine * machine, MachineState new_state)
 {
+    const size_t machine_id = static_cast<size_t>(machine->id);
+    xbt_assert(machine->id >= 0 && machine_id < _state_table.states.size(),
+               "Cannot update the state of machine %d: invalid id", machine->id);
+
+    long double current_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+
+    long double delta_time = current_date - _state_table.last_state_change_dates[machine_id];
+    xbt_assert(delta_time >= 0, "time inconsistency: time has decreased since last call");
+
+    const MachineState old_state = machine->state;
+    _state_table.time_spent_in_each_state[old_state][machine_id] += delta_time;
+    _state_table.last_state_change_dates[machine_id] = current_date;
+
     _nb_machines_in_each_state[old_state]--;
     _nb_machines_in_each_state[new_state]++;
+
+    machine->state = new_state;
+    _state_table.states[machine_id] = new_state;
+    _available_machines.set(machine->id, new_state == MachineState::IDLE || new_state == MachineState::COMPUTING);
+
+    notify_machine_power_change(machine);
+}
+
+void Machines::update_machines_state(int first_machine_id, int last_machine_id, MachineState new_state)
+{
+    xbt_assert(first_machine_id >= 0 && first_machine_id <= last_machine_id &&
+               static_cast<size_t>(last_machine_id) < _state_table.states.size(),
+               "Cannot update the state of machines [%d,%d]: invalid range", first_machine_id, last_machine_id);
+
+    long double current_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+
+    for (size_t machine_id = static_cast<size_t>(first_machine_id); machine_id <= static_cast<size_t>(last_machine_id); ++machine_id)
+    {
+        long double delta_time = current_date - _state_table.last_state_change_dates[machine_id];
+        xbt_assert(delta_time >= 0, "time inconsistency: time has decreased since last call");
+
+        const MachineState old_state = _state_table.states[machine_id];
+        _state_table.time_spent_in_each_state[old_state][machine_id] += delta_time;
+        _state_table.last_state_change_dates[machine_id] = current_date;
+        _state_table.states[machine_id] = new_state;
+        _nb_machines_in_each_state[old_state]--;
+    }
+    _nb_machines_in_each_state[new_state] += last_machine_id - first_machine_id + 1;
+
+    const bool available = (new_state == MachineState::IDLE || new_state == MachineState::COMPUTING);
+    for (int machine_id = first_machine_id; machine_id <= last_machine_id; ++machine_id)
+    {
+        Machine * machine = _machines[static_cast<size_t>(machine_id)];
+        machine->state = new_state;
+        _available_machines.set(machine_id, available);
+        notify_machine_power_change(machine);
+    }
 }
 
-const std::map<MachineState, int> &Machines::nb_machines_in_each_state() const
+void Machines::update_machines_state(const IntervalSet & machines, MachineState new_state)
+{
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        update_machines_state(it->lower(), it->upper(), new_state);
+    }
+}
+
+const MachineStateArray<int> &Machines::nb_machines_in_each_state() const
 {
     return _nb_machines_in_each_state;
 }
 
+const MachineStateTable & Machines::state_table() const
+{
+    return _state_table;
+}
+
+long double Machines::total_time_spent_in_state(MachineState state) const
+{
+    long double total = 0;
+    for (long double time_spent : _state_table.time_spent_in_each_state[state])
+    {
+        total += time_spent;
+    }
+    return total;
+}
+
 void Machines::update_machines_on_job_run(const JobPtr job,
                                           const IntervalSet & used_machines,
                                           BatsimContext * context)
 {
-    for (auto it = used_machines.elements_begin(); it != used_machines.elements_end(); ++it)
-    {
-        int machine_id = *it;
-        Machine * machine = _machines[static_cast<size_t>(machine_id)];
-        machine->update_machine_state(MachineState::COMPUTING);
+    const double now = simgrid::s4u::Engine::get_clock();
+    update_machines_state(used_machines, MachineState::COMPUTING);
 
-        JobPtr previous_top_job = nullptr;
-        if (!machine->jobs_being_computed.empty())
+    for (auto interval_it = used_machines.intervals_begin(); interval_it != used_machines.intervals_end(); ++interval_it)
+    {
+        // The top job of a machine can only change to the new job.
+        // Contiguous machines whose top job changed are traced as a whole.
+        int changed_range_begin = -1;
+        for (int machine_id = interval_it->lower(); machine_id <= interval_it->upper(); ++machine_id)
         {
-            previous_top_job = *machine->jobs_being_computed.begin();
-        }
+            Machine * machine = _machines[static_cast<size_t>(machine_id)];
+
+            JobPtr previous_top_job = nullptr;
+            if (!machine->jobs_being_computed.empty())
+            {
+                previous_top_job = *machine->jobs_being_computed.begin();
+            }
 
-        machine->jobs_being_computed.insert(job);
+            machine->jobs_being_computed.insert(job);
+            _busy_machines.set(machine_id, true);
 
-        if (previous_top_job == nullptr || previous_top_job != *machine->jobs_being_computed.begin())
-        {
-            if (_tracer != nullptr)
+            const bool top_job_changed = (previous_top_job == nullptr || previous_top_job != *machine->jobs_being_computed.begin());
+            if (top_job_changed && changed_range_begin == -1)
             {
-                _tracer->set_machine_as_computing_job(machine->id,
-                                                      (*machine->jobs_being_computed.begin())->id,
-                                                      simgrid::s4u::Engine::get_clock());
+                changed_range_begin = machine_id;
+            }
+            else if (!top_job_changed && changed_range_begin != -1)
+            {
+                if (_tracer != nullptr)
+                {
+                    _tracer->set_machines_as_computing_job(changed_range_begin, machine_id - 1, job->id, now);
+                }
+                changed_range_begin = -1;
             }
         }
+
+        if (changed_range_begin != -1 && _tracer != nullptr)
+        {
+            _tracer->set_machines_as_computing_job(changed_range_begin, interval_it->upper(), job->id, now);
+        }
     }
 
     if (context->trace_machine_states)
     {
-        context->machine_state_tracer.write_machine_states(simgrid::s4u::Engine::get_clock());
+        context->machine_state_tracer.write_machine_states(now);
     }
 }
 
@@ -513,44 +716,66 @@ void Machines::update_machines_on_job_end(const JobPtr job,
                                           const IntervalSet & used_machines,
                                           BatsimContext * context)
 {
-    for (auto it = used_machines.elements_begin(); it != used_machines.elements_end(); ++it)
-    {
-        int machine_id = *it;
-        Machine * machine = _machines[static_cast<size_t>(machine_id)];
-
-        xbt_assert(!machine->jobs_being_computed.empty(), "inconsistency: marking machine %d on job '%s' end, while no job is being computed on the machine", machine_id, job->id.to_cstring());
-        const auto previous_top_job = *machine->jobs_being_computed.begin();
+    const double now = simgrid::s4u::Engine::get_clock();
 
-        // Let's erase jobID in the jobs_being_computed data structure
-        size_t ret = machine->jobs_being_computed.erase(job);
-        (void) ret; // Avoids a warning if assertions are ignored
-        xbt_assert(ret == 1, "could not erase job '%s' from jobs being computed of machine %d", job->id.to_cstring(), machine_id);
-
-        if (machine->jobs_being_computed.empty())
+    for (auto interval_it = used_machines.intervals_begin(); interval_it != used_machines.intervals_end(); ++interval_it)
+    {
+        // Contiguous machines that become idle are updated and traced as a whole
+        int idle_range_begin = -1;
+        auto flush_idle_range = [&](int idle_range_end)
         {
-            if (machine->state != MachineState::UNAVAILABLE)
+            if (idle_range_begin != -1)
             {
-                machine->update_machine_state(MachineState::IDLE);
+                update_machines_state(idle_range_begin, idle_range_end, MachineState::IDLE);
                 if (_tracer != nullptr)
                 {
-                    _tracer->set_machine_idle(machine->id, simgrid::s4u::Engine::get_clock());
+                    _tracer->set_machines_idle(idle_range_begin, idle_range_end, now);
                 }
+                idle_range_begin = -1;
             }
-        }
-        else if (*machine->jobs_being_computed.begin() != previous_top_job)
+        };
+
+        for (int machine_id = interval_it->lower(); machine_id <= interval_it->upper(); ++machine_id)
         {
-            if (_tracer != nullptr)
+            Machine * machine = _machines[static_cast<size_t>(machine_id)];
+
+            xbt_assert(!machine->jobs_being_computed.empty(), "inconsistency: marking machine %d on job '%s' end, while no job is being computed on the machine", machine_id, job->id.to_cstring());
+            const auto previous_top_job = *machine->jobs_being_computed.begin();
+
+            // Let's erase jobID in the jobs_being_computed data structure
+            size_t ret = machine->jobs_being_computed.erase(job);
+            (void) ret; // Avoids a warning if assertions are ignored
+            xbt_assert(ret == 1, "could not erase job '%s' from jobs being computed of machine %d", job->id.to_cstring(), machine_id);
+            _busy_machines.set(machine_id, !machine->jobs_being_computed.empty());
+
+            if (machine->jobs_being_computed.empty() && machine->state != MachineState::UNAVAILABLE)
             {
-                _tracer->set_machine_as_computing_job(machine->id,
-                                                      (*machine->jobs_being_computed.begin())->id,
-                                                      simgrid::s4u::Engine::get_clock());
+                if (idle_range_begin == -1)
+                {
+                    idle_range_begin = machine_id;
+                }
+                continue;
+            }
+
+            flush_idle_range(machine_id - 1);
+
+            if (!machine->jobs_being_computed.empty() && *machine->jobs_being_computed.begin() != previous_top_job)
+            {
+                if (_tracer != nullptr)
+                {
+                    _tracer->set_machine_as_computing_job(machine->id,
+                                                          (*machine->jobs_being_computed.begin())->id,
+                                                          now);
+                }
             }
         }
+
+        flush_idle_range(interval_it->upper());
     }
 
     if (context->trace_machine_states)
     {
-        context->machine_state_tracer.write_machine_states(simgrid::s4u::Engine::get_clock());
+        context->machine_state_tracer.write_machine_states(now);
     }
 }
 
@@ -592,15 +817,6 @@ Machine::Machine(Machines *machines) :
     machines(machines)
 {
     xbt_assert(this->machines != nullptr, "wrong call: machines is null");
-    const vector<MachineState> machine_states = {MachineState::SLEEPING, MachineState::IDLE,
-                                                 MachineState::COMPUTING,
-                                                 MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING,
-                                                 MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING,
-                                                 MachineState::UNAVAILABLE};
-    for (const MachineState & state : machine_states)
-    {
-        time_spent_in_each_state[state] = 0;
-    }
 }
 
 Machine::~Machine()
@@ -621,7 +837,24 @@ bool Machine::has_role(Permissions role) const
 
 bool Machine::has_pstate(int pstate) const
 {
-    return pstates.find(pstate) != pstates.end();
+    return pstate >= 0 && pstate < static_cast<int>(pstates.size()) &&
+           pstates[static_cast<size_t>(pstate)] != PStateType::UNDEFINED_PSTATE;
+}
+
+PStateType Machine::pstate_type(int pstate) const
+{
+    xbt_assert(has_pstate(pstate), "machine %d has no pstate %d", id, pstate);
+    return pstates[static_cast<size_t>(pstate)];
+}
+
+void Machine::set_pstate_type(int pstate, PStateType type)
+{
+    xbt_assert(pstate >= 0, "Invalid pstate %d", pstate);
+    if (pstate >= static_cast<int>(pstates.size()))
+    {
+        pstates.resize(static_cast<size_t>(pstate) + 1, PStateType::UNDEFINED_PSTATE);
+    }
+    pstates[static_cast<size_t>(pstate)] = type;
 }
 
 void Machine::display_machine(bool is_energy_used) const
@@ -646,20 +879,26 @@ void Machine::display_machine(bool is_energy_used) const
         vector<string> sleep_pstates_vector;
         vector<string> vt_pstates_vector;
 
-        for (auto & mit : pstates)
+        for (int ps = 0; ps < static_cast<int>(pstates.size()); ++ps)
         {
-            pstates_vector.push_back(to_string(mit.first));
-            if (mit.second == PStateType::COMPUTATION_PSTATE)
+            const PStateType pstate_type = pstates[static_cast<size_t>(ps)];
+            if (pstate_type == PStateType::UNDEFINED_PSTATE)
             {
-                comp_pstates_vector.push_back(to_string(mit.first));
+                continue;
             }
-            else if (mit.second == PStateType::SLEEP_PSTATE)
+
+            pstates_vector.push_back(to_string(ps));
+            if (pstate_type == PStateType::COMPUTATION_PSTATE)
             {
-                sleep_pstates_vector.push_back(to_string(mit.first));
+                comp_pstates_vector.push_back(to_string(ps));
             }
-            else if (mit.second == PStateType::TRANSITION_VIRTUAL_PSTATE)
+            else if (pstate_type == PStateType::SLEEP_PSTATE)
             {
-                vt_pstates_vector.push_back(to_string(mit.first));
+                sleep_pstates_vector.push_back(to_string(ps));
+            }
+            else if (pstate_type == PStateType::TRANSITION_VIRTUAL_PSTATE)
+            {
+                vt_pstates_vector.push_back(to_string(ps));
             }
         }
 
@@ -693,16 +932,293 @@ string Machine::jobs_being_computed_as_string() const
 
 void Machine::update_machine_state(MachineState new_state)
 {
-    long double current_date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+    machines->update_machine_state(this, new_state);
+}
 
-    long double delta_time = current_date - last_state_change_date;
-    xbt_assert(delta_time >= 0, "time inconsistency: time has decreased since last call");
+long double Machine::time_spent_in_state(MachineState state) const
+{
+    return machines->state_table().time_spent_in_each_state[state].at(static_cast<size_t>(id));
+}
+
+void MachineBitmap::resize(size_t nb_machines)
+{
+    _size = nb_machines;
+    _words.assign((nb_machines + 63) / 64, 0);
+}
+
+size_t MachineBitmap::size() const
+{
+    return _size;
+}
+
+void MachineBitmap::set(int machine_id, bool value)
+{
+    xbt_assert(machine_id >= 0 && static_cast<size_t>(machine_id) < _size, "Invalid machine %d", machine_id);
+    const uint64_t mask = uint64_t(1) << (static_cast<size_t>(machine_id) % 64);
+    uint64_t & word = _words[static_cast<size_t>(machine_id) / 64];
+    if (value)
+    {
+        word |= mask;
+    }
+    else
+    {
+        word &= ~mask;
+    }
+}
+
+bool MachineBitmap::test(int machine_id) const
+{
+    xbt_assert(machine_id >= 0 && static_cast<size_t>(machine_id) < _size, "Invalid machine %d", machine_id);
+    return (_words[static_cast<size_t>(machine_id) / 64] >> (static_cast<size_t>(machine_id) % 64)) & 1;
+}
+
+bool MachineBitmap::is_valid_range(int first_machine_id, int last_machine_id) const
+{
+    return first_machine_id >= 0 && first_machine_id <= last_machine_id &&
+           static_cast<size_t>(last_machine_id) < _size;
+}
+
+/**
+ * @brief Returns the mask of the bits of a word that are within a range of machines
+ * @param[in] word_index The index of the word
+ * @param[in] first The first machine of the range
+ * @param[in] last The last machine of the range (included)
+ * @return The mask of the bits of the word within [first,last]
+ */
+static uint64_t range_mask(size_t word_index, size_t first, size_t last)
+{
+    const size_t word_first = word_index * 64;
+    const size_t low = (first > word_first) ? first - word_first : 0;
+    const size_t high = (last < word_first + 63) ? last - word_first : 63;
+
+    const uint64_t high_mask = (high == 63) ? ~uint64_t(0) : ((uint64_t(1) << (high + 1)) - 1);
+    const uint64_t low_mask = ~((uint64_t(1) << low) - 1);
+    return high_mask & low_mask;
+}
+
+bool MachineBitmap::all_in_range(int first_machine_id, int last_machine_id) const
+{
+    if (!is_valid_range(first_machine_id, last_machine_id))
+    {
+        return false;
+    }
+
+    const size_t first = static_cast<size_t>(first_machine_id);
+    const size_t last = static_cast<size_t>(last_machine_id);
+    for (size_t word_index = first / 64; word_index <= last / 64; ++word_index)
+    {
+        const uint64_t mask = range_mask(word_index, first, last);
+        if ((_words[word_index] & mask) != mask)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MachineBitmap::none_in_range_of_both(const MachineBitmap & other, int first_machine_id, int last_machine_id) const
+{
+    xbt_assert(other._size == _size, "Bitmaps of different sizes (%zu and %zu)", _size, other._size);
+    if (!is_valid_range(first_machine_id, last_machine_id))
+    {
+        return false;
+    }
 
-    time_spent_in_each_state[state] += delta_time;
+    const size_t first = static_cast<size_t>(first_machine_id);
+    const size_t last = static_cast<size_t>(last_machine_id);
+    for (size_t word_index = first / 64; word_index <= last / 64; ++word_index)
+    {
+        const uint64_t mask = range_mask(word_index, first, last);
+        if ((_words[word_index] & other._words[word_index] & mask) != 0)
+        {
+            return false;
+        }
+    }
 
-    machines->update_nb_machines_in_each_state(state, new_state);
-    state = new_state;
-    last_state_change_date = current_date;
+    return true;
+}
+
+void EnergyIntegrator::initialize(const std::vector<Machine *> & machines)
+{
+    xbt_assert(!_initialized, "Double call of EnergyIntegrator::initialize");
+    _initialized = true;
+
+    const long double now = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+
+    _machines.resize(machines.size());
+    _offset_tree.assign(machines.size() + 1, 0);
+    _power_tree.assign(machines.size() + 1, 0);
+    for (const Machine * machine : machines)
+    {
+        MachineEnergy & me = _machines[static_cast<size_t>(machine->id)];
+        me.machine = machine;
+        me.date = now;
+        me.wattmin = static_cast<long double>(sg_host_get_wattmin_at(machine->host, machine->host->get_pstate()));
+
+        _total_wattmin += me.wattmin;
+        _unstable_machines.insert(_unstable_machines.end(), machine->id);
+    }
+}
+
+void EnergyIntegrator::on_power_change(const Machine *machine)
+{
+    if (!_initialized || machine->id < 0)
+    {
+        return;
+    }
+
+    MachineEnergy & me = _machines[static_cast<size_t>(machine->id)];
+    if (me.stable)
+    {
+        // The energy consumed until now is not needed: it will be retrieved from SimGrid while the machine is unstable
+        add_stable_terms(machine->id, -(me.energy_at_date - me.power * me.date), -me.power);
+        me.stable = false;
+        _unstable_machines.insert(machine->id);
+    }
+    me.date = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+
+    // The power state may have changed
+    _total_wattmin -= me.wattmin;
+    me.wattmin = static_cast<long double>(sg_host_get_wattmin_at(machine->host, machine->host->get_pstate()));
+    _total_wattmin += me.wattmin;
+}
+
+void EnergyIntegrator::begin_exact_period(const Machine *machine)
+{
+    if (!_initialized || machine->id < 0)
+    {
+        return;
+    }
+
+    on_power_change(machine);
+    _machines[static_cast<size_t>(machine->id)].nb_exact_periods++;
+}
+
+void EnergyIntegrator::end_exact_period(const Machine *machine)
+{
+    if (!_initialized || machine->id < 0)
+    {
+        return;
+    }
+
+    MachineEnergy & me = _machines[static_cast<size_t>(machine->id)];
+    xbt_assert(me.nb_exact_periods > 0, "Unbalanced end of exact energy period on machine '%s'", machine->name.c_str());
+    me.nb_exact_periods--;
+
+    // The load has changed since the power of the machine has last been sampled
+    on_power_change(machine);
+}
+
+bool EnergyIntegrator::try_to_stabilize(MachineEnergy & me, long double now)
+{
+    const Machine * machine = me.machine;
+    if (me.nb_exact_periods > 0 || now <= me.date || !machine->jobs_being_computed.empty() ||
+        (machine->state != MachineState::IDLE && machine->state != MachineState::SLEEPING))
+    {
+        return false;
+    }
+
+    me.stable = true;
+    me.date = now;
+    me.energy_at_date = static_cast<long double>(sg_host_get_consumed_energy(machine->host));
+    me.power = static_cast<long double>(sg_host_get_current_consumption(machine->host));
+
+    add_stable_terms(machine->id, me.energy_at_date - me.power * me.date, me.power);
+    return true;
+}
+
+void EnergyIntegrator::add_stable_terms(int machine_id, long double offset, long double power)
+{
+    _stable_energy_offset += offset;
+    _stable_power += power;
+
+    for (size_t i = static_cast<size_t>(machine_id) + 1; i < _offset_tree.size(); i += i & (~i + 1))
+    {
+        _offset_tree[i] += offset;
+        _power_tree[i] += power;
+    }
+}
+
+void EnergyIntegrator::stable_prefix_sums(int machine_id, long double & offset, long double & power) const
+{
+    offset = 0;
+    power = 0;
+
+    for (size_t i = static_cast<size_t>(machine_id + 1); i > 0; i -= i & (~i + 1))
+    {
+        offset += _offset_tree[i];
+        power += _power_tree[i];
+    }
+}
+
+long double EnergyIntegrator::consumed_energy(const Machine *machine)
+{
+    const long double now = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+    MachineEnergy & me = _machines[static_cast<size_t>(machine->id)];
+
+    if (me.stable)
+    {
+        return me.energy_at_date + me.power * (now - me.date);
+    }
+
+    if (try_to_stabilize(me, now))
+    {
+        _unstable_machines.erase(machine->id);
+        return me.energy_at_date;
+    }
+
+    return static_cast<long double>(sg_host_get_consumed_energy(machine->host));
+}
+
+long double EnergyIntegrator::consumed_energy(int first, int last)
+{
+    const long double now = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+    long double unstable_energy = 0;
+
+    // Unstable machines of the range are stabilized if they can be, or queried from SimGrid
+    for (auto it = _unstable_machines.lower_bound(first); it != _unstable_machines.end() && *it <= last; )
+    {
+        MachineEnergy & me = _machines[static_cast<size_t>(*it)];
+        if (try_to_stabilize(me, now))
+        {
+            it = _unstable_machines.erase(it);
+        }
+        else
+        {
+            unstable_energy += static_cast<long double>(sg_host_get_consumed_energy(me.machine->host));
+            ++it;
+        }
+    }
+
+    // The energy of the stable machines of the range is integrated from the prefix sums
+    long double offset_before, power_before, offset_last, power_last;
+    stable_prefix_sums(first - 1, offset_before, power_before);
+    stable_prefix_sums(last, offset_last, power_last);
+
+    return (offset_last - offset_before) + (power_last - power_before) * now + unstable_energy;
+}
+
+long double EnergyIntegrator::total_consumed_energy()
+{
+    const long double now = static_cast<long double>(simgrid::s4u::Engine::get_clock());
+    long double unstable_energy = 0;
+
+    for (auto it = _unstable_machines.begin(); it != _unstable_machines.end(); )
+    {
+        MachineEnergy & me = _machines[static_cast<size_t>(*it)];
+        if (try_to_stabilize(me, now))
+        {
+            it = _unstable_machines.erase(it);
+        }
+        else
+        {
+            unstable_energy += static_cast<long double>(sg_host_get_consumed_energy(me.machine->host));
+            ++it;
+        }
+    }
+
+    return _stable_energy_offset + _stable_power * now + unstable_energy;
 }
 
 int string_numeric_comparator(const std::string & s1, const std::string & s2)
@@ -823,13 +1339,5 @@ long double consumed_energy_on_machines(BatsimContext * context,
         return 0;
     }
 
-    long double consumed_energy = 0;
-    for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
-    {
-        int machine_id = *it;
-        Machine * machine = context->machines[machine_id];
-        consumed_energy += static_cast<long double>(sg_host_get_consumed_energy(machine->host));
-    }
-
-    return consumed_energy;
+    return context->machines.consumed_energy(context, machines);
 }
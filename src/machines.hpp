@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -37,16 +39,38 @@ enum class MachineState
     ,UNAVAILABLE                            //!< The machine is unavailable
 };
 
-/// @cond DOXYGEN_SHOULD_SKIP_THIS
-// Required by old C++ to use MachineState as a key type in a hashmap
-namespace std
+//! The number of MachineState values. MachineState::UNAVAILABLE must remain the last MachineState.
+constexpr size_t NB_MACHINE_STATES = static_cast<size_t>(MachineState::UNAVAILABLE) + 1;
+
+/**
+ * @brief A dense array indexed by MachineState
+ */
+template <typename T>
+struct MachineStateArray
 {
-    template <> struct hash<MachineState>
-    {
-        size_t operator() (const MachineState &t) const { return size_t(t); }
-    };
-}
-/// @endcond
+    std::array<T, NB_MACHINE_STATES> values{}; //!< The values, indexed by MachineState
+
+    /**
+     * @brief Accesses the value associated with a MachineState
+     * @param[in] state The MachineState
+     * @return The value associated with state
+     */
+    T & operator[](MachineState state) { return values[static_cast<size_t>(state)]; }
+
+    /**
+     * @brief Accesses the value associated with a MachineState
+     * @param[in] state The MachineState
+     * @return The value associated with state
+     */
+    const T & operator[](MachineState state) const { return values[static_cast<size_t>(state)]; }
+
+    /**
+     * @brief Accesses the value associated with a MachineState
+     * @param[in] state The MachineState
+     * @return The value associated with state
+     */
+    const T & at(MachineState state) const { return values.at(static_cast<size_t>(state)); }
+};
 
 /**
  * @brief Represents a machine
@@ -72,12 +96,9 @@ struct Machine
     MachineState state = MachineState::IDLE; //!< The current state of the Machine
     std::set<JobPtr> jobs_being_computed; //!< The set of jobs being computed on the Machine
 
-    std::unordered_map<int, PStateType> pstates; //!< Maps power state number to their power state type
+    std::vector<PStateType> pstates; //!< The type of each power state, indexed by power state number (UNDEFINED_PSTATE if it does not exist)
     std::unordered_map<int, SleepPState *> sleep_pstates; //!< Maps sleep power state numbers to their SleepPState
 
-    long double last_state_change_date = 0; //!< The time at which the last state change has been done
-    std::unordered_map<MachineState, long double> time_spent_in_each_state; //!< The cumulated time of the machine in each MachineState
-
     std::unordered_map<std::string, std::string> properties; //!< Properties defined in the platform file
     std::unordered_map<std::string, std::string> zone_properties; //!< Properties of Zones defined in the platform file
 
@@ -95,6 +116,20 @@ struct Machine
      */
     bool has_pstate(int pstate) const;
 
+    /**
+     * @brief Returns the type of a power state of the Machine
+     * @param[in] pstate The power state, which must exist
+     * @return The type of the power state
+     */
+    PStateType pstate_type(int pstate) const;
+
+    /**
+     * @brief Sets the type of a power state of the Machine
+     * @param[in] pstate The power state
+     * @param[in] type The type of the power state
+     */
+    void set_pstate_type(int pstate, PStateType type);
+
     /**
      * @brief Displays the Machine (debug purpose)
      * @param[in] is_energy_used Must be set to true if energy information should be displayed
@@ -112,6 +147,91 @@ struct Machine
      * @param[in] new_state The new state of the machine
      */
     void update_machine_state(MachineState new_state);
+
+    /**
+     * @brief Returns the cumulated time spent by the Machine in a MachineState, until its last state change
+     * @param[in] state The MachineState
+     * @return The cumulated time spent by the Machine in state
+     */
+    long double time_spent_in_state(MachineState state) const;
+};
+
+/**
+ * @brief A set of machine ids, stored as a bitmap
+ * @details Queries on ranges of contiguous machines are done word by word,
+ *          which makes the validation of allocations made of large intervals cheap.
+ */
+class MachineBitmap
+{
+public:
+    /**
+     * @brief Resizes the bitmap. All the bits are cleared.
+     * @param[in] nb_machines The number of machines
+     */
+    void resize(size_t nb_machines);
+
+    /**
+     * @brief Returns the number of machines of the bitmap
+     * @return The number of machines of the bitmap
+     */
+    size_t size() const;
+
+    /**
+     * @brief Sets or clears the bit of a machine
+     * @param[in] machine_id The machine
+     * @param[in] value The new value of the bit
+     */
+    void set(int machine_id, bool value);
+
+    /**
+     * @brief Returns the bit of a machine
+     * @param[in] machine_id The machine
+     * @return The bit of the machine
+     */
+    bool test(int machine_id) const;
+
+    /**
+     * @brief Returns whether all the bits of a range of machines are set
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @return Whether all the bits of [first_machine_id,last_machine_id] are set. False if the range is out of the bitmap.
+     */
+    bool all_in_range(int first_machine_id, int last_machine_id) const;
+
+    /**
+     * @brief Returns whether no machine of a range has its bit set both in this bitmap and in another one
+     * @param[in] other The other bitmap, of the same size
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @return Whether (this & other) has no bit set in [first_machine_id,last_machine_id]. False if the range is out of the bitmap.
+     */
+    bool none_in_range_of_both(const MachineBitmap & other, int first_machine_id, int last_machine_id) const;
+
+private:
+    /**
+     * @brief Returns whether a range of machines is within the bitmap
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @return Whether the range is valid and within the bitmap
+     */
+    bool is_valid_range(int first_machine_id, int last_machine_id) const;
+
+private:
+    std::vector<uint64_t> _words; //!< The bits, 64 machines per word
+    size_t _size = 0; //!< The number of machines
+};
+
+/**
+ * @brief Stores the machine data touched on every MachineState change, as dense arrays indexed by machine id
+ * @details This structure-of-arrays layout keeps the state change hot path and the per-state aggregations cache-friendly
+ *          on platforms with many machines. Machine::state is mirrored in states, so that scans over many machines
+ *          do not need to dereference Machine objects.
+ */
+struct MachineStateTable
+{
+    std::vector<MachineState> states; //!< The current state of each machine
+    std::vector<long double> last_state_change_dates; //!< The time at which the last state change of each machine has been done
+    MachineStateArray<std::vector<long double>> time_spent_in_each_state; //!< The cumulated time of each machine in each MachineState ([state][machine_id])
 };
 
 /**
@@ -131,6 +251,129 @@ int string_numeric_comparator(const std::string & s1, const std::string & s2);
  */
 bool machine_comparator_name(const Machine * m1, const Machine * m2);
 
+/**
+ * @brief Incrementally integrates the energy consumed by the machines
+ * @details The power of a machine that is idle or sleeping (and on which nothing is executed) is constant
+ *          until Batsim changes its state or its power state. The energy of such "stable" machines is
+ *          integrated analytically, while the energy of the other machines is retrieved from SimGrid.
+ *          The integration terms of stable machines are stored in Fenwick trees indexed by machine unique number,
+ *          so that the energy of a machine interval is computed in O(log(number of machines)) plus one SimGrid call
+ *          per unstable machine of the interval.
+ *          A machine becomes stable at the first query strictly after its last power change, so that
+ *          SimGrid has already taken the new load/power state into account when its power is sampled.
+ */
+class EnergyIntegrator
+{
+public:
+    /**
+     * @brief Initializes the integrator on the given machines. All machines start unstable.
+     * @param[in] machines The machines to track (indexed by their unique number)
+     */
+    void initialize(const std::vector<Machine *> & machines);
+
+    /**
+     * @brief Returns whether the integrator has been initialized
+     * @return Whether the integrator has been initialized
+     */
+    bool is_initialized() const { return _initialized; }
+
+    /**
+     * @brief Must be called when the power of a machine may change (state or power state change)
+     * @param[in] machine The machine whose power may change
+     */
+    void on_power_change(const Machine * machine);
+
+    /**
+     * @brief Marks that the load of a machine may change without Batsim knowing it (e.g., IO target of a running job).
+     * @details The energy of such machines is retrieved from SimGrid until end_exact_period has been called as many
+     *          times as begin_exact_period.
+     * @param[in] machine The machine
+     */
+    void begin_exact_period(const Machine * machine);
+
+    /**
+     * @brief Marks the end of a period started by begin_exact_period
+     * @param[in] machine The machine
+     */
+    void end_exact_period(const Machine * machine);
+
+    /**
+     * @brief Returns the energy consumed by one machine since time 0
+     * @param[in] machine The machine
+     * @return The energy (in joules) consumed by the machine since time 0
+     */
+    long double consumed_energy(const Machine * machine);
+
+    /**
+     * @brief Returns the energy consumed by a contiguous range of machines since time 0
+     * @param[in] first The unique number of the first machine of the range
+     * @param[in] last The unique number of the last machine of the range (included)
+     * @return The energy (in joules) consumed by the machines of the range since time 0
+     */
+    long double consumed_energy(int first, int last);
+
+    /**
+     * @brief Returns the energy consumed by all the tracked machines since time 0
+     * @return The energy (in joules) consumed by all the tracked machines since time 0
+     */
+    long double total_consumed_energy();
+
+    /**
+     * @brief Returns the sum of the wattmin of all the tracked machines in their current power state
+     * @return The sum of the wattmin of all the tracked machines
+     */
+    long double total_wattmin() const { return _total_wattmin; }
+
+private:
+    /**
+     * @brief Energy-related information about one machine
+     */
+    struct MachineEnergy
+    {
+        const Machine * machine = nullptr; //!< The tracked machine
+        bool stable = false; //!< Whether the power of the machine is constant since date
+        int nb_exact_periods = 0; //!< The number of ongoing periods during which the machine energy must be retrieved from SimGrid
+        long double date = 0; //!< The date of the last power change if unstable, or the date since which the machine is stable
+        long double energy_at_date = 0; //!< The energy consumed by the machine at date (only meaningful if stable)
+        long double power = 0; //!< The power of the machine (only meaningful if stable)
+        long double wattmin = 0; //!< The wattmin of the machine in its current power state
+    };
+
+    /**
+     * @brief Makes a machine stable if it can be. The caller must remove the machine from _unstable_machines on success.
+     * @param[in,out] me The MachineEnergy of the machine
+     * @param[in] now The current simulation date
+     * @return Whether the machine has been made stable
+     */
+    bool try_to_stabilize(MachineEnergy & me, long double now);
+
+    /**
+     * @brief Adds the integration terms of a machine into the stable sums
+     * @param[in] machine_id The machine unique number
+     * @param[in] offset The term to add to the energy offset (energy_at_date - power * date)
+     * @param[in] power The term to add to the power
+     */
+    void add_stable_terms(int machine_id, long double offset, long double power);
+
+    /**
+     * @brief Computes the stable sums of the machines whose unique number is lower than or equal to machine_id
+     * @param[in] machine_id The machine unique number (-1 for an empty prefix)
+     * @param[out] offset The sum of the energy offsets of the stable machines of the prefix
+     * @param[out] power The sum of the power of the stable machines of the prefix
+     */
+    void stable_prefix_sums(int machine_id, long double & offset, long double & power) const;
+
+private:
+    bool _initialized = false; //!< Whether initialize has been called
+    std::vector<MachineEnergy> _machines; //!< The energy information of each machine (indexed by machine unique number)
+    std::set<int> _unstable_machines; //!< The unique numbers of the machines that are not stable
+    std::vector<long double> _offset_tree; //!< Fenwick tree of (energy_at_date - power * date) over stable machines
+    std::vector<long double> _power_tree; //!< Fenwick tree of power over stable machines
+    long double _stable_energy_offset = 0; //!< Sum over stable machines of (energy_at_date - power * date)
+    long double _stable_power = 0; //!< Sum over stable machines of power
+    long double _total_wattmin = 0; //!< Sum over all machines of wattmin
+};
+
 /**
  * @brief Handles all the machines used in the simulation
  */
@@ -262,6 +505,56 @@ public:
      */
     long double total_wattmin(const BatsimContext * context) const;
 
+    /**
+     * @brief Computes and returns the energy consumed by one machine since time 0
+     * @param[in] context The BatsimContext
+     * @param[in] machine The machine
+     * @return The energy (in joules) consumed by the machine since time 0
+     */
+    long double consumed_energy(const BatsimContext * context, const Machine * machine) const;
+
+    /**
+     * @brief Must be called when the power of a machine may have changed outside of a MachineState change (e.g., power state change)
+     * @param[in] machine The machine whose power may have changed
+     */
+    void notify_machine_power_change(const Machine * machine);
+
+    /**
+     * @brief Returns whether a job can be executed on some machines right now
+     * @details This is checked with word-wise operations on bitmaps maintained incrementally, interval by interval.
+     *          It does not explain why an allocation is invalid: callers should check machines one by one to do so.
+     * @param[in] machines The machines onto which the job would be executed
+     * @param[in] allow_compute_sharing Whether compute machines can compute several jobs at the same time
+     * @param[in] allow_storage_sharing Whether storage machines can compute several jobs at the same time
+     * @param[in] check_pstates Whether the machines must be in a computation power state
+     * @return Whether all the machines exist, are idle or computing, are not shared if forbidden, and are in a computation pstate if checked
+     */
+    bool can_execute_job_on(const IntervalSet & machines,
+                            bool allow_compute_sharing,
+                            bool allow_storage_sharing,
+                            bool check_pstates) const;
+
+    /**
+     * @brief Must be called on machines whose load may change without any MachineState change (e.g., IO targets of a starting job)
+     * @details The energy of these machines is retrieved from SimGrid until enable_energy_integration is called on them.
+     * @param[in] machines The machines
+     */
+    void disable_energy_integration(const IntervalSet & machines);
+
+    /**
+     * @brief Must be called on the machines given to disable_energy_integration once their load is known again (e.g., job end)
+     * @param[in] machines The machines
+     */
+    void enable_energy_integration(const IntervalSet & machines);
+
+    /**
+     * @brief Computes and returns the energy consumed on some machines since time 0
+     * @param[in] context The BatsimContext
+     * @param[in] machines The machines
+     * @return The energy (in joules) consumed on the machines since time 0
+     */
+    long double consumed_energy(const BatsimContext * context, const IntervalSet & machines) const;
+
     /**
      * @brief Returns the total number of machines
      * @return The total number of machines
@@ -281,17 +574,46 @@ public:
     unsigned int nb_storage_machines() const;
 
     /**
-     * @brief Updates the number of machines in each state after a MachineState transition
-     * @param[in] old_state The old state of a Machine
-     * @param[in] new_state The new state of a Machine
+     * @brief Updates the MachineState of one machine, updating logging counters
+     * @param[in] machine The machine
+     * @param[in] new_state The new state of the machine
+     */
+    void update_machine_state(Machine * machine, MachineState new_state);
+
+    /**
+     * @brief Updates the MachineState of a range of contiguous machines, updating logging counters
+     * @details The range is processed as a whole: counters are updated once and per-machine data is traversed contiguously.
+     * @param[in] first_machine_id The first machine of the range
+     * @param[in] last_machine_id The last machine of the range (included)
+     * @param[in] new_state The new state of the machines
+     */
+    void update_machines_state(int first_machine_id, int last_machine_id, MachineState new_state);
+
+    /**
+     * @brief Updates the MachineState of several machines, updating logging counters. Intervals are processed as a whole.
+     * @param[in] machines The machines
+     * @param[in] new_state The new state of the machines
      */
-    void update_nb_machines_in_each_state(MachineState old_state, MachineState new_state);
+    void update_machines_state(const IntervalSet & machines, MachineState new_state);
 
     /**
      * @brief _nb_machines_in_each_state getter
      * @return A const reference to _nb_machines_in_each_state getter
      */
-    const std::map<MachineState, int> & nb_machines_in_each_state() const;
+    const MachineStateArray<int> & nb_machines_in_each_state() const;
+
+    /**
+     * @brief _state_table getter
+     * @return A const reference to the dense per-machine state data
+     */
+    const MachineStateTable & state_table() const;
+
+    /**
+     * @brief Returns the cumulated time spent by all machines in a MachineState, until their last state change
+     * @param[in] state The MachineState
+     * @return The cumulated time spent by all machines in state
+     */
+    long double total_time_spent_in_state(MachineState state) const;
 
     /**
      * @brief Add the properties of zones to each machine inside the zone
@@ -301,6 +623,12 @@ public:
     void attach_zone_properties_to_machines(simgrid::s4u::NetZone * current_zone,
                                             std::unordered_map<std::string, std::string> parent_properties);
 
+    /**
+     * @brief Updates the bit of a machine in the computation pstate bitmap, according to its current pstate
+     * @param[in] machine The machine
+     */
+    void update_computation_pstate_bit(const Machine * machine);
+
 
 private:
     std::vector<Machine *> _machines;       //!< The vector of all machines
@@ -308,7 +636,14 @@ private:
     std::vector<Machine *> _compute_nodes;  //!< The vector of computing machines
     Machine * _master_machine = nullptr;    //!< The master machine
     PajeTracer * _tracer = nullptr;         //!< The PajeTracer
-    std::map<MachineState, int> _nb_machines_in_each_state; //!< Counts how many machines are in each state
+    MachineStateArray<int> _nb_machines_in_each_state; //!< Counts how many machines are in each state
+    MachineStateTable _state_table; //!< The dense per-machine data touched on every state change
+    MachineBitmap _busy_machines; //!< The machines which are computing at least one job
+    MachineBitmap _available_machines; //!< The machines which are idle or computing
+    MachineBitmap _computation_pstate_machines; //!< The machines whose current pstate is a computation one
+    MachineBitmap _compute_node_machines; //!< The machines which have the compute node role
+    MachineBitmap _storage_machines; //!< The machines which have the storage role
+    mutable EnergyIntegrator _energy_integrator; //!< Incrementally integrates the energy consumed by the machines (lazily initialized)
 };
 
 /**
@@ -0,0 +1,68 @@
+#include "name_set.hpp"
+
+#include <climits>
+
+void NameSet::insert(const std::string & name)
+{
+    int value;
+    if (parse_numeric_name(name, value))
+    {
+        _numeric_names.insert(value);
+    }
+    else
+    {
+        _other_names.insert(name);
+    }
+}
+
+bool NameSet::contains(const std::string & name) const
+{
+    int value;
+    if (parse_numeric_name(name, value))
+    {
+        return _numeric_names.contains(value);
+    }
+    return _other_names.count(name) == 1;
+}
+
+size_t NameSet::size() const
+{
+    return _numeric_names.size() + _other_names.size();
+}
+
+size_t NameSet::nb_stored_items() const
+{
+    size_t nb_intervals = 0;
+    for (auto it = _numeric_names.intervals_begin(); it != _numeric_names.intervals_end(); ++it)
+    {
+        ++nb_intervals;
+    }
+    return nb_intervals + _other_names.size();
+}
+
+bool NameSet::parse_numeric_name(const std::string & name, int & value)
+{
+    // Leading zeros are forbidden, as "042" and "42" are different names
+    if (name.empty() || (name.size() > 1 && name[0] == '0'))
+    {
+        return false;
+    }
+
+    long long result = 0;
+    for (const char c : name)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+
+        result = result * 10 + (c - '0');
+        if (result > INT_MAX)
+        {
+            return false;
+        }
+    }
+
+    value = static_cast<int>(result);
+    return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file name_set.hpp
+ * @brief Memory-bounded storage of the names (job names, profile names...) met during a simulation
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include <intervalset.hpp>
+
+/**
+ * @brief A set of names, which only stores what is needed to know whether a name has been inserted
+ * @details Names that are canonical non-negative integers (such as "42", but not "042" nor "-1") are stored
+ *          in an IntervalSet, which only uses the memory of one interval for any number of consecutive ids.
+ *          Other names are stored in a hash set.
+ */
+class NameSet
+{
+public:
+    /**
+     * @brief Inserts a name into the set
+     * @param[in] name The name to insert
+     */
+    void insert(const std::string & name);
+
+    /**
+     * @brief Returns whether a name has been inserted into the set
+     * @param[in] name The name
+     * @return Whether name has been inserted into the set
+     */
+    bool contains(const std::string & name) const;
+
+    /**
+     * @brief Returns the number of names in the set
+     * @return The number of names in the set
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the number of items stored to represent the set (intervals of numeric names + other names)
+     * @return The number of items stored to represent the set
+     */
+    size_t nb_stored_items() const;
+
+private:
+    /**
+     * @brief Returns whether a name is a canonical non-negative integer that fits in an int
+     * @param[in] name The name
+     * @param[out] value The integer value of the name, if the name is numeric
+     * @return Whether name is numeric
+     */
+    static bool parse_numeric_name(const std::string & name, int & value);
+
+private:
+    IntervalSet _numeric_names; //!< The names that are canonical non-negative integers
+    std::unordered_set<std::string> _other_names; //!< The other names
+};
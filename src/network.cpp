@@ -54,7 +54,11 @@ void request_reply_scheduler_process(BatsimContext * context, std::string send_b
 
         auto end = chrono::steady_clock::now();
         long double elapsed_microseconds = static_cast<long double>(chrono::duration <long double, micro> (end - start).count());
-        context->microseconds_used_by_scheduler += elapsed_microseconds;
+        {
+            // The message parsing below locks the shared state by itself
+            auto shared_state_lock = lock_shared_state(context);
+            context->microseconds_used_by_scheduler += elapsed_microseconds;
+        }
 
         context->proto_reader->parse_and_apply_message(message_received);
     }
@@ -63,7 +67,10 @@ void request_reply_scheduler_process(BatsimContext * context, std::string send_b
         XBT_INFO("Runtime error received: %s", error.what());
         XBT_INFO("Flushing output files...");
 
-        finalize_batsim_outputs(context);
+        {
+            auto shared_state_lock = lock_shared_state(context);
+            finalize_batsim_outputs(context);
+        }
 
         XBT_INFO("Output files flushed. Aborting execution now.");
         throw runtime_error("Execution aborted (connection broken)");
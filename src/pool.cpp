@@ -0,0 +1,85 @@
+#include "pool.hpp"
+
+#include <algorithm>
+
+#include <simgrid/s4u.hpp>
+
+FixedSizePool::FixedSizePool(size_t block_size, size_t nb_blocks_per_slab) :
+    _nb_blocks_per_slab(nb_blocks_per_slab)
+{
+    xbt_assert(nb_blocks_per_slab > 0, "Invalid number of blocks per slab (0)");
+
+    // Every block must be able to store a FreeBlock and to be aligned like the slab itself
+    const size_t alignment = alignof(std::max_align_t);
+    block_size = std::max(block_size, sizeof(FreeBlock));
+    _block_size = (block_size + alignment - 1) / alignment * alignment;
+}
+
+FixedSizePool::~FixedSizePool()
+{
+    for (void * slab : _slabs)
+    {
+        ::operator delete(slab);
+    }
+}
+
+void * FixedSizePool::allocate()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_free_list == nullptr)
+    {
+        add_slab();
+    }
+
+    FreeBlock * block = _free_list;
+    _free_list = block->next;
+    ++_nb_allocated_blocks;
+    return block;
+}
+
+void FixedSizePool::deallocate(void * block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    xbt_assert(_nb_allocated_blocks > 0, "Internal error: deallocating a block from an empty pool");
+
+    auto * free_block = static_cast<FreeBlock *>(block);
+    free_block->next = _free_list;
+    _free_list = free_block;
+    --_nb_allocated_blocks;
+}
+
+size_t FixedSizePool::block_size() const
+{
+    return _block_size;
+}
+
+size_t FixedSizePool::nb_allocated_blocks() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nb_allocated_blocks;
+}
+
+size_t FixedSizePool::nb_slabs() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slabs.size();
+}
+
+void FixedSizePool::add_slab()
+{
+    char * slab = static_cast<char *>(::operator new(_block_size * _nb_blocks_per_slab));
+    _slabs.push_back(slab);
+
+    // Blocks are chained in address order, so that consecutive allocations are contiguous
+    for (size_t i = _nb_blocks_per_slab; i > 0; --i)
+    {
+        auto * block = reinterpret_cast<FreeBlock *>(slab + (i - 1) * _block_size);
+        block->next = _free_list;
+        _free_list = block;
+    }
+}
@@ -0,0 +1,167 @@
+/**
+ * @file pool.hpp
+ * @brief Slab allocation of the many small objects that Batsim creates and destroys during a simulation (jobs, tasks...)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Allocates fixed-size blocks from large slabs
+ * @details Freed blocks are kept in a free list and reused by the next allocations.
+ *          Slabs are only released when the pool is destroyed, so that objects of the same kind stay packed together
+ *          instead of fragmenting the heap.
+ */
+class FixedSizePool
+{
+public:
+    /**
+     * @brief Builds a FixedSizePool
+     * @param[in] block_size The size (in bytes) of the blocks
+     * @param[in] nb_blocks_per_slab The number of blocks allocated at once when the pool is empty
+     */
+    explicit FixedSizePool(size_t block_size, size_t nb_blocks_per_slab = 256);
+
+    /**
+     * @brief Destroys a FixedSizePool
+     * @details All the blocks are released, whether they have been deallocated or not.
+     */
+    ~FixedSizePool();
+
+    /**
+     * @brief FixedSizePool cannot be copied.
+     * @param[in] other Another instance
+     */
+    FixedSizePool(const FixedSizePool & other) = delete;
+
+    /**
+     * @brief Allocates one block
+     * @return The allocated block, aligned for any fundamental type
+     */
+    void * allocate();
+
+    /**
+     * @brief Gives a block back to the pool
+     * @param[in] block A block previously returned by allocate() on this pool
+     */
+    void deallocate(void * block);
+
+    /**
+     * @brief Returns the size of the blocks of the pool
+     * @return The size (in bytes) of the blocks of the pool
+     */
+    size_t block_size() const;
+
+    /**
+     * @brief Returns the number of blocks that are currently allocated
+     * @return The number of blocks that are currently allocated
+     */
+    size_t nb_allocated_blocks() const;
+
+    /**
+     * @brief Returns the number of slabs of the pool
+     * @return The number of slabs of the pool
+     */
+    size_t nb_slabs() const;
+
+private:
+    //! A free block, which stores the next free block in its own memory
+    struct FreeBlock
+    {
+        FreeBlock * next; //!< The next free block
+    };
+
+    /**
+     * @brief Allocates a new slab and puts its blocks in the free list
+     */
+    void add_slab();
+
+private:
+    size_t _block_size; //!< The size of the blocks (in bytes), rounded to the fundamental alignment
+    size_t _nb_blocks_per_slab; //!< The number of blocks of each slab
+    std::vector<void *> _slabs; //!< The slabs of the pool
+    FreeBlock * _free_list = nullptr; //!< The blocks that can be allocated
+    size_t _nb_allocated_blocks = 0; //!< The number of blocks that are currently allocated
+    mutable std::mutex _mutex; //!< Guards the pool, as objects can be created from SimGrid actors
+};
+
+/**
+ * @brief Returns the pool used to allocate the objects of a given type
+ * @details The pool is never destroyed, so that objects that outlive static destructors can still be deallocated.
+ * @return The pool of the objects of type T
+ */
+template <typename T>
+FixedSizePool & pool_of()
+{
+    static FixedSizePool * pool = new FixedSizePool(sizeof(T));
+    return *pool;
+}
+
+/**
+ * @brief A standard allocator that allocates single objects from a FixedSizePool
+ * @details Meant to be used with std::allocate_shared, which allocates the object and its control block together.
+ *          Arrays are allocated with the global operator new.
+ */
+template <typename T>
+struct PoolAllocator
+{
+    typedef T value_type; //!< The type of the allocated objects
+
+    PoolAllocator() = default;
+
+    /**
+     * @brief Builds a PoolAllocator from an allocator of another type (rebinding)
+     */
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    /**
+     * @brief Allocates memory for some objects
+     * @param[in] n The number of objects
+     * @return The allocated memory
+     */
+    T * allocate(size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<T *>(pool_of<T>().allocate());
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    /**
+     * @brief Releases memory previously returned by allocate()
+     * @param[in] ptr The memory to release
+     * @param[in] n The number of objects given to allocate()
+     */
+    void deallocate(T * ptr, size_t n)
+    {
+        if (n == 1)
+        {
+            pool_of<T>().deallocate(ptr);
+        }
+        else
+        {
+            ::operator delete(ptr);
+        }
+    }
+};
+
+/**
+ * @brief All PoolAllocators are equivalent, as pools are shared by type
+ * @return true
+ */
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) { return true; }
+
+/**
+ * @brief All PoolAllocators are equivalent, as pools are shared by type
+ * @return false
+ */
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) { return false; }
@@ -58,16 +58,16 @@ void Profiles::load_from_json(const Document &doc, const string & filename)
 ProfilePtr Profiles::operator[](const std::string &profile_name)
 {
     auto mit = _profiles.find(profile_name);
-    xbt_assert(mit != _profiles.end(), "Cannot get profile '%s': it does not exist", profile_name.c_str());
-    xbt_assert(mit->second.get() != nullptr, "Cannot get profile '%s': it existed some time ago but is no longer accessible", profile_name.c_str());
+    xbt_assert(mit != _profiles.end() || _removed_profiles.contains(profile_name), "Cannot get profile '%s': it does not exist", profile_name.c_str());
+    xbt_assert(mit != _profiles.end() && mit->second.get() != nullptr, "Cannot get profile '%s': it existed some time ago but is no longer accessible", profile_name.c_str());
     return mit->second;
 }
 
 const ProfilePtr Profiles::operator[](const std::string &profile_name) const
 {
     auto mit = _profiles.find(profile_name);
-    xbt_assert(mit != _profiles.end(), "Cannot get profile '%s': it does not exist", profile_name.c_str());
-    xbt_assert(mit->second.get() != nullptr, "Cannot get profile '%s': it existed some time ago but is no longer accessible", profile_name.c_str());
+    xbt_assert(mit != _profiles.end() || _removed_profiles.contains(profile_name), "Cannot get profile '%s': it does not exist", profile_name.c_str());
+    xbt_assert(mit != _profiles.end() && mit->second.get() != nullptr, "Cannot get profile '%s': it existed some time ago but is no longer accessible", profile_name.c_str());
     return mit->second;
 }
 
@@ -84,7 +84,7 @@ const ProfilePtr Profiles::at(const std::string & profile_name) const
 bool Profiles::exists(const std::string &profile_name) const
 {
     auto mit = _profiles.find(profile_name);
-    return mit != _profiles.end();
+    return mit != _profiles.end() || _removed_profiles.contains(profile_name);
 }
 
 void Profiles::add_profile(const std::string & profile_name,
@@ -100,10 +100,16 @@ void Profiles::add_profile(const std::string & profile_name,
 void Profiles::remove_profile(const std::string & profile_name)
 {
     auto mit = _profiles.find(profile_name);
-    xbt_assert(mit != _profiles.end(), "Bad Profiles::remove_profile call: Profile with name='%s' never existed in this workload.", profile_name.c_str());
+    xbt_assert(mit != _profiles.end() || _removed_profiles.contains(profile_name), "Bad Profiles::remove_profile call: Profile with name='%s' never existed in this workload.", profile_name.c_str());
 
     // If the profile has aleady been removed, do nothing.
-    if (mit->second.get() == nullptr)
+    if (mit == _profiles.end() || mit->second.get() == nullptr)
+    {
+        return;
+    }
+
+    // Templates can still be instantiated by future jobs, even if some jobs use them directly by name
+    if (mit->second->is_template)
     {
         return;
     }
@@ -119,20 +125,42 @@ void Profiles::remove_profile(const std::string & profile_name)
     }
 
     // Discard link to the profile (implicit memory clean-up)
-    mit->second = nullptr;
+    forget_profile(mit);
 }
 
 void Profiles::remove_unreferenced_profiles()
 {
-    for (auto & mit : _profiles)
+    for (auto mit = _profiles.begin(); mit != _profiles.end(); )
     {
-        if (mit.second.use_count() < 2)
+        // Templates can still be instantiated by future jobs
+        if (mit->second != nullptr && mit->second.use_count() < 2 && !mit->second->is_template)
+        {
+            mit = forget_profile(mit);
+        }
+        else
         {
-            mit.second = nullptr;
+            ++mit;
         }
     }
 }
 
+void Profiles::set_compact_tombstones(bool compact_tombstones)
+{
+    _compact_tombstones = compact_tombstones;
+}
+
+std::unordered_map<std::string, ProfilePtr>::iterator Profiles::forget_profile(std::unordered_map<std::string, ProfilePtr>::iterator mit)
+{
+    if (!_compact_tombstones)
+    {
+        mit->second = nullptr;
+        return ++mit;
+    }
+
+    _removed_profiles.insert(mit->first);
+    return _profiles.erase(mit);
+}
+
 const std::unordered_map<std::string, ProfilePtr> Profiles::profiles() const
 {
     return _profiles;
@@ -140,7 +168,7 @@ const std::unordered_map<std::string, ProfilePtr> Profiles::profiles() const
 
 int Profiles::nb_profiles() const
 {
-    return static_cast<int>(_profiles.size());
+    return static_cast<int>(_profiles.size() + _removed_profiles.size());
 }
 
 
@@ -271,7 +299,8 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
                             const rapidjson::Value & json_desc,
                             const std::string & error_prefix,
                             bool is_from_a_file,
-                            const std::string & json_filename)
+                            const std::string & json_filename,
+                            bool store_description)
 {
     (void) error_prefix; // Avoids a warning if assertions are ignored
 
@@ -294,6 +323,13 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
     }
     profile->return_code = return_code;
 
+    if (json_desc.HasMember("template"))
+    {
+        xbt_assert(json_desc["template"].IsBool(), "%s: profile '%s' has a non-boolean 'template' field",
+                   error_prefix.c_str(), profile_name.c_str());
+        profile->is_template = json_desc["template"].GetBool();
+    }
+
     if (profile_type == "delay")
     {
         /*
@@ -600,9 +636,19 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
         data->regex = string(".*");
         if (json_desc.HasMember("regex"))
         {
+            xbt_assert(json_desc["regex"].IsString(),
+                       "%s: profile '%s' has a non-string 'regex' field",
+                       error_prefix.c_str(), profile_name.c_str());
             data->regex = json_desc["regex"].GetString();
         }
 
+        try { data->compiled_regex = std::regex(data->regex); }
+        catch (const std::regex_error & e)
+        {
+            xbt_die("%s: profile '%s' has an invalid 'regex' field ('%s'): %s",
+                    error_prefix.c_str(), profile_name.c_str(), data->regex.c_str(), e.what());
+        }
+
         data->on_success = string("");
         if (json_desc.HasMember("success"))
         {
@@ -699,11 +745,27 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
     }
 
 
-    // Let's get the JSON string which describes the profile (to conserve potential fields unused by Batsim)
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    json_desc.Accept(writer);
-    profile->json_description = string(buffer.GetString(), buffer.GetSize());
+    if (profile->is_template)
+    {
+        xbt_assert(profile->type != ProfileType::SEQUENCE &&
+                   profile->type != ProfileType::SMPI &&
+                   profile->type != ProfileType::USAGE_TRACE,
+                   "%s: profile '%s' cannot be a template: its type (%s) depends on other profiles or files",
+                   error_prefix.c_str(), profile_name.c_str(), profile_type.c_str());
+
+        // The parsed description is shared by all the instances of the template
+        profile->parsed_description = std::make_unique<Document>();
+        profile->parsed_description->CopyFrom(json_desc, profile->parsed_description->GetAllocator());
+    }
+
+    if (store_description)
+    {
+        // Let's get the JSON string which describes the profile (to conserve potential fields unused by Batsim)
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        json_desc.Accept(writer);
+        profile->json_description = string(buffer.GetString(), buffer.GetSize());
+    }
 
     return profile;
 }
@@ -721,6 +783,99 @@ ProfilePtr Profile::from_json(const std::string & profile_name,
     return Profile::from_json(profile_name, doc, error_prefix, false);
 }
 
+/**
+ * @brief Builds the description of a template instance
+ * @param[in] template_profile The template
+ * @param[in] parameters The parameters bound to the template (JSON object). Its 'template' member is ignored.
+ * @param[out] description The description of the instance
+ */
+static void build_instance_description(const Profile & template_profile,
+                                       const rapidjson::Value & parameters,
+                                       Document & description)
+{
+    auto & alloc = description.GetAllocator();
+    description.CopyFrom(*template_profile.parsed_description, alloc);
+    description.RemoveMember("template");
+
+    // Override the fields of the template by the bound parameters
+    for (auto it = parameters.MemberBegin(); it != parameters.MemberEnd(); ++it)
+    {
+        if (it->name == "template")
+        {
+            continue;
+        }
+
+        Value value(it->value, alloc);
+        auto member = description.FindMember(it->name);
+        if (member != description.MemberEnd())
+        {
+            member->value = value;
+        }
+        else
+        {
+            description.AddMember(Value(it->name, alloc), value, alloc);
+        }
+    }
+}
+
+ProfilePtr Profile::from_template(const ProfilePtr & template_profile,
+                                  const std::string & instance_name,
+                                  const rapidjson::Value & parameters,
+                                  const std::string & error_prefix)
+{
+    (void) error_prefix; // Avoids a warning if assertions are ignored
+    xbt_assert(template_profile->is_template,
+               "%s: profile '%s' is not a template (templates are declared with \"template\": true)",
+               error_prefix.c_str(), template_profile->name.c_str());
+    xbt_assert(parameters.IsObject(), "%s: the parameters of template '%s' must be an object",
+               error_prefix.c_str(), template_profile->name.c_str());
+    xbt_assert(!parameters.HasMember("type"), "%s: the 'type' of template '%s' cannot be overridden",
+               error_prefix.c_str(), template_profile->name.c_str());
+
+    Document description;
+    build_instance_description(*template_profile, parameters, description);
+
+    auto profile = Profile::from_json(instance_name, description, error_prefix, false, "unset", false);
+    profile->template_profile = template_profile;
+
+    // Only the parameters are stored, the full description can be rebuilt from the template
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    parameters.Accept(writer);
+    profile->template_parameters = string(buffer.GetString(), buffer.GetSize());
+
+    return profile;
+}
+
+std::string Profile::full_json_description() const
+{
+    if (template_profile == nullptr)
+    {
+        return json_description;
+    }
+
+    Document parameters;
+    parameters.Parse(template_parameters.c_str());
+    xbt_assert(!parameters.HasParseError(), "The parameters of profile '%s' cannot be parsed", name.c_str());
+
+    Document description;
+    build_instance_description(*template_profile, parameters, description);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    description.Accept(writer);
+    return string(buffer.GetString(), buffer.GetSize());
+}
+
+const std::string & Profile::registered_name() const
+{
+    if (template_profile != nullptr)
+    {
+        return template_profile->name;
+    }
+    return name;
+}
+
 bool Profile::is_parallel_task() const
 {
     return (type == ProfileType::PARALLEL) ||
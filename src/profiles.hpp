@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -12,6 +13,7 @@
 
 #include <rapidjson/document.h>
 
+#include "name_set.hpp"
 #include "pointers.hpp"
 
 /**
@@ -47,9 +49,13 @@ struct Profile
 
     ProfileType type; //!< The type of the profile
     void * data; //!< The associated data
-    std::string json_description; //!< The JSON description of the profile
+    std::string json_description; //!< The JSON description of the profile (empty for template instances, see full_json_description)
     std::string name; //!< the profile unique name
     int return_code = 0;  //!< The return code of this profile's execution (SUCCESS == 0)
+    ProfilePtr template_profile = nullptr; //!< The profile template this profile has been instantiated from (nullptr if the profile is not an instance)
+    std::string template_parameters; //!< The JSON parameters bound to the template (only set for template instances)
+    bool is_template = false; //!< Whether this profile is declared as a template ("template": true). Templates are never garbage collected
+    std::unique_ptr<rapidjson::Document> parsed_description = nullptr; //!< The parsed JSON description of templates, from which their instances are built
 
     /**
      * @brief Creates a new-allocated Profile from a JSON description
@@ -58,6 +64,7 @@ struct Profile
      * @param[in] json_filename The JSON file name
      * @param[in] is_from_a_file Whether the JSON job comes from a file
      * @param[in] error_prefix The prefix to display when an error occurs
+     * @param[in] store_description Whether the JSON description should be stored in the profile (template instances only store their parameters)
      * @return The new-allocated Profile
      * @pre The JSON description is valid
      */
@@ -65,7 +72,8 @@ struct Profile
                                const rapidjson::Value & json_desc,
                                const std::string & error_prefix = "Invalid JSON profile",
                                bool is_from_a_file = true,
-                               const std::string & json_filename = "unset");
+                               const std::string & json_filename = "unset",
+                               bool store_description = true);
 
     /**
      * @brief Creates a new-allocated Profile from a JSON description
@@ -79,6 +87,35 @@ struct Profile
                                const std::string & json_str,
                                const std::string & error_prefix = "Invalid JSON profile");
 
+    /**
+     * @brief Creates a new-allocated Profile by binding parameters to a profile template
+     * @details The instance data is built from the parsed description of the template, in which the given parameters are overridden.
+     *          The instance only stores its parameters: its full description is rebuilt on demand by full_json_description.
+     *          The instance is not registered in the Profiles of the workload: it only lives as long as the jobs that use it.
+     * @param[in] template_profile The template (a profile declared with "template": true)
+     * @param[in] instance_name The name of the instance
+     * @param[in] parameters The parameters to bind (JSON object). Its 'template' member is ignored.
+     * @param[in] error_prefix The prefix to display when an error occurs
+     * @return The new-allocated Profile
+     */
+    static ProfilePtr from_template(const ProfilePtr & template_profile,
+                                    const std::string & instance_name,
+                                    const rapidjson::Value & parameters,
+                                    const std::string & error_prefix = "Invalid profile template instantiation");
+
+    /**
+     * @brief Returns the JSON description of the profile
+     * @details For template instances, the description is built from the template description and the instance parameters.
+     * @return The JSON description of the profile
+     */
+    std::string full_json_description() const;
+
+    /**
+     * @brief Returns the name under which the profile is registered in its workload
+     * @return The name of the template for template instances, the profile name otherwise
+     */
+    const std::string & registered_name() const;
+
     /**
      * @brief Returns whether a profile is a parallel task (or its derivatives)
      * @return Whether a profile is a parallel task (or its derivatives)
@@ -190,10 +227,11 @@ struct SchedulerSendProfileData
 struct SchedulerRecvProfileData
 {
     std::string regex; //!< The regex which is tested for matching
+    std::regex compiled_regex; //!< The compiled version of regex, built once at profile loading time
     std::string on_success; //!< The profile to execute if it matches
     std::string on_failure; //!< The profile to execute if it does not match
     std::string on_timeout; //!< The profile to execute if no message is in the buffer (i.e. the scheduler has not answered in time). Can be omitted which will result that the job will wait until its walltime is reached.
-    double polltime; //!< The time to sleep between polling if on_timeout is not set.
+    double polltime; //!< Deprecated: kept for compatibility with older workloads. Reception is now event-driven and does not poll.
 };
 
 
@@ -284,6 +322,14 @@ public:
      */
     void remove_unreferenced_profiles();
 
+    /**
+     * @brief Sets whether removed profiles should be erased instead of being kept as nullptr entries
+     * @details When enabled, the names of removed profiles are stored in a NameSet, so that they still cannot be reused.
+     *          Removed profiles are then no longer listed by profiles().
+     * @param[in] compact_tombstones Whether removed profiles should be erased
+     */
+    void set_compact_tombstones(bool compact_tombstones);
+
     /**
      * @brief Returns a copy of the internal std::map used in the Profiles
      * @return A copy of the internal std::map used in the Profiles
@@ -296,8 +342,18 @@ public:
      */
     int nb_profiles() const;
 
+private:
+    /**
+     * @brief Removes a profile entry, either by setting it to nullptr or by erasing it (when tombstones are compacted)
+     * @param[in] mit The entry of the profile
+     * @return The entry that follows the removed one
+     */
+    std::unordered_map<std::string, ProfilePtr>::iterator forget_profile(std::unordered_map<std::string, ProfilePtr>::iterator mit);
+
 private:
     std::unordered_map<std::string, ProfilePtr> _profiles; //!< Stores all the profiles, indexed by their names. Value can be nullptr, meaning that the profile is no longer in memory but existed in the past.
+    NameSet _removed_profiles; //!< The names of the profiles that have been erased from _profiles (only used when tombstones are compacted)
+    bool _compact_tombstones = false; //!< Whether removed profiles are erased from _profiles instead of being set to nullptr
 };
 
 /**
@@ -1,5 +1,6 @@
 #include "protocol.hpp"
 
+#include <algorithm>
 #include <regex>
 
 #include <boost/algorithm/string/join.hpp>
@@ -17,6 +18,92 @@ using namespace std;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(protocol, "protocol"); //!< Logging
 
+MachinePropertiesFormat machine_properties_format_from_string(const string & str)
+{
+    if (str == "full")
+    {
+        return MachinePropertiesFormat::FULL;
+    }
+    else if (str == "table")
+    {
+        return MachinePropertiesFormat::TABLE;
+    }
+    else if (str == "grouped")
+    {
+        return MachinePropertiesFormat::GROUPED;
+    }
+    else
+    {
+        throw std::runtime_error("Invalid machine properties format string");
+    }
+}
+
+string machine_properties_format_to_string(MachinePropertiesFormat format)
+{
+    switch (format)
+    {
+    case MachinePropertiesFormat::FULL:
+        return "full";
+    case MachinePropertiesFormat::TABLE:
+        return "table";
+    case MachinePropertiesFormat::GROUPED:
+        return "grouped";
+    }
+
+    xbt_die("Unknown machine properties format");
+}
+
+EventSubscription EventSubscription::from_json(const Value & json_desc,
+                                               const string & error_prefix)
+{
+    // What can be disabled, for each key of the description
+    static const map<string, map<string, bool EventSubscription::*>> disablable = {
+        {"disabled_events", {
+            {"RESOURCE_STATE_CHANGED", &EventSubscription::resource_state_changed_events},
+            {"NOTIFY", &EventSubscription::notify_events},
+            {"FROM_JOB_MSG", &EventSubscription::from_job_msg_events}}},
+        {"disabled_fields", {
+            {"properties", &EventSubscription::machine_properties},
+            {"profiles", &EventSubscription::profiles},
+            {"job", &EventSubscription::job_descriptions},
+            {"job_progress", &EventSubscription::job_progress}}}
+    };
+
+    xbt_assert(json_desc.IsObject(), "%s: not an object", error_prefix.c_str());
+
+    EventSubscription subscription;
+    for (auto it = json_desc.MemberBegin(); it != json_desc.MemberEnd(); ++it)
+    {
+        const string key = it->name.GetString();
+        auto key_it = disablable.find(key);
+        xbt_assert(key_it != disablable.end(),
+                   "%s: unknown key '%s' (expected 'disabled_events' or 'disabled_fields')", error_prefix.c_str(), key.c_str());
+        xbt_assert(it->value.IsArray(), "%s: '%s' should be an array", error_prefix.c_str(), key.c_str());
+
+        for (SizeType i = 0; i < it->value.Size(); ++i)
+        {
+            xbt_assert(it->value[i].IsString(), "%s: '%s' should only contain strings", error_prefix.c_str(), key.c_str());
+            const string name = it->value[i].GetString();
+
+            auto name_it = key_it->second.find(name);
+            if (name_it == key_it->second.end())
+            {
+                vector<string> names;
+                for (const auto & entry : key_it->second)
+                {
+                    names.push_back(entry.first);
+                }
+                xbt_die("%s: '%s' cannot be in '%s' (allowed values: %s)", error_prefix.c_str(), name.c_str(),
+                        key.c_str(), boost::algorithm::join(names, ", ").c_str());
+            }
+
+            subscription.*(name_it->second) = false;
+        }
+    }
+
+    return subscription;
+}
+
 JsonProtocolWriter::JsonProtocolWriter(BatsimContext * context) :
     _context(context), _alloc(_doc.GetAllocator())
 {
@@ -123,20 +210,37 @@ void JsonProtocolWriter::append_simulation_begins(Machines & machines,
     data.AddMember("allow_storage_sharing", Value().SetBool(allow_storage_sharing), _alloc);
     data.AddMember("config", config, _alloc);
 
-    Value compute_resources(rapidjson::kArrayType);
-    compute_resources.Reserve(machines.nb_compute_machines(), _alloc);
-    for (const Machine * machine : machines.compute_machines())
+    if (_context->machine_properties_format == MachinePropertiesFormat::FULL ||
+        !_context->event_subscription.machine_properties)
     {
-        compute_resources.PushBack(machine_to_json_value(*machine), _alloc);
+        Value compute_resources(rapidjson::kArrayType);
+        compute_resources.Reserve(machines.nb_compute_machines(), _alloc);
+        for (const Machine * machine : machines.compute_machines())
+        {
+            compute_resources.PushBack(machine_to_json_value(*machine), _alloc);
+        }
+        data.AddMember("compute_resources", Value().CopyFrom(compute_resources, _alloc), _alloc);
+        Value storage_resources(rapidjson::kArrayType);
+        storage_resources.Reserve(machines.nb_storage_machines(), _alloc);
+        for (const Machine * machine : machines.storage_machines())
+        {
+            storage_resources.PushBack(machine_to_json_value(*machine), _alloc);
+        }
+        data.AddMember("storage_resources", Value().CopyFrom(storage_resources, _alloc), _alloc);
     }
-    data.AddMember("compute_resources", Value().CopyFrom(compute_resources, _alloc), _alloc);
-    Value storage_resources(rapidjson::kArrayType);
-    storage_resources.Reserve(machines.nb_storage_machines(), _alloc);
-    for (const Machine * machine : machines.storage_machines())
+    else
     {
-        storage_resources.PushBack(machine_to_json_value(*machine), _alloc);
+        // Property sets are shared by compute and storage machines
+        bool grouped = _context->machine_properties_format == MachinePropertiesFormat::GROUPED;
+        map<MachinePropertySet, int> property_set_indexes;
+        Value property_sets(rapidjson::kArrayType);
+
+        data.AddMember("compute_resources", machines_to_compact_json_value(machines.compute_machines(), grouped,
+                                                                           property_set_indexes, property_sets), _alloc);
+        data.AddMember("storage_resources", machines_to_compact_json_value(machines.storage_machines(), grouped,
+                                                                           property_set_indexes, property_sets), _alloc);
+        data.AddMember("property_sets", property_sets, _alloc);
     }
-    data.AddMember("storage_resources", Value().CopyFrom(storage_resources, _alloc), _alloc);
 
 
     Value workloads_dict(rapidjson::kObjectType);
@@ -148,6 +252,11 @@ void JsonProtocolWriter::append_simulation_begins(Machines & machines,
             Value().SetString(workload.second->file.c_str(), _alloc),
             _alloc);
 
+        if (!_context->event_subscription.profiles)
+        {
+            continue;
+        }
+
         Value profile_dict(rapidjson::kObjectType);
         for (const auto & profile : workload.second->profiles->profiles())
         {
@@ -166,7 +275,10 @@ void JsonProtocolWriter::append_simulation_begins(Machines & machines,
                 profile_dict, _alloc);
     }
     data.AddMember("workloads", workloads_dict, _alloc);
-    data.AddMember("profiles", profiles_dict, _alloc);
+    if (_context->event_subscription.profiles)
+    {
+        data.AddMember("profiles", profiles_dict, _alloc);
+    }
 
     Value event(rapidjson::kObjectType);
     event.AddMember("timestamp", Value().SetDouble(date), _alloc);
@@ -183,6 +295,11 @@ Value JsonProtocolWriter::machine_to_json_value(const Machine & machine)
     machine_doc.AddMember("name", Value().SetString(machine.name.c_str(), _alloc), _alloc);
     machine_doc.AddMember("state", Value().SetString(machine_state_to_string(machine.state).c_str(), _alloc), _alloc);
 
+    if (!_context->event_subscription.machine_properties)
+    {
+        return machine_doc;
+    }
+
     Value properties(rapidjson::kObjectType);
     for(auto const &entry : machine.properties)
     {
@@ -204,6 +321,91 @@ Value JsonProtocolWriter::machine_to_json_value(const Machine & machine)
     return machine_doc;
 }
 
+Value JsonProtocolWriter::machines_to_compact_json_value(const vector<Machine *> & machines,
+                                                         bool grouped,
+                                                         map<MachinePropertySet, int> & property_set_indexes,
+                                                         Value & property_sets)
+{
+    Value resources(grouped ? rapidjson::kObjectType : rapidjson::kArrayType);
+    Value group(rapidjson::kObjectType);
+    int group_first_id = -1;
+    int group_last_id = -1;
+
+    for (const Machine * machine : machines)
+    {
+        // Let's retrieve the index of the machine property set, adding the set if it has not been met yet
+        MachinePropertySet property_set(map<string, string>(machine->properties.begin(), machine->properties.end()),
+                                        map<string, string>(machine->zone_properties.begin(), machine->zone_properties.end()));
+        auto index_it = property_set_indexes.find(property_set);
+        if (index_it == property_set_indexes.end())
+        {
+            Value properties(rapidjson::kObjectType);
+            for (const auto & entry : property_set.first)
+            {
+                properties.AddMember(Value(entry.first.c_str(), _alloc), Value(entry.second.c_str(), _alloc), _alloc);
+            }
+            Value zone_properties(rapidjson::kObjectType);
+            for (const auto & entry : property_set.second)
+            {
+                zone_properties.AddMember(Value(entry.first.c_str(), _alloc), Value(entry.second.c_str(), _alloc), _alloc);
+            }
+
+            Value property_set_value(rapidjson::kObjectType);
+            property_set_value.AddMember("properties", properties, _alloc);
+            property_set_value.AddMember("zone_properties", zone_properties, _alloc);
+            property_sets.PushBack(property_set_value, _alloc);
+
+            index_it = property_set_indexes.insert({property_set, static_cast<int>(property_set_indexes.size())}).first;
+        }
+        const int property_set_index = index_it->second;
+        const string state = machine_state_to_string(machine->state);
+
+        if (!grouped)
+        {
+            Value machine_doc(rapidjson::kObjectType);
+            machine_doc.AddMember("id", Value().SetInt(machine->id), _alloc);
+            machine_doc.AddMember("name", Value().SetString(machine->name.c_str(), _alloc), _alloc);
+            machine_doc.AddMember("state", Value().SetString(state.c_str(), _alloc), _alloc);
+            machine_doc.AddMember("property_set", Value().SetInt(property_set_index), _alloc);
+            resources.PushBack(machine_doc, _alloc);
+            continue;
+        }
+
+        // The machine extends the current group if it follows it and shares its state and property set
+        if (group_first_id != -1 &&
+            machine->id == group_last_id + 1 &&
+            state == group["state"].GetString() &&
+            property_set_index == group["property_set"].GetInt())
+        {
+            group["names"].PushBack(Value().SetString(machine->name.c_str(), _alloc), _alloc);
+            group_last_id = machine->id;
+            continue;
+        }
+
+        if (group_first_id != -1)
+        {
+            IntervalSet group_ids(IntervalSet::ClosedInterval(group_first_id, group_last_id));
+            resources.AddMember(Value().SetString(group_ids.to_string_hyphen(" ", "-").c_str(), _alloc), group, _alloc);
+        }
+
+        group.SetObject();
+        group.AddMember("names", Value(rapidjson::kArrayType), _alloc);
+        group["names"].PushBack(Value().SetString(machine->name.c_str(), _alloc), _alloc);
+        group.AddMember("state", Value().SetString(state.c_str(), _alloc), _alloc);
+        group.AddMember("property_set", Value().SetInt(property_set_index), _alloc);
+        group_first_id = machine->id;
+        group_last_id = machine->id;
+    }
+
+    if (group_first_id != -1)
+    {
+        IntervalSet group_ids(IntervalSet::ClosedInterval(group_first_id, group_last_id));
+        resources.AddMember(Value().SetString(group_ids.to_string_hyphen(" ", "-").c_str(), _alloc), group, _alloc);
+    }
+
+    return resources;
+}
+
 void JsonProtocolWriter::append_simulation_ends(double date)
 {
     /* {
@@ -227,6 +429,7 @@ void JsonProtocolWriter::append_simulation_ends(double date)
 void JsonProtocolWriter::append_job_submitted(const string & job_id,
                                               const string & job_json_description,
                                               const string & profile_json_description,
+                                              const string & workflow_json_description,
                                               double date)
 {
     /* "with_redis": {
@@ -251,6 +454,15 @@ void JsonProtocolWriter::append_job_submitted(const string & job_id,
           "type": "delay",
           "delay": 10
         }
+    },
+    "workflow_task": {
+      "timestamp": 10.0,
+      "type": "JOB_SUBMITTED",
+      "data": {
+        "job_id": "w0!3",
+        "job": {"id": "w0!3", "subtime": 10.0, "walltime": 22.5, "res": 4, "profile": "w0_ID00002"},
+        "workflow": {"name": "w0", "task": "ID00002", "depth": 1, "top_level": 10.0, "bottom_level": 30.0, "critical_path_length": 40.0}
+      }
     } */
 
     xbt_assert(date >= _last_date, "Date inconsistency");
@@ -262,13 +474,16 @@ void JsonProtocolWriter::append_job_submitted(const string & job_id,
 
     if (!_context->redis_enabled)
     {
-        Document job_description_doc;
-        job_description_doc.Parse(job_json_description.c_str());
-        xbt_assert(!job_description_doc.HasParseError(), "JSON parse error");
+        if (_context->event_subscription.job_descriptions)
+        {
+            Document job_description_doc;
+            job_description_doc.Parse(job_json_description.c_str());
+            xbt_assert(!job_description_doc.HasParseError(), "JSON parse error");
 
-        data.AddMember("job", Value().CopyFrom(job_description_doc, _alloc), _alloc);
+            data.AddMember("job", Value().CopyFrom(job_description_doc, _alloc), _alloc);
+        }
 
-        if (_context->submission_forward_profiles)
+        if (_context->submission_forward_profiles && _context->event_subscription.profiles)
         {
             Document profile_description_doc;
             profile_description_doc.Parse(profile_json_description.c_str());
@@ -278,6 +493,16 @@ void JsonProtocolWriter::append_job_submitted(const string & job_id,
         }
     }
 
+    // Workflow metadata is small and does not depend on the job descriptions subscription
+    if (!workflow_json_description.empty())
+    {
+        Document workflow_description_doc;
+        workflow_description_doc.Parse(workflow_json_description.c_str());
+        xbt_assert(!workflow_description_doc.HasParseError(), "JSON parse error");
+
+        data.AddMember("workflow", Value().CopyFrom(workflow_description_doc, _alloc), _alloc);
+    }
+
     Value event(rapidjson::kObjectType);
     event.AddMember("timestamp", Value().SetDouble(date), _alloc);
     event.AddMember("type", Value().SetString("JOB_SUBMITTED"), _alloc);
@@ -428,7 +653,7 @@ void JsonProtocolWriter::append_job_killed(const vector<string> & job_ids,
     {
         jobs.PushBack(Value().SetString(job_id.c_str(), _alloc), _alloc);
         // compute task progress tree
-        if (job_progress.at(job_id) != nullptr) {
+        if (_context->event_subscription.job_progress && job_progress.at(job_id) != nullptr) {
             progress.AddMember(Value().SetString(job_id.c_str(), _alloc),
                 generate_task_tree(job_progress.at(job_id), _alloc), _alloc);
         }
@@ -457,6 +682,11 @@ void JsonProtocolWriter::append_from_job_message(const string & job_id,
 
     xbt_assert(date >= _last_date, "Date inconsistency");
     _last_date = date;
+
+    if (!_context->event_subscription.from_job_msg_events)
+    {
+        return;
+    }
     _is_empty = false;
 
     Value data(rapidjson::kObjectType);
@@ -484,6 +714,11 @@ void JsonProtocolWriter::append_resource_state_changed(const IntervalSet & resou
 
     xbt_assert(date >= _last_date, "Date inconsistency");
     _last_date = date;
+
+    if (!_context->event_subscription.resource_state_changed_events)
+    {
+        return;
+    }
     _is_empty = false;
 
     Value data(rapidjson::kObjectType);
@@ -582,6 +817,11 @@ void JsonProtocolWriter::append_notify(const std::string & notify_type,
 
     xbt_assert(date >= _last_date, "Date inconsistency");
     _last_date = date;
+
+    if (!_context->event_subscription.notify_events)
+    {
+        return;
+    }
     _is_empty = false;
 
     Value data(rapidjson::kObjectType);
@@ -595,6 +835,107 @@ void JsonProtocolWriter::append_notify(const std::string & notify_type,
     _events.PushBack(event, _alloc);
 }
 
+void JsonProtocolWriter::append_notify_simulation_branched(int branch,
+                                                           double date)
+{
+    /* {
+        "timestamp": 3600.0,
+        "type": "NOTIFY",
+        "data": {
+          "type": "simulation_branched",
+          "branch": 1,
+          "pending_jobs": {"w0!12": {"id": "w0!12", "subtime": 3500.0, "res": 4, "profile": "delay10"}},
+          "running_jobs": {"w0!10": {"alloc": "0-3", "starting_time": 3550.0}},
+          "machine_states": {"computing": "0-3", "idle": "4-7"},
+          "machine_pstates": {"0": "0-7"}
+        }
+    } */
+
+    xbt_assert(date >= _last_date, "Date inconsistency");
+    _last_date = date;
+
+    // The branch decision process cannot schedule anything without it, it is thus sent regardless of the subscription
+    _is_empty = false;
+
+    // Jobs are sorted by identifier so that every branch receives the very same snapshot
+    vector<JobPtr> pending_jobs;
+    vector<JobPtr> running_jobs;
+    for (const auto & workload_it : _context->workloads.workloads())
+    {
+        for (const auto & job_it : workload_it.second->jobs->jobs())
+        {
+            if (job_it.second->state == JobState::JOB_STATE_SUBMITTED)
+            {
+                pending_jobs.push_back(job_it.second);
+            }
+            else if (job_it.second->state == JobState::JOB_STATE_RUNNING)
+            {
+                running_jobs.push_back(job_it.second);
+            }
+        }
+    }
+    auto job_id_order = [](const JobPtr & a, const JobPtr & b) { return a->id.to_string() < b->id.to_string(); };
+    std::sort(pending_jobs.begin(), pending_jobs.end(), job_id_order);
+    std::sort(running_jobs.begin(), running_jobs.end(), job_id_order);
+
+    // Pending jobs are described as in JOB_SUBMITTED, as the branch decision process may not know them
+    Value pending(rapidjson::kObjectType);
+    for (const JobPtr & job : pending_jobs)
+    {
+        Document job_description;
+        job_description.Parse(job->json_description.c_str());
+        xbt_assert(!job_description.HasParseError(), "Invalid JSON description of job '%s'", job->id.to_cstring());
+        pending.AddMember(Value().SetString(job->id.to_string().c_str(), _alloc),
+                          Value().CopyFrom(job_description, _alloc), _alloc);
+    }
+
+    Value running(rapidjson::kObjectType);
+    for (const JobPtr & job : running_jobs)
+    {
+        Value running_job(rapidjson::kObjectType);
+        running_job.AddMember("alloc", Value().SetString(job->allocation.to_string_hyphen(" ", "-").c_str(), _alloc), _alloc);
+        running_job.AddMember("starting_time", Value().SetDouble(static_cast<double>(job->starting_time)), _alloc);
+        running.AddMember(Value().SetString(job->id.to_string().c_str(), _alloc), running_job, _alloc);
+    }
+
+    map<string, IntervalSet> machines_by_state;
+    map<int, IntervalSet> machines_by_pstate;
+    for (const Machine * machine : _context->machines.machines())
+    {
+        machines_by_state[machine_state_to_string(machine->state)].insert(machine->id);
+        machines_by_pstate[machine->host->get_pstate()].insert(machine->id);
+    }
+
+    Value machine_states(rapidjson::kObjectType);
+    for (const auto & it : machines_by_state)
+    {
+        machine_states.AddMember(Value().SetString(it.first.c_str(), _alloc),
+                                 Value().SetString(it.second.to_string_hyphen(" ", "-").c_str(), _alloc), _alloc);
+    }
+
+    Value machine_pstates(rapidjson::kObjectType);
+    for (const auto & it : machines_by_pstate)
+    {
+        machine_pstates.AddMember(Value().SetString(to_string(it.first).c_str(), _alloc),
+                                  Value().SetString(it.second.to_string_hyphen(" ", "-").c_str(), _alloc), _alloc);
+    }
+
+    Value data(rapidjson::kObjectType);
+    data.AddMember("type", Value().SetString("simulation_branched"), _alloc);
+    data.AddMember("branch", Value().SetInt(branch), _alloc);
+    data.AddMember("pending_jobs", pending, _alloc);
+    data.AddMember("running_jobs", running, _alloc);
+    data.AddMember("machine_states", machine_states, _alloc);
+    data.AddMember("machine_pstates", machine_pstates, _alloc);
+
+    Value event(rapidjson::kObjectType);
+    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
+    event.AddMember("type", Value().SetString("NOTIFY"), _alloc);
+    event.AddMember("data", data, _alloc);
+
+    _events.PushBack(event, _alloc);
+}
+
 void JsonProtocolWriter::append_notify_resource_event(const std::string & notify_type,
                                           const IntervalSet & resources,
                                           double date)
@@ -612,6 +953,11 @@ void JsonProtocolWriter::append_notify_resource_event(const std::string & notify
 
     xbt_assert(date >= _last_date, "Date inconsistency");
     _last_date = date;
+
+    if (!_context->event_subscription.notify_events)
+    {
+        return;
+    }
     _is_empty = false;
 
     Value data(rapidjson::kObjectType);
@@ -637,6 +983,11 @@ void JsonProtocolWriter::append_notify_generic_event(const std::string & json_de
 
     xbt_assert(date >= _last_date, "Date inconsistency");
     _last_date = date;
+
+    if (!_context->event_subscription.notify_events)
+    {
+        return;
+    }
     _is_empty = false;
 
     Value event(rapidjson::kObjectType);
@@ -696,10 +1047,13 @@ JsonProtocolReader::JsonProtocolReader(BatsimContext *context) :
     _type_to_handler_map["KILL_JOB"] = &JsonProtocolReader::handle_kill_job;
     _type_to_handler_map["REGISTER_JOB"] = &JsonProtocolReader::handle_register_job;
     _type_to_handler_map["REGISTER_PROFILE"] = &JsonProtocolReader::handle_register_profile;
+    _type_to_handler_map["REGISTER_JOBS"] = &JsonProtocolReader::handle_register_jobs;
+    _type_to_handler_map["REGISTER_PROFILES"] = &JsonProtocolReader::handle_register_profiles;
     _type_to_handler_map["SET_RESOURCE_STATE"] = &JsonProtocolReader::handle_set_resource_state;
     _type_to_handler_map["SET_JOB_METADATA"] = &JsonProtocolReader::handle_set_job_metadata;
     _type_to_handler_map["NOTIFY"] = &JsonProtocolReader::handle_notify;
     _type_to_handler_map["TO_JOB_MSG"] = &JsonProtocolReader::handle_to_job_msg;
+    _type_to_handler_map["SET_SUBSCRIPTION"] = &JsonProtocolReader::handle_set_subscription;
 }
 
 JsonProtocolReader::~JsonProtocolReader()
@@ -708,6 +1062,8 @@ JsonProtocolReader::~JsonProtocolReader()
 
 void JsonProtocolReader::parse_and_apply_message(const string &message)
 {
+    _shared_state_lock = lock_shared_state(context);
+
     rapidjson::Document doc;
     doc.Parse(message.c_str());
 
@@ -729,6 +1085,9 @@ void JsonProtocolReader::parse_and_apply_message(const string &message)
     }
 
     send_message_at_time(now, "server", IPMessageType::SCHED_READY);
+    flush_pending_messages();
+
+    _shared_state_lock = std::unique_lock<simgrid::s4u::Mutex>();
 }
 
 void JsonProtocolReader::parse_and_apply_event(const Value & event_object,
@@ -932,12 +1291,7 @@ void JsonProtocolReader::handle_execute_job(int event_number,
     // *********************
     // Let's read it from the JSON message
     xbt_assert(data_object.HasMember("alloc"), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should contain a 'alloc' key.", event_number);
-    const Value & alloc_value = data_object["alloc"];
-    xbt_assert(alloc_value.IsString(), "Invalid JSON message: the 'alloc' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
-    string alloc = alloc_value.GetString();
-
-    try { message->allocation->machine_ids = IntervalSet::from_string_hyphen(alloc, " ", "-"); }
-    catch(const std::exception & e) { throw std::runtime_error(std::string("Invalid JSON message: ") + e.what());}
+    message->allocation->machine_ids = parse_allocation(event_number, data_object["alloc"], "");
 
     int nb_allocated_resources = static_cast<int>(message->allocation->machine_ids.size());
     (void) nb_allocated_resources; // Avoids a warning if assertions are ignored
@@ -949,68 +1303,86 @@ void JsonProtocolReader::handle_execute_job(int event_number,
     if (data_object.HasMember("mapping"))
     {
         const Value & mapping_value = data_object["mapping"];
-        xbt_assert(mapping_value.IsObject(), "Invalid JSON message: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
-        xbt_assert(mapping_value.MemberCount() > 0, "Invalid JSON: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) must be a non-empty object", event_number);
-        map<int,int> mapping_map;
+        if (mapping_value.IsArray())
+        {
+            // Dense mapping: the i-th value is the resource of the i-th executor
+            xbt_assert(mapping_value.Size() > 0, "Invalid JSON: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) must be a non-empty array", event_number);
+            message->allocation->mapping.resize(mapping_value.Size());
 
-        // Let's fill the map from the JSON description
-        for (auto it = mapping_value.MemberBegin(); it != mapping_value.MemberEnd(); ++it)
+            for (SizeType executor = 0; executor < mapping_value.Size(); ++executor)
+            {
+                const Value & resource_value = mapping_value[executor];
+                xbt_assert(resource_value.IsInt(), "Invalid JSON message: Invalid 'mapping' array of event %d (EXECUTE_JOB): the resource of executor %u is not an integer", event_number, executor);
+                int resource = resource_value.GetInt();
+                xbt_assert(resource >= 0 && resource < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' array of event %d (EXECUTE_JOB): executor %u should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, executor, resource, nb_allocated_resources);
+                message->allocation->mapping[executor] = resource;
+            }
+        }
+        else
         {
-            const Value & key_value = it->name;
-            const Value & value_value = it->value;
+            xbt_assert(mapping_value.IsObject(), "Invalid JSON message: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) should be an object or an array.", event_number);
+            xbt_assert(mapping_value.MemberCount() > 0, "Invalid JSON: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) must be a non-empty object", event_number);
+            map<int,int> mapping_map;
 
-            xbt_assert(key_value.IsInt() || key_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a key is not an integer nor a string", event_number);
-            xbt_assert(value_value.IsInt() || value_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a value is not an integer nor a string", event_number);
+            // Let's fill the map from the JSON description
+            for (auto it = mapping_value.MemberBegin(); it != mapping_value.MemberEnd(); ++it)
+            {
+                const Value & key_value = it->name;
+                const Value & value_value = it->value;
 
-            int executor;
-            int resource;
+                xbt_assert(key_value.IsInt() || key_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a key is not an integer nor a string", event_number);
+                xbt_assert(value_value.IsInt() || value_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a value is not an integer nor a string", event_number);
 
-            try
-            {
-                if (key_value.IsInt())
-                {
-                    executor = key_value.GetInt();
-                }
-                else
-                {
-                    executor = std::stoi(key_value.GetString());
-                }
+                int executor;
+                int resource;
 
-                if (value_value.IsInt())
+                try
                 {
-                    resource = value_value.GetInt();
+                    if (key_value.IsInt())
+                    {
+                        executor = key_value.GetInt();
+                    }
+                    else
+                    {
+                        executor = std::stoi(key_value.GetString());
+                    }
+
+                    if (value_value.IsInt())
+                    {
+                        resource = value_value.GetInt();
+                    }
+                    else
+                    {
+                        resource = std::stoi(value_value.GetString());
+                    }
                 }
-                else
+                catch (const std::exception &)
                 {
-                    resource = std::stoi(value_value.GetString());
+                    xbt_assert(false, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): all keys and values must be integers (or strings representing integers)", event_number);
+                    throw;
                 }
-            }
-            catch (const std::exception &)
-            {
-                xbt_assert(false, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): all keys and values must be integers (or strings representing integers)", event_number);
-                throw;
-            }
-
-            mapping_map[executor] = resource;
-        }
 
-        // Let's write the mapping as a vector (keys will be implicit between 0 and nb_executor-1)
-        message->allocation->mapping.reserve(mapping_map.size());
-        auto mit = mapping_map.begin();
-        int nb_inserted = 0;
+                mapping_map[executor] = resource;
+            }
 
-        xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): no resource associated to executor %d.", event_number, nb_inserted);
-        xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, mit->first, mit->second, nb_allocated_resources);
-        message->allocation->mapping.push_back(mit->second);
+            // Let's write the mapping as a vector (keys will be implicit between 0 and nb_executor-1)
+            message->allocation->mapping.reserve(mapping_map.size());
+            auto mit = mapping_map.begin();
+            int nb_inserted = 0;
 
-        for (++mit, ++nb_inserted; mit != mapping_map.end(); ++mit, ++nb_inserted)
-        {
             xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): no resource associated to executor %d.", event_number, nb_inserted);
             xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, mit->first, mit->second, nb_allocated_resources);
             message->allocation->mapping.push_back(mit->second);
-        }
 
-        xbt_assert(message->allocation->mapping.size() == mapping_map.size(), "internal inconsistency on mapping size");
+            for (++mit, ++nb_inserted; mit != mapping_map.end(); ++mit, ++nb_inserted)
+            {
+                xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): no resource associated to executor %d.", event_number, nb_inserted);
+                xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, mit->first, mit->second, nb_allocated_resources);
+                message->allocation->mapping.push_back(mit->second);
+            }
+
+            xbt_assert(message->allocation->mapping.size() == mapping_map.size(), "internal inconsistency on mapping size");
+        }
     }
 
     // *************************************
@@ -1113,12 +1485,7 @@ void JsonProtocolReader::handle_execute_job(int event_number,
 
         // get IO allocation
         xbt_assert(io_job_value.HasMember("alloc"), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should contain a 'alloc' key.", event_number);
-        const Value & alloc_value = io_job_value["alloc"];
-        xbt_assert(alloc_value.IsString(), "Invalid JSON message: the 'alloc' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
-        string alloc = alloc_value.GetString();
-
-        try { message->allocation->io_allocation = IntervalSet::from_string_hyphen(alloc, " ", "-"); }
-        catch(const std::exception & e) { throw std::runtime_error(std::string("Invalid JSON message: bad IO allocation: ") + e.what());}
+        message->allocation->io_allocation = parse_allocation(event_number, io_job_value["alloc"], "bad IO allocation: ");
     }
     else
     {
@@ -1129,6 +1496,43 @@ void JsonProtocolReader::handle_execute_job(int event_number,
     send_message_at_time(timestamp, "server", IPMessageType::SCHED_EXECUTE_JOB, static_cast<void*>(message));
 }
 
+IntervalSet JsonProtocolReader::parse_allocation(int event_number,
+                                                 const Value & alloc_value,
+                                                 const char * error_prefix) const
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+
+    if (alloc_value.IsString())
+    {
+        try { return IntervalSet::from_string_hyphen(alloc_value.GetString(), " ", "-"); }
+        catch(const std::exception & e) { throw std::runtime_error(std::string("Invalid JSON message: ") + error_prefix + e.what());}
+    }
+
+    xbt_assert(alloc_value.IsArray(), "Invalid JSON message: %sthe 'alloc' value in the 'data' value of event %d (EXECUTE_JOB) should be a string or an array.", error_prefix, event_number);
+    IntervalSet allocation;
+
+    for (SizeType i = 0; i < alloc_value.Size(); ++i)
+    {
+        const Value & element_value = alloc_value[i];
+        if (element_value.IsInt())
+        {
+            xbt_assert(element_value.GetInt() >= 0, "Invalid JSON message: %sin event %d (EXECUTE_JOB): element %u of the 'alloc' array should be a non-negative machine id.", error_prefix, event_number, i);
+            allocation.insert(element_value.GetInt());
+        }
+        else
+        {
+            xbt_assert(element_value.IsArray() && element_value.Size() == 2 && element_value[0].IsInt() && element_value[1].IsInt(),
+                       "Invalid JSON message: %sin event %d (EXECUTE_JOB): element %u of the 'alloc' array should be a machine id or a [lower, upper] array of machine ids.", error_prefix, event_number, i);
+            int lower = element_value[0].GetInt();
+            int upper = element_value[1].GetInt();
+            xbt_assert(lower >= 0 && lower <= upper, "Invalid JSON message: %sin event %d (EXECUTE_JOB): element %u of the 'alloc' array is an invalid interval [%d,%d].", error_prefix, event_number, i, lower, upper);
+            allocation.insert(IntervalSet::ClosedInterval(lower, upper));
+        }
+    }
+
+    return allocation;
+}
+
 void JsonProtocolReader::handle_call_me_later(int event_number,
                                               double timestamp,
                                               const Value &data_object)
@@ -1360,11 +1764,30 @@ void JsonProtocolReader::handle_to_job_msg(int event_number,
     send_message_at_time(timestamp, "server", IPMessageType::TO_JOB_MSG, static_cast<void*>(message));
 }
 
+void JsonProtocolReader::handle_set_subscription(int event_number,
+                                                 double timestamp,
+                                                 const Value &data_object)
+{
+    /* {
+      "timestamp": 0.0,
+      "type": "SET_SUBSCRIPTION",
+      "data": {
+        "disabled_events": ["RESOURCE_STATE_CHANGED"],
+        "disabled_fields": ["job", "job_progress"]
+      }
+    } */
+
+    auto * message = new SetSubscriptionMessage;
+    message->subscription = new EventSubscription(EventSubscription::from_json(data_object,
+        "Invalid JSON message: invalid 'data' value of event " + to_string(event_number) + " (SET_SUBSCRIPTION)"));
+
+    send_message_at_time(timestamp, "server", IPMessageType::SCHED_SET_SUBSCRIPTION, static_cast<void*>(message));
+}
+
 void JsonProtocolReader::handle_register_job(int event_number,
                                            double timestamp,
                                            const Value &data_object)
 {
-    (void) event_number; // Avoids a warning if assertions are ignored
     /* "with_redis": {
       "timestamp": 10.0,
       "type": "REGISTER_JOB",
@@ -1386,42 +1809,126 @@ void JsonProtocolReader::handle_register_job(int event_number,
       }
     } */
 
+    check_dynamic_registration_allowed("job");
+
     auto * message = new JobRegisteredByDPMessage;
+    message->job = register_job(event_number, "REGISTER_JOB", data_object);
+
+    send_message_at_time(timestamp, "server", IPMessageType::JOB_REGISTERED_BY_DP, static_cast<void*>(message));
+}
 
-    xbt_assert(context->registration_sched_enabled, "Invalid JSON message: dynamic job registration received but the option seems disabled... "
-                                                  "It can be activated with the '--enable-dynamic-jobs' command line option.");
+void JsonProtocolReader::handle_register_profile(int event_number,
+                                           double timestamp,
+                                           const Value &data_object)
+{
+    /* "with_redis": {
+      "timestamp": 10.0,
+      "type": "REGISTER_PROFILE",
+      "data": {
+        "workload_name": "w12",
+        "profile_name": "delay.0.1",
+        "profile": {
+          "type": "delay",
+          "delay": 10
+        }
+      }
+    } */
 
-    xbt_assert(!context->registration_sched_finished, "Invalid JSON message: dynamic job registration received but the option has been disabled (a registration_finished message have already been received)");
+    check_dynamic_registration_allowed("profile");
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REGISTER_JOB) should be an object", event_number);
+    auto * message = new ProfileRegisteredByDPMessage;
+    register_profile(event_number, "REGISTER_PROFILE", data_object, *message);
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (REGISTER_JOB) should have a 'job_id' key", event_number);
-    const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (REGISTER_JOB): ['data']['job_id'] should be a string", event_number);
-    string job_id_str = job_id_value.GetString();
-    JobIdentifier job_id(job_id_str);
+    send_message_at_time(timestamp, "server", IPMessageType::PROFILE_REGISTERED_BY_DP, static_cast<void*>(message));
+}
 
-    // Read the job description, either directly or from Redis
-    if (data_object.HasMember("job"))
-    {
-        xbt_assert(!context->redis_enabled, "Invalid JSON message: in event %d (REGISTER_JOB): 'job' object is given but redis seems enabled...", event_number);
+void JsonProtocolReader::handle_register_jobs(int event_number,
+                                            double timestamp,
+                                            const Value &data_object)
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+    /* {
+      "timestamp": 10.0,
+      "type": "REGISTER_JOBS",
+      "data": {
+        "jobs": [
+          {"job_id": "dyn!1", "job": {"profile": "delay_10s", "res": 1, "id": "1", "walltime": 12.0}},
+          {"job_id": "dyn!2", "job": {"profile": "delay_10s", "res": 2, "id": "2"}}
+        ]
+      }
+    } */
 
-        const Value & job_object = data_object["job"];
-        xbt_assert(job_object.IsObject(), "Invalid JSON message: in event %d (REGISTER_JOB): ['data']['job'] should be an object", event_number);
+    check_dynamic_registration_allowed("job");
 
-        StringBuffer buffer;
-        ::Writer<rapidjson::StringBuffer> writer(buffer);
-        job_object.Accept(writer);
+    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REGISTER_JOBS) should be an object", event_number);
+    xbt_assert(data_object.HasMember("jobs"), "Invalid JSON message: the 'data' value of event %d (REGISTER_JOBS) should have a 'jobs' key", event_number);
+    const Value & jobs = data_object["jobs"];
+    xbt_assert(jobs.IsArray(), "Invalid JSON message: in event %d (REGISTER_JOBS): ['data']['jobs'] should be an array", event_number);
 
-        message->job_description = string(buffer.GetString(), buffer.GetSize());
-    }
-    else
+    auto * message = new JobsRegisteredByDPMessage;
+    message->jobs.reserve(jobs.Size());
+    for (SizeType i = 0; i < jobs.Size(); ++i)
     {
-        xbt_assert(context->redis_enabled, "Invalid JSON message: in event %d (REGISTER_JOB): ['data']['job'] is unset but redis seems disabled...", event_number);
+        message->jobs.push_back(register_job(event_number, "REGISTER_JOBS", jobs[i]));
+    }
 
-        string job_key = RedisStorage::job_key(job_id);
-        message->job_description = context->storage.get(job_key);
+    send_message_at_time(timestamp, "server", IPMessageType::JOBS_REGISTERED_BY_DP, static_cast<void*>(message));
+}
+
+void JsonProtocolReader::handle_register_profiles(int event_number,
+                                                double timestamp,
+                                                const Value &data_object)
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+    /* {
+      "timestamp": 10.0,
+      "type": "REGISTER_PROFILES",
+      "data": {
+        "profiles": [
+          {"workload_name": "w12", "profile_name": "delay.0.1", "profile": {"type": "delay", "delay": 10}},
+          {"workload_name": "w12", "profile_name": "delay.0.2", "profile": {"type": "delay", "delay": 20}}
+        ]
+      }
+    } */
+
+    check_dynamic_registration_allowed("profile");
+
+    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILES) should be an object", event_number);
+    xbt_assert(data_object.HasMember("profiles"), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILES) should have a 'profiles' key", event_number);
+    const Value & profiles = data_object["profiles"];
+    xbt_assert(profiles.IsArray(), "Invalid JSON message: in event %d (REGISTER_PROFILES): ['data']['profiles'] should be an array", event_number);
+
+    // Profiles are inserted into their workloads right away: the server has nothing to do about them
+    (void) timestamp;
+    for (SizeType i = 0; i < profiles.Size(); ++i)
+    {
+        ProfileRegisteredByDPMessage registration;
+        register_profile(event_number, "REGISTER_PROFILES", profiles[i], registration);
     }
+}
+
+void JsonProtocolReader::check_dynamic_registration_allowed(const char * what) const
+{
+    (void) what; // Avoids a warning if assertions are ignored
+    xbt_assert(context->registration_sched_enabled, "Invalid JSON message: dynamic %s registration received but the option seems disabled... "
+                                                  "It can be activated with the '--enable-dynamic-jobs' command line option.", what);
+
+    xbt_assert(!context->registration_sched_finished, "Invalid JSON message: dynamic %s registration received but the option has been disabled (a registration_finished message have already been received)", what);
+}
+
+JobPtr JsonProtocolReader::register_job(int event_number,
+                                        const char * event_type,
+                                        const Value & job_registration)
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+    (void) event_type;
+
+    xbt_assert(job_registration.IsObject(), "Invalid JSON message: a job registration of event %d (%s) should be an object", event_number, event_type);
+
+    xbt_assert(job_registration.HasMember("job_id"), "Invalid JSON message: a job registration of event %d (%s) should have a 'job_id' key", event_number, event_type);
+    const Value & job_id_value = job_registration["job_id"];
+    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (%s): 'job_id' should be a string", event_number, event_type);
+    JobIdentifier job_id(string(job_id_value.GetString(), job_id_value.GetStringLength()));
 
     // Load job into memory. TODO: this should be between the protocol parsing and the injection in the events, not here.
     xbt_assert(context->workloads.exists(job_id.workload_name()),
@@ -1432,118 +1939,91 @@ void JsonProtocolReader::handle_register_job(int event_number,
 
     Workload * workload = context->workloads.at(job_id.workload_name());
 
-    // Create the job.
+    // Create the job, either directly from its JSON description or from Redis.
+    // The check of existence of its profile is done in Job::from_json.
     XBT_DEBUG("Parsing user-submitted job %s", job_id.to_cstring());
-    message->job = Job::from_json(message->job_description, workload, "Invalid JSON job submitted by the scheduler");
-    xbt_assert(message->job->id.job_name() == job_id.job_name(), "Internal error");
-    xbt_assert(message->job->id.workload_name() == job_id.workload_name(), "Internal error");
+    JobPtr job;
+    if (job_registration.HasMember("job"))
+    {
+        xbt_assert(!context->redis_enabled, "Invalid JSON message: in event %d (%s): 'job' object is given but redis seems enabled...", event_number, event_type);
 
-    /* The check of existence of a profile is done in Job::from_json which should raise an Exception
-     * TODO catch this exception here and print the following message
-     * if (!workload->profiles->exists(job->profile))
+        const Value & job_object = job_registration["job"];
+        xbt_assert(job_object.IsObject(), "Invalid JSON message: in event %d (%s): 'job' should be an object", event_number, event_type);
+
+        job = Job::from_json(job_object, workload, "Invalid JSON job submitted by the scheduler");
+    }
+    else
     {
-        xbt_die(
-                   "Dynamically registered job '%s' has no profile: "
-                   "Workload '%s' has no profile named '%s'. "
-                   "When registering a dynamic job, its profile should already exist. "
-                   "If the profile is also dynamic, it can be registered with the REGISTER_PROFILE "
-                   "message but you must ensure that the profile is sent (non-strictly) before "
-                   "the REGISTER_JOB message.",
-                   job->id.to_cstring(),
-                   workload->name.c_str(), job->profile.c_str());
-    }*/
+        xbt_assert(context->redis_enabled, "Invalid JSON message: in event %d (%s): 'job' is unset but redis seems disabled...", event_number, event_type);
+
+        string job_key = RedisStorage::job_key(job_id);
+        job = Job::from_json(context->storage.get(job_key), workload, "Invalid JSON job submitted by the scheduler");
+    }
+    xbt_assert(job->id.job_name() == job_id.job_name(), "Internal error");
+    xbt_assert(job->id.workload_name() == job_id.workload_name(), "Internal error");
 
-    workload->check_single_job_validity(message->job);
-    workload->jobs->add_job(message->job);
-    message->job->state = JobState::JOB_STATE_SUBMITTED;
+    workload->check_single_job_validity(job);
+    workload->jobs->add_job(job);
+    job->state = JobState::JOB_STATE_SUBMITTED;
 
-    send_message_at_time(timestamp, "server", IPMessageType::JOB_REGISTERED_BY_DP, static_cast<void*>(message));
+    return job;
 }
 
-void JsonProtocolReader::handle_register_profile(int event_number,
-                                           double timestamp,
-                                           const Value &data_object)
+void JsonProtocolReader::register_profile(int event_number,
+                                          const char * event_type,
+                                          const Value & profile_registration,
+                                          ProfileRegisteredByDPMessage & message)
 {
     (void) event_number; // Avoids a warning if assertions are ignored
-    /* "with_redis": {
-      "timestamp": 10.0,
-      "type": "REGISTER_PROFILE",
-      "data": {
-        "workload_name": "w12",
-        "profile_name": "delay.0.1",
-        "profile": {
-          "type": "delay",
-          "delay": 10
-        }
-      }
-    } */
-
-    // Read message
-    auto * message = new ProfileRegisteredByDPMessage;
+    (void) event_type;
 
-    xbt_assert(context->registration_sched_enabled, "Invalid JSON message: dynamic profile registration received but the option seems disabled... "
-                                                  "It can be activated with the '--enable-dynamic-jobs' command line option.");
+    xbt_assert(profile_registration.IsObject(), "Invalid JSON message: a profile registration of event %d (%s) should be an object", event_number, event_type);
 
-    xbt_assert(!context->registration_sched_finished, "Invalid JSON message: dynamic profile registration received but the option has been disabled (a registration_finished message have already been received)");
+    xbt_assert(profile_registration.HasMember("workload_name"), "Invalid JSON message: a profile registration of event %d (%s) should have a 'workload_name' key", event_number, event_type);
+    const Value & workload_name_value = profile_registration["workload_name"];
+    xbt_assert(workload_name_value.IsString(), "Invalid JSON message: in event %d (%s): 'workload_name' should be a string", event_number, event_type);
+    message.workload_name = string(workload_name_value.GetString(), workload_name_value.GetStringLength());
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILE) should be an object", event_number);
+    xbt_assert(profile_registration.HasMember("profile_name"), "Invalid JSON message: a profile registration of event %d (%s) should have a 'profile_name' key", event_number, event_type);
+    const Value & profile_name_value = profile_registration["profile_name"];
+    xbt_assert(profile_name_value.IsString(), "Invalid JSON message: in event %d (%s): 'profile_name' should be a string", event_number, event_type);
+    message.profile_name = string(profile_name_value.GetString(), profile_name_value.GetStringLength());
 
-    xbt_assert(data_object.HasMember("workload_name"), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILE) should have a 'workload_name' key", event_number);
-    const Value & workload_name_value = data_object["workload_name"];
-    xbt_assert(workload_name_value.IsString(), "Invalid JSON message: in event %d (REGISTER_PROFILE): ['data']['workload_name'] should be a string", event_number);
-    string workload_name = workload_name_value.GetString();
-
-    xbt_assert(data_object.HasMember("profile_name"), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILE) should have a 'profile_name' key", event_number);
-    const Value & profile_name_value = data_object["profile_name"];
-    xbt_assert(profile_name_value.IsString(), "Invalid JSON message: in event %d (REGISTER_PROFILE): ['data']['profile_name'] should be a string", event_number);
-    string profile_name = profile_name_value.GetString();
-
-    xbt_assert(data_object.HasMember("profile"), "Invalid JSON message: the 'data' value of event %d (REGISTER_PROFILE) should have a 'profile' key", event_number);
-
-    const Value & profile_object = data_object["profile"];
-    xbt_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (REGISTER_PROFILE): ['data']['profile'] should be an object", event_number);
-
-    message->workload_name = workload_name;
-    message->profile_name = profile_name;
-
-    StringBuffer buffer;
-    ::Writer<rapidjson::StringBuffer> writer(buffer);
-    profile_object.Accept(writer);
-
-    message->profile = string(buffer.GetString(), buffer.GetSize());
+    xbt_assert(profile_registration.HasMember("profile"), "Invalid JSON message: a profile registration of event %d (%s) should have a 'profile' key", event_number, event_type);
+    const Value & profile_object = profile_registration["profile"];
+    xbt_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (%s): 'profile' should be an object", event_number, event_type);
 
     // Load profile into memory. TODO: this should be between the protocol parsing and the injection in the events, not here.
 
     // Retrieve the workload, or create if it does not exist yet
     Workload * workload = nullptr;
-    if (context->workloads.exists(message->workload_name))
+    if (context->workloads.exists(message.workload_name))
     {
-        workload = context->workloads.at(message->workload_name);
+        workload = context->workloads.at(message.workload_name);
     }
     else
     {
-        workload = Workload::new_dynamic_workload(message->workload_name);
+        workload = Workload::new_dynamic_workload(message.workload_name);
         context->workloads.insert_workload(workload->name, workload);
     }
 
-    if (!workload->profiles->exists(message->profile_name))
+    if (!workload->profiles->exists(message.profile_name))
     {
         XBT_INFO("Adding dynamically registered profile %s to workload %s",
-                message->profile_name.c_str(),
-                message->workload_name.c_str());
-        auto profile = Profile::from_json(message->profile_name,
-                                          message->profile,
-                                          "Invalid JSON profile received from the scheduler");
-        workload->profiles->add_profile(message->profile_name, profile);
+                message.profile_name.c_str(),
+                message.workload_name.c_str());
+        auto profile = Profile::from_json(message.profile_name,
+                                          profile_object,
+                                          "Invalid JSON profile received from the scheduler",
+                                          false);
+        workload->profiles->add_profile(message.profile_name, profile);
     }
     else
     {
         xbt_die("Invalid new profile registration: profile '%s' already existed in workload '%s'",
-            message->profile_name.c_str(),
-            message->workload_name.c_str());
+            message.profile_name.c_str(),
+            message.workload_name.c_str());
     }
-
-    send_message_at_time(timestamp, "server", IPMessageType::PROFILE_REGISTERED_BY_DP, static_cast<void*>(message));
 }
 
 void JsonProtocolReader::handle_kill_job(int event_number,
@@ -1580,15 +2060,63 @@ void JsonProtocolReader::handle_kill_job(int event_number,
 void JsonProtocolReader::send_message_at_time(double when,
                                       const string &destination_mailbox,
                                       IPMessageType type,
-                                      void *data) const
+                                      void *data)
 {
-    // Let's wait until "when" time is reached
-    double current_time = simgrid::s4u::Engine::get_clock();
-    if (when > current_time)
+    // Messages that cannot be sent along with the pending ones are sent after them
+    if (!_pending_messages.empty() &&
+        (when > _pending_messages_date || destination_mailbox != _pending_messages_mailbox))
+    {
+        flush_pending_messages();
+    }
+
+    if (_pending_messages.empty())
+    {
+        // Let's wait until "when" time is reached
+        double current_time = simgrid::s4u::Engine::get_clock();
+        if (when > current_time)
+        {
+            // Other actors may need the shared state until then
+            release_shared_state(_shared_state_lock);
+            simgrid::s4u::this_actor::sleep_for(when - current_time);
+            reacquire_shared_state(_shared_state_lock);
+        }
+
+        _pending_messages_date = when;
+        _pending_messages_mailbox = destination_mailbox;
+    }
+
+    IPMessage * message = new IPMessage;
+    message->type = type;
+    message->data = data;
+    _pending_messages.push_back(message);
+}
+
+void JsonProtocolReader::flush_pending_messages()
+{
+    if (_pending_messages.empty())
+    {
+        return;
+    }
+
+    // The server locks the shared state to handle the messages, which is only done once they are received
+    release_shared_state(_shared_state_lock);
+
+    if (_pending_messages.size() == 1)
+    {
+        IPMessage * message = _pending_messages[0];
+        send_message(_pending_messages_mailbox, message->type, message->data);
+
+        // The data is now owned by the sent message
+        message->data = nullptr;
+        delete message;
+    }
+    else
     {
-        simgrid::s4u::this_actor::sleep_for(when - current_time);
+        auto * message = new SchedulerDecisionsMessage;
+        message->decisions.swap(_pending_messages);
+        send_message(_pending_messages_mailbox, IPMessageType::SCHED_DECISIONS, static_cast<void*>(message));
     }
 
-    // Let's actually send the message
-    send_message(destination_mailbox, type, data);
+    _pending_messages.clear();
+    reacquire_shared_state(_shared_state_lock);
 }
@@ -4,10 +4,13 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 
+#include <simgrid/s4u.hpp>
+
 #include <intervalset.hpp>
 
 #include "machines.hpp"
@@ -16,6 +19,57 @@
 
 struct BatsimContext;
 
+/**
+ * @brief Enumerates how the properties of the machines are sent in SIMULATION_BEGINS
+ */
+enum class MachinePropertiesFormat
+{
+    FULL        //!< Each machine has its own properties and zone_properties objects
+    ,TABLE      //!< Distinct property sets are sent once, machines reference them by index
+    ,GROUPED    //!< Same as TABLE, but machines of consecutive ids with the same state and property set are grouped
+};
+
+/**
+ * @brief Returns the MachinePropertiesFormat corresponding to a string
+ * @param[in] str The string ("full", "table" or "grouped")
+ * @return The matching MachinePropertiesFormat. An exception is thrown if str is invalid.
+ */
+MachinePropertiesFormat machine_properties_format_from_string(const std::string & str);
+
+/**
+ * @brief Returns a string corresponding to a given MachinePropertiesFormat
+ * @param[in] format The MachinePropertiesFormat
+ * @return A string corresponding to the given MachinePropertiesFormat
+ */
+std::string machine_properties_format_to_string(MachinePropertiesFormat format);
+
+/**
+ * @brief The events and the heavy event fields that are sent to the decision process
+ * @details Everything is sent by default. The decision process can unsubscribe from what it does not use
+ *          via the 'batsim-subscription' key of its configuration (--sched-cfg) or via SET_SUBSCRIPTION events.
+ */
+struct EventSubscription
+{
+    bool resource_state_changed_events = true; //!< Whether RESOURCE_STATE_CHANGED events are sent
+    bool notify_events = true;                 //!< Whether NOTIFY events are sent
+    bool from_job_msg_events = true;           //!< Whether FROM_JOB_MSG events are sent
+    bool machine_properties = true;            //!< Whether the properties of the machines are sent in SIMULATION_BEGINS
+    bool profiles = true;                      //!< Whether profiles are sent in SIMULATION_BEGINS and JOB_SUBMITTED (if forwarded)
+    bool job_descriptions = true;              //!< Whether job descriptions are sent in JOB_SUBMITTED (when Redis is disabled)
+    bool job_progress = true;                  //!< Whether the execution progress of killed jobs is sent in JOB_KILLED
+
+    /**
+     * @brief Creates an EventSubscription from a JSON description
+     * @details The description is an object with optional 'disabled_events' and 'disabled_fields' arrays of strings,
+     *          e.g., {"disabled_events": ["RESOURCE_STATE_CHANGED"], "disabled_fields": ["properties", "job_progress"]}
+     * @param[in] json_desc The JSON description
+     * @param[in] error_prefix The prefix to display when an error occurs
+     * @return The EventSubscription
+     */
+    static EventSubscription from_json(const rapidjson::Value & json_desc,
+                                       const std::string & error_prefix = "Invalid JSON subscription");
+};
+
 /**
  * @brief Custom rapidjson Writer to force fixed float writing precision
  */
@@ -100,11 +154,13 @@ public:
      * @param[in] job_json_description The job JSON description (optional if redis is enabled)
      * @param[in] profile_json_description The profile JSON description (optional if redis is
      *            disabled or if profiles are not forwarded)
+     * @param[in] workflow_json_description The position of the task in its workflow DAG, if the job executes a workflow task
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
     virtual void append_job_submitted(const std::string & job_id,
                                       const std::string & job_json_description,
                                       const std::string & profile_json_description,
+                                      const std::string & workflow_json_description,
                                       double date) = 0;
 
     /**
@@ -195,6 +251,15 @@ public:
     virtual void append_notify_generic_event(const std::string & json_desc,
                                              double date) = 0;
 
+    /**
+     * @brief Appends the NOTIFY event that starts the decision process of a simulation branch.
+     * @details The event describes the state of the simulation at the branch time (pending and running jobs, machine states).
+     * @param[in] branch The number of the branch (from 1)
+     * @param[in] date The event date. Must be greater than or equal to the previous event date.
+     */
+    virtual void append_notify_simulation_branched(int branch,
+                                                   double date) = 0;
+
     /**
      * @brief Appends a REQUESTED_CALL message.
      * @param[in] date The event date. Must be greater than or equal to the previous event.
@@ -274,11 +339,13 @@ public:
      * @param[in] job_json_description The job JSON description (optional if redis is enabled)
      * @param[in] profile_json_description The profile JSON description (optional if redis is
      *            disabled or if profiles are not forwarded)
+     * @param[in] workflow_json_description The position of the task in its workflow DAG, if the job executes a workflow task
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
     void append_job_submitted(const std::string & job_id,
                               const std::string & job_json_description,
                               const std::string & profile_json_description,
+                              const std::string & workflow_json_description,
                               double date);
 
     /**
@@ -369,6 +436,15 @@ public:
     void append_notify_generic_event(const std::string & json_desc,
                                      double date);
 
+    /**
+     * @brief Appends the NOTIFY event that starts the decision process of a simulation branch.
+     * @details The event describes the state of the simulation at the branch time (pending and running jobs, machine states).
+     * @param[in] branch The number of the branch (from 1)
+     * @param[in] date The event date. Must be greater than or equal to the previous event date.
+     */
+    void append_notify_simulation_branched(int branch,
+                                           double date);
+
     /**
      * @brief Appends a REQUESTED_CALL message.
      * @param[in] date The event date. Must be greater than or equal to the previous event.
@@ -403,6 +479,22 @@ private:
      */
     rapidjson::Value machine_to_json_value(const Machine & machine);
 
+    //! The properties and zone properties of a machine, sorted so that they can be compared
+    typedef std::pair<std::map<std::string, std::string>, std::map<std::string, std::string>> MachinePropertySet;
+
+    /**
+     * @brief Converts machines to a json value in which machines reference deduplicated property sets.
+     * @param[in] machines The machines to be converted, sorted by increasing id
+     * @param[in] grouped Whether machines of consecutive ids with the same state and property set should be grouped
+     * @param[in,out] property_set_indexes The index of the property sets already in property_sets
+     * @param[in,out] property_sets The json array of the distinct property sets
+     * @return The json value (an array, or an object whose keys are intervals of machine ids if grouped)
+     */
+    rapidjson::Value machines_to_compact_json_value(const std::vector<Machine *> & machines,
+                                                    bool grouped,
+                                                    std::map<MachinePropertySet, int> & property_set_indexes,
+                                                    rapidjson::Value & property_sets);
+
 private:
     BatsimContext * _context; //!< The BatsimContext
     bool _is_empty = true; //!< Stores whether events have been pushed into the writer since last clear.
@@ -550,6 +642,14 @@ public:
      */
     void handle_to_job_msg(int event_number, double timestamp, const rapidjson::Value & data_object);
 
+    /**
+     * @brief Handles a SET_SUBSCRIPTION event
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] timestamp The event timestamp
+     * @param[in] data_object The data associated with the event (JSON object)
+     */
+    void handle_set_subscription(int event_number, double timestamp, const rapidjson::Value & data_object);
+
     /**
      * @brief Handles a REGISTER_JOB event
      * @param[in] event_number The event number in [0,nb_events[.
@@ -566,6 +666,22 @@ public:
      */
     void handle_register_profile(int event_number, double timestamp, const rapidjson::Value & data_object);
 
+    /**
+     * @brief Handles a REGISTER_JOBS event
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] timestamp The event timestamp
+     * @param[in] data_object The data associated with the event (JSON object)
+     */
+    void handle_register_jobs(int event_number, double timestamp, const rapidjson::Value & data_object);
+
+    /**
+     * @brief Handles a REGISTER_PROFILES event
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] timestamp The event timestamp
+     * @param[in] data_object The data associated with the event (JSON object)
+     */
+    void handle_register_profiles(int event_number, double timestamp, const rapidjson::Value & data_object);
+
     /**
      * @brief Handles a KILL_JOB event
      * @param[in] event_number The event number in [0,nb_events[.
@@ -575,8 +691,47 @@ public:
     void handle_kill_job(int event_number, double timestamp, const rapidjson::Value & data_object);
 
 private:
+    /**
+     * @brief Checks that dynamic registrations are currently allowed
+     * @param[in] what What is being registered (for error messages)
+     */
+    void check_dynamic_registration_allowed(const char * what) const;
+
+    /**
+     * @brief Creates a job registered by the scheduler and inserts it into its workload
+     * @details The job is built directly from the parsed JSON value (or from Redis if enabled).
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] event_type The type of the event (for error messages)
+     * @param[in] job_registration The registration of the job (REGISTER_JOB data object)
+     * @return The registered job
+     */
+    JobPtr register_job(int event_number, const char * event_type, const rapidjson::Value & job_registration);
+
+    /**
+     * @brief Creates a profile registered by the scheduler and inserts it into its workload (created if needed)
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] event_type The type of the event (for error messages)
+     * @param[in] profile_registration The registration of the profile (REGISTER_PROFILE data object)
+     * @param[out] message The message to fill with the workload and profile names
+     */
+    void register_profile(int event_number, const char * event_type, const rapidjson::Value & profile_registration,
+                          ProfileRegisteredByDPMessage & message);
+
+    /**
+     * @brief Parses the allocation of an EXECUTE_JOB event
+     * @details The allocation is either a hyphenated string (e.g., "0-63 128-191")
+     *          or an array of machine ids and closed intervals (e.g., [[0,63],[128,191],256]).
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] alloc_value The allocation value
+     * @param[in] error_prefix The prefix of the error messages (after "Invalid JSON message: ")
+     * @return The machines of the allocation
+     */
+    IntervalSet parse_allocation(int event_number, const rapidjson::Value & alloc_value, const char * error_prefix) const;
+
     /**
      * @brief Sends a message at a given time, sleeping to reach the given time if needed
+     * @details Messages sent to the same mailbox at the same time are gathered and only sent
+     *          when flush_pending_messages is called or when a message at a later time is sent.
      * @param[in] when The date at which the message should be sent
      * @param[in] destination_mailbox The destination mailbox
      * @param[in] type The message type
@@ -585,11 +740,21 @@ private:
     void send_message_at_time(double when,
                       const std::string & destination_mailbox,
                       IPMessageType type,
-                      void * data = nullptr) const;
+                      void * data = nullptr);
+
+    /**
+     * @brief Sends the pending messages to their mailbox
+     * @details A single message is sent as is. Several messages are sent as one SCHED_DECISIONS message.
+     */
+    void flush_pending_messages();
 
 private:
     //! Maps message types to their handler functions
     std::map<std::string, std::function<void(JsonProtocolReader*, int, double, const rapidjson::Value&)>> _type_to_handler_map;
+    std::vector<IPMessage *> _pending_messages; //!< The messages that have not been sent yet, in sending order
+    std::string _pending_messages_mailbox; //!< The destination mailbox of the pending messages
+    double _pending_messages_date = -1; //!< The date at which the pending messages are sent
+    std::unique_lock<simgrid::s4u::Mutex> _shared_state_lock; //!< Locks the shared simulation state while a message is parsed (released while waiting)
     std::vector<std::string> accepted_requests = {"consumed_energy"}; //!< The currently acceptes requests for the QUERY_REQUEST message
     BatsimContext * context = nullptr; //!< The BatsimContext
 };
@@ -16,6 +16,8 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(pstate, "pstate"); //!< Logging
 
 void switch_on_machine_process(BatsimContext *context, int machine_id, int new_pstate)
 {
+    auto shared_state_lock = lock_shared_state(context);
+
     xbt_assert(context->machines.exists(machine_id), "machine %d does not exist", machine_id);
     Machine * machine = context->machines[machine_id];
 
@@ -23,7 +25,7 @@ void switch_on_machine_process(BatsimContext *context, int machine_id, int new_p
     xbt_assert(machine->state == MachineState::TRANSITING_FROM_SLEEPING_TO_COMPUTING, "machine %d is not TRANSITING_FROM_SLEEPING_TO_COMPUTING", machine_id);
     xbt_assert(machine->jobs_being_computed.empty(), "jobs are running on machine %d", machine_id);
     xbt_assert(machine->has_pstate(new_pstate), "machine %d has no pstate %d", machine_id, new_pstate);
-    xbt_assert(machine->pstates[new_pstate] == PStateType::COMPUTATION_PSTATE, "pstate %d of machine %d is not a computation pstate", new_pstate, machine_id);
+    xbt_assert(machine->pstate_type(new_pstate) == PStateType::COMPUTATION_PSTATE, "pstate %d of machine %d is not a computation pstate", new_pstate, machine_id);
 
     int current_pstate = machine->host->get_pstate();
     int on_ps = machine->sleep_pstates[current_pstate]->switch_on_virtual_pstate;
@@ -31,10 +33,13 @@ void switch_on_machine_process(BatsimContext *context, int machine_id, int new_p
     XBT_INFO("Switching machine %d ('%s') ON. Passing in virtual pstate %d to do so", machine->id,
              machine->name.c_str(), on_ps);
     machine->host->set_pstate(on_ps);
+    context->machines.notify_machine_power_change(machine);
     //args->context->pstate_tracer.add_pstate_change(simgrid::s4u::Engine::get_clock(), machine->id, on_ps);
 
     XBT_INFO("Computing 1 flop to simulate time & energy cost of switch ON");
+    release_shared_state(shared_state_lock);
     simgrid::s4u::this_actor::execute(1);
+    reacquire_shared_state(shared_state_lock);
 
     XBT_INFO("1 flop has been computed. Switching machine %d ('%s') to computing pstate %d",
              machine->id, machine->name.c_str(), new_pstate);
@@ -43,6 +48,8 @@ void switch_on_machine_process(BatsimContext *context, int machine_id, int new_p
 
     machine->update_machine_state(MachineState::IDLE);
 
+    release_shared_state(shared_state_lock);
+
     SwitchMessage * msg = new SwitchMessage;
     msg->machine_id = machine_id;
     msg->new_pstate = new_pstate;
@@ -51,6 +58,8 @@ void switch_on_machine_process(BatsimContext *context, int machine_id, int new_p
 
 void switch_off_machine_process(BatsimContext * context, int machine_id, int new_pstate)
 {
+    auto shared_state_lock = lock_shared_state(context);
+
     xbt_assert(context->machines.exists(machine_id), "machine %d does not exist", machine_id);
     Machine * machine = context->machines[machine_id];
 
@@ -58,17 +67,20 @@ void switch_off_machine_process(BatsimContext * context, int machine_id, int new
     xbt_assert(machine->state == MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING, "machine %d is not TRANSITING_FROM_COMPUTING_TO_SLEEPING", machine_id);
     xbt_assert(machine->jobs_being_computed.empty(), "jobs are running on machine %d", machine_id);
     xbt_assert(machine->has_pstate(new_pstate), "machine %d has no pstate %d", machine_id, new_pstate);
-    xbt_assert(machine->pstates[new_pstate] == PStateType::SLEEP_PSTATE, "pstate %d of machine %d is not a computation pstate", new_pstate, machine_id);
+    xbt_assert(machine->pstate_type(new_pstate) == PStateType::SLEEP_PSTATE, "pstate %d of machine %d is not a computation pstate", new_pstate, machine_id);
 
     int off_ps = machine->sleep_pstates[new_pstate]->switch_off_virtual_pstate;
 
     XBT_INFO("Switching machine %d ('%s') OFF. Passing in virtual pstate %d to do so", machine->id,
              machine->name.c_str(), off_ps);
     machine->host->set_pstate(off_ps);
+    context->machines.notify_machine_power_change(machine);
     //args->context->pstate_tracer.add_pstate_change(simgrid::s4u::Engine::get_clock(), machine->id, off_ps);
 
     XBT_INFO("Computing 1 flop to simulate time & energy cost of switch OFF");
+    release_shared_state(shared_state_lock);
     simgrid::s4u::this_actor::execute(1);
+    reacquire_shared_state(shared_state_lock);
 
     XBT_INFO("1 flop has been computed. Switching machine %d ('%s') to sleeping pstate %d",
              machine->id, machine->name.c_str(), new_pstate);
@@ -77,6 +89,8 @@ void switch_off_machine_process(BatsimContext * context, int machine_id, int new
 
     machine->update_machine_state(MachineState::SLEEPING);
 
+    release_shared_state(shared_state_lock);
+
     SwitchMessage * msg = new SwitchMessage;
     msg->machine_id = machine_id;
     msg->new_pstate = new_pstate;
@@ -22,6 +22,7 @@ enum class PStateType
     COMPUTATION_PSTATE          //!< Such power states can be used to compute jobs
     ,SLEEP_PSTATE               //!< Such power states cannot be used to compute jobs
     ,TRANSITION_VIRTUAL_PSTATE  //!< Such power states should only be used to transit either (from a computation power state to a sleep one) or (from a sleep power state to a computation one)
+    ,UNDEFINED_PSTATE           //!< The power state does not exist (or has not been typed yet)
 };
 
 /**
@@ -49,6 +49,7 @@ void server_process(BatsimContext * context)
     handler_map[IPMessageType::JOB_SUBMITTED] = server_on_job_submitted;
     handler_map[IPMessageType::JOB_REGISTERED_BY_DP] = server_on_register_job;
     handler_map[IPMessageType::PROFILE_REGISTERED_BY_DP] = server_on_register_profile;
+    handler_map[IPMessageType::JOBS_REGISTERED_BY_DP] = server_on_register_jobs;
     handler_map[IPMessageType::JOB_COMPLETED] = server_on_job_completed;
     handler_map[IPMessageType::PSTATE_MODIFICATION] = server_on_pstate_modification;
     handler_map[IPMessageType::SCHED_EXECUTE_JOB] = server_on_execute_job;
@@ -60,6 +61,7 @@ void server_process(BatsimContext * context)
     handler_map[IPMessageType::SCHED_CALL_ME_LATER] = server_on_call_me_later;
     handler_map[IPMessageType::SCHED_TELL_ME_ENERGY] = server_on_sched_tell_me_energy;
     handler_map[IPMessageType::SCHED_SET_JOB_METADATA] = server_on_set_job_metadata;
+    handler_map[IPMessageType::SCHED_SET_SUBSCRIPTION] = server_on_set_subscription;
     handler_map[IPMessageType::SCHED_WAIT_ANSWER] = server_on_sched_wait_answer;
     handler_map[IPMessageType::WAIT_QUERY] = server_on_wait_query;
     handler_map[IPMessageType::SCHED_READY] = server_on_sched_ready;
@@ -92,15 +94,37 @@ void server_process(BatsimContext * context)
     {
         // Wait and receive a message from a node or the request-reply process...
         IPMessage * message = receive_message("server");
+
+        // The shared state is only locked once the message is received, as its sender may need the lock to send it.
+        // Handlers only send messages to submitters, which never lock the shared state.
+        auto shared_state_lock = lock_shared_state(context);
         XBT_DEBUG("Server received a message of type %s:",
                  ip_message_type_to_string(message->type).c_str());
 
         // Handle the message
-        xbt_assert(handler_map.count(message->type) == 1,
-                   "The server does not know how to handle message type %s.",
-                   ip_message_type_to_string(message->type).c_str());
-        auto handler_function = handler_map[message->type];
-        handler_function(data, message);
+        if (message->type == IPMessageType::SCHED_DECISIONS)
+        {
+            // The decisions are applied in a single pass, in the order they have been taken
+            auto * decisions_message = static_cast<SchedulerDecisionsMessage *>(message->data);
+            for (IPMessage * decision : decisions_message->decisions)
+            {
+                XBT_DEBUG("Server applies a decision of type %s",
+                          ip_message_type_to_string(decision->type).c_str());
+                xbt_assert(handler_map.count(decision->type) == 1,
+                           "The server does not know how to handle message type %s.",
+                           ip_message_type_to_string(decision->type).c_str());
+                auto handler_function = handler_map[decision->type];
+                handler_function(data, decision);
+            }
+        }
+        else
+        {
+            xbt_assert(handler_map.count(message->type) == 1,
+                       "The server does not know how to handle message type %s.",
+                       ip_message_type_to_string(message->type).c_str());
+            auto handler_function = handler_map[message->type];
+            handler_function(data, message);
+        }
 
         // Delete the message
         delete message;
@@ -311,17 +335,19 @@ void server_on_job_submitted(ServerData * data,
 
         if (!data->context->redis_enabled)
         {
-            job_json_description = job->json_description;
+            job_json_description = std::move(job->json_description);
             if (data->context->submission_forward_profiles)
             {
-                profile_json_description = job->profile->json_description;
+                profile_json_description = job->profile->full_json_description();
             }
         }
 
         data->context->proto_writer->append_job_submitted(job->id.to_string(),
                                                           job_json_description,
                                                           profile_json_description,
+                                                          job->workflow_json_description,
                                                           simgrid::s4u::Engine::get_clock());
+        job->release_submission_data();
     }
 }
 
@@ -440,11 +466,11 @@ void server_on_pstate_modification(ServerData * data,
     // Unknown transition states will be set to -42.
     int transition_state = -42;
     Machine * first_machine = data->context->machines[message->machine_ids.first_element()];
-    if (first_machine->pstates[message->new_pstate] == PStateType::COMPUTATION_PSTATE)
+    if (first_machine->pstate_type(message->new_pstate) == PStateType::COMPUTATION_PSTATE)
     {
         transition_state = -1; // means we are switching to a COMPUTATION_PSTATE
     }
-    else if (first_machine->pstates[message->new_pstate] == PStateType::SLEEP_PSTATE)
+    else if (first_machine->pstate_type(message->new_pstate) == PStateType::SLEEP_PSTATE)
     {
         transition_state = -2; // means we are switching to a SLEEP_PSTATE
     }
@@ -466,14 +492,15 @@ void server_on_pstate_modification(ServerData * data,
         Machine * machine = data->context->machines[machine_id];
         unsigned long curr_pstate = machine->host->get_pstate();
 
-        if (machine->pstates[curr_pstate] == PStateType::COMPUTATION_PSTATE)
+        if (machine->pstate_type(static_cast<int>(curr_pstate)) == PStateType::COMPUTATION_PSTATE)
         {
-            if (machine->pstates[message->new_pstate] == PStateType::COMPUTATION_PSTATE)
+            if (machine->pstate_type(message->new_pstate) == PStateType::COMPUTATION_PSTATE)
             {
                 XBT_INFO("Switching machine %d ('%s') pstate : %lu -> %lu.", machine->id,
                          machine->name.c_str(), curr_pstate, message->new_pstate);
                 machine->host->set_pstate(message->new_pstate);
                 xbt_assert(machine->host->get_pstate() == message->new_pstate, "pstate inconsistency: the desired pstate has not been set");
+                data->context->machines.notify_machine_power_change(machine);
 
                 IntervalSet all_switched_machines;
                 if (data->context->current_switches.mark_switch_as_done(machine->id, message->new_pstate,
@@ -485,7 +512,7 @@ void server_on_pstate_modification(ServerData * data,
                                                                                simgrid::s4u::Engine::get_clock());
                 }
             }
-            else if (machine->pstates[message->new_pstate] == PStateType::SLEEP_PSTATE)
+            else if (machine->pstate_type(message->new_pstate) == PStateType::SLEEP_PSTATE)
             {
                 machine->update_machine_state(MachineState::TRANSITING_FROM_COMPUTING_TO_SLEEPING);
 
@@ -501,9 +528,9 @@ void server_on_pstate_modification(ServerData * data,
                           machine->id, machine->name.c_str(), curr_pstate, message->new_pstate);
             }
         }
-        else if (machine->pstates[curr_pstate] == PStateType::SLEEP_PSTATE)
+        else if (machine->pstate_type(static_cast<int>(curr_pstate)) == PStateType::SLEEP_PSTATE)
         {
-            xbt_assert(machine->pstates[message->new_pstate] == PStateType::COMPUTATION_PSTATE,
+            xbt_assert(machine->pstate_type(message->new_pstate) == PStateType::COMPUTATION_PSTATE,
                     "Switching from a sleep pstate to a non-computation pstate on machine %d ('%s') : %lu -> %lu, which is forbidden",
                     machine->id, machine->name.c_str(), curr_pstate, message->new_pstate);
 
@@ -684,13 +711,13 @@ void server_on_continue_dynamic_register(ServerData * data,
     data->context->registration_sched_finished = false;
 }
 
-void server_on_register_job(ServerData * data,
-                          IPMessage * task_data)
+/**
+ * @brief Updates the server state after a job has been registered by the decision process
+ * @param[in,out] data The data associated with the server_process
+ * @param[in] job The registered job
+ */
+static void on_job_registered_by_dp(ServerData * data, const JobPtr & job)
 {
-    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
-    auto * message = static_cast<JobRegisteredByDPMessage *>(task_data->data);
-    auto job = message->job;
-
     // Let's update global states
     ++data->nb_submitted_jobs;
 
@@ -701,17 +728,38 @@ void server_on_register_job(ServerData * data,
 
         if (!data->context->redis_enabled)
         {
-            job_json_description = job->json_description;
+            job_json_description = std::move(job->json_description);
             if (data->context->submission_forward_profiles)
             {
-                profile_json_description = job->profile->json_description;
+                profile_json_description = job->profile->full_json_description();
             }
         }
 
         data->context->proto_writer->append_job_submitted(job->id.to_string(),
                                                           job_json_description,
                                                           profile_json_description,
+                                                          job->workflow_json_description,
                                                           simgrid::s4u::Engine::get_clock());
+        job->release_submission_data();
+    }
+}
+
+void server_on_register_job(ServerData * data,
+                          IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
+    auto * message = static_cast<JobRegisteredByDPMessage *>(task_data->data);
+    on_job_registered_by_dp(data, message->job);
+}
+
+void server_on_register_jobs(ServerData * data,
+                             IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
+    auto * message = static_cast<JobsRegisteredByDPMessage *>(task_data->data);
+    for (const JobPtr & job : message->jobs)
+    {
+        on_job_registered_by_dp(data, job);
     }
 }
 
@@ -742,6 +790,17 @@ void server_on_set_job_metadata(ServerData * data,
     XBT_DEBUG("Metadata of job '%s' has been set", message->job_id.to_cstring());
 }
 
+void server_on_set_subscription(ServerData * data,
+                                IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr, "inconsistency: task_data has null data");
+    auto * message = static_cast<SetSubscriptionMessage *>(task_data->data);
+
+    // Only the events appended from now on are filtered by the new subscription
+    data->context->event_subscription = *message->subscription;
+    XBT_DEBUG("The event subscription of the decision process has been changed");
+}
+
 void server_on_change_job_state(ServerData * data,
                                 IPMessage * task_data)
 {
@@ -829,7 +888,14 @@ void server_on_to_job_msg(ServerData * data,
              job->id.to_cstring(),
              message->message.c_str());
 
-    job->incoming_message_buffer.push_back(message->message);
+    // The channel mutex is held so that the message cannot be pushed between the emptiness check
+    // and the wait of a SCHEDULER_RECV task running in another thread
+    JobMessageChannel & messages = job->messages();
+    std::unique_lock<simgrid::s4u::Mutex> lock(*messages.mutex);
+    messages.buffer.push_back(message->message);
+
+    // Wakes up the SCHEDULER_RECV task of the job, if it is currently waiting for a message
+    messages.cv->notify_all();
 }
 
 void server_on_from_job_msg(ServerData * data,
@@ -948,63 +1014,81 @@ void server_on_execute_job(ServerData * data,
     data->nb_running_jobs++;
     xbt_assert(data->nb_running_jobs <= data->nb_submitted_jobs, "inconsistency: nb_running_jobs > nb_submitted_jobs");
 
-    if (!data->context->allow_compute_sharing || !data->context->allow_storage_sharing)
+    // Check the allocation with the machine bitmaps first, as it does not depend on the number of machines in each interval.
+    // The allocation is only traversed machine by machine when it is invalid, to explain why.
+    if (!data->context->machines.can_execute_job_on(allocation->machine_ids,
+                                                    data->context->allow_compute_sharing,
+                                                    data->context->allow_storage_sharing,
+                                                    data->context->energy_used))
     {
         for (auto machine_id_it = allocation->machine_ids.elements_begin(); machine_id_it != allocation->machine_ids.elements_end(); ++machine_id_it)
         {
-            int machine_id = *machine_id_it;
-            const Machine * machine = data->context->machines[machine_id];
-            if (machine->has_role(roles::Permissions::COMPUTE_NODE) && !data->context->allow_compute_sharing)
+            xbt_assert(data->context->machines.exists(*machine_id_it),
+                       "Job '%s': Invalid job allocation ('%s'): machine %d does not exist",
+                       job->id.to_cstring(), allocation->machine_ids.to_string_hyphen().c_str(), *machine_id_it);
+        }
+
+        if (!data->context->allow_compute_sharing || !data->context->allow_storage_sharing)
+        {
+            for (auto machine_id_it = allocation->machine_ids.elements_begin(); machine_id_it != allocation->machine_ids.elements_end(); ++machine_id_it)
             {
-                (void) machine; // Avoids a warning if assertions are ignored
-                xbt_assert(machine->jobs_being_computed.empty(),
-                           "Job '%s': Invalid allocation ('%s'): machine %d (hostname='%s') is currently computing jobs (these ones:"
-                           " {%s}) whereas time-sharing on compute machines is disabled (rerun with --help to display the available options).",
-                           job->id.to_cstring(),
-                           allocation->machine_ids.to_string_hyphen().c_str(),
-                           machine->id, machine->name.c_str(),
-                           machine->jobs_being_computed_as_string().c_str());
+                int machine_id = *machine_id_it;
+                const Machine * machine = data->context->machines[machine_id];
+                if (machine->has_role(roles::Permissions::COMPUTE_NODE) && !data->context->allow_compute_sharing)
+                {
+                    (void) machine; // Avoids a warning if assertions are ignored
+                    xbt_assert(machine->jobs_being_computed.empty(),
+                               "Job '%s': Invalid allocation ('%s'): machine %d (hostname='%s') is currently computing jobs (these ones:"
+                               " {%s}) whereas time-sharing on compute machines is disabled (rerun with --help to display the available options).",
+                               job->id.to_cstring(),
+                               allocation->machine_ids.to_string_hyphen().c_str(),
+                               machine->id, machine->name.c_str(),
+                               machine->jobs_being_computed_as_string().c_str());
+                }
+                if (machine->has_role(roles::Permissions::STORAGE) && !data->context->allow_storage_sharing)
+                {
+                    (void) machine; // Avoids a warning if assertions are ignored
+                    xbt_assert(machine->jobs_being_computed.empty(),
+                               "Job '%s': Invalid allocation ('%s'): machine %d (hostname='%s') is currently computing jobs (these ones:"
+                               " {%s}) whereas time-sharing on storage machines is disabled (rerun with --help to display the available options).",
+                               job->id.to_cstring(),
+                               allocation->machine_ids.to_string_hyphen().c_str(),
+                               machine->id, machine->name.c_str(),
+                               machine->jobs_being_computed_as_string().c_str());
+                }
             }
-            if (machine->has_role(roles::Permissions::STORAGE) && !data->context->allow_storage_sharing)
+        }
+
+        // Check that every machine can compute the job
+        for (auto machine_id_it = allocation->machine_ids.elements_begin(); machine_id_it != allocation->machine_ids.elements_end(); ++machine_id_it)
+        {
+            int machine_id = *machine_id_it;
+            Machine * machine = data->context->machines[machine_id];
+
+            xbt_assert(machine->state == MachineState::COMPUTING || machine->state == MachineState::IDLE,
+                       "Job '%s': Invalid job allocation ('%s'): machine %d (hostname='%s') cannot compute jobs now "
+                       "(the machine is not computing nor idle, its state is '%s')",
+                       job->id.to_cstring(),
+                       allocation->machine_ids.to_string_hyphen().c_str(),
+                       machine->id, machine->name.c_str(),
+                       machine_state_to_string(machine->state).c_str());
+
+            if (data->context->energy_used)
             {
-                (void) machine; // Avoids a warning if assertions are ignored
-                xbt_assert(machine->jobs_being_computed.empty(),
-                           "Job '%s': Invalid allocation ('%s'): machine %d (hostname='%s') is currently computing jobs (these ones:"
-                           " {%s}) whereas time-sharing on storage machines is disabled (rerun with --help to display the available options).",
+                // Check that every machine is in a computation pstate
+                int ps = machine->host->get_pstate();
+                (void) ps; // Avoids a warning if assertions are ignored
+                xbt_assert(machine->has_pstate(ps), "machine %d has no pstate %d", machine_id, ps);
+                xbt_assert(machine->pstate_type(ps) == PStateType::COMPUTATION_PSTATE,
+                           "Job '%s': Invalid job allocation ('%s'): machine %d (hostname='%s') is not in a computation pstate (ps=%d)",
                            job->id.to_cstring(),
                            allocation->machine_ids.to_string_hyphen().c_str(),
-                           machine->id, machine->name.c_str(),
-                           machine->jobs_being_computed_as_string().c_str());
+                           machine->id, machine->name.c_str(), ps);
             }
         }
-    }
-
-    // Check that every machine can compute the job
-    for (auto machine_id_it = allocation->machine_ids.elements_begin(); machine_id_it != allocation->machine_ids.elements_end(); ++machine_id_it)
-    {
-        int machine_id = *machine_id_it;
-        Machine * machine = data->context->machines[machine_id];
-
-        xbt_assert(machine->state == MachineState::COMPUTING || machine->state == MachineState::IDLE,
-                   "Job '%s': Invalid job allocation ('%s'): machine %d (hostname='%s') cannot compute jobs now "
-                   "(the machine is not computing nor idle, its state is '%s')",
-                   job->id.to_cstring(),
-                   allocation->machine_ids.to_string_hyphen().c_str(),
-                   machine->id, machine->name.c_str(),
-                   machine_state_to_string(machine->state).c_str());
 
-        if (data->context->energy_used)
-        {
-        // Check that every machine is in a computation pstate
-        int ps = machine->host->get_pstate();
-        (void) ps; // Avoids a warning if assertions are ignored
-        xbt_assert(machine->has_pstate(ps), "machine %d has no pstate %d", machine_id, ps);
-        xbt_assert(machine->pstates[ps] == PStateType::COMPUTATION_PSTATE,
-                   "Job '%s': Invalid job allocation ('%s'): machine %d (hostname='%s') is not in a computation pstate (ps=%d)",
-                   job->id.to_cstring(),
-                   allocation->machine_ids.to_string_hyphen().c_str(),
-                   machine->id, machine->name.c_str(), ps);
-        }
+        xbt_die("Job '%s': Invalid job allocation ('%s'): inconsistency between the machine bitmaps and the machines",
+                job->id.to_cstring(), allocation->machine_ids.to_string_hyphen().c_str());
     }
 
     // Only PARALLEL_HOMOGENEOUS_TOTAL_AMOUNT profile, or a sequence of those profile, are able to manage the following scenario:
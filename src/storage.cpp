@@ -5,6 +5,10 @@
 
 #include "storage.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
 #include <xbt.h>
 
 using namespace std;
@@ -77,8 +81,11 @@ bool RedisStorage::set(const std::string &key, const std::string &value)
     bool ret = _redox.set(real_key, real_value);
     if (ret)
     {
-        XBT_INFO("Set: '%s'='%s'", real_key.c_str(), real_value.c_str());
-        xbt_assert(get(key) == value, "Batsim <-> Redis communications are inconsistent!");
+        XBT_DEBUG("Set: '%s'='%s'", real_key.c_str(), real_value.c_str());
+        if (_verify_writes)
+        {
+            xbt_assert(get(key) == value, "Batsim <-> Redis communications are inconsistent!");
+        }
     }
     else
     {
@@ -88,6 +95,82 @@ bool RedisStorage::set(const std::string &key, const std::string &value)
     return ret;
 }
 
+bool RedisStorage::set_many(const std::vector<std::pair<std::string, std::string>> & key_values,
+                            size_t max_pairs_per_command)
+{
+    xbt_assert(_is_connected, "Bad RedisStorage::set_many call: Not connected");
+    xbt_assert(max_pairs_per_command > 0, "Bad RedisStorage::set_many call: max_pairs_per_command is 0");
+
+    if (key_values.empty())
+    {
+        return true;
+    }
+
+    // Replies are received by the Redox event loop thread
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t nb_pending_commands = 0;
+    bool all_succeeded = true;
+
+    for (size_t first = 0; first < key_values.size(); first += max_pairs_per_command)
+    {
+        const size_t last = std::min(first + max_pairs_per_command, key_values.size());
+
+        vector<string> command;
+        command.reserve(1 + 2 * (last - first));
+        command.emplace_back("MSET");
+        for (size_t i = first; i < last; ++i)
+        {
+            command.push_back(build_key(key_values[i].first)); // todo: to_utf8?
+            command.push_back(key_values[i].second);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++nb_pending_commands;
+        }
+
+        _redox.command<string>(command, [&](redox::Command<string> & c)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!c.ok())
+            {
+                all_succeeded = false;
+            }
+            --nb_pending_commands;
+            cv.notify_all();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]{ return nb_pending_commands == 0; });
+    }
+
+    if (all_succeeded)
+    {
+        XBT_DEBUG("Set %zu key-values", key_values.size());
+        if (_verify_writes)
+        {
+            for (const auto & key_value : key_values)
+            {
+                xbt_assert(get(key_value.first) == key_value.second, "Batsim <-> Redis communications are inconsistent!");
+            }
+        }
+    }
+    else
+    {
+        XBT_WARN("Couldn't set some of %zu key-values", key_values.size());
+    }
+
+    return all_succeeded;
+}
+
+void RedisStorage::set_write_verification(bool verify_writes)
+{
+    _verify_writes = verify_writes;
+}
+
 bool RedisStorage::del(const std::string &key)
 {
     xbt_assert(_is_connected, "Bad RedisStorage::get call: Not connected");
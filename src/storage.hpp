@@ -6,6 +6,8 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <redox.hpp>
 
@@ -73,6 +75,24 @@ public:
     bool set(const std::string & key,
              const std::string & value);
 
+    /**
+     * @brief Sets several key-values in the Redis server
+     * @details Key-values are sent with MSET commands of at most max_pairs_per_command pairs.
+     *          These commands are pipelined: they are all sent before waiting for any reply.
+     * @param[in] key_values The key-values to set
+     * @param[in] max_pairs_per_command The maximum number of key-values per MSET command
+     * @return true if all the commands succeeded, false otherwise.
+     */
+    bool set_many(const std::vector<std::pair<std::string, std::string>> & key_values,
+                  size_t max_pairs_per_command = 1024);
+
+    /**
+     * @brief Sets whether written values should be read back to check them
+     * @details This doubles the number of round trips with the Redis server. It is disabled by default.
+     * @param[in] verify_writes Whether written values should be read back to check them
+     */
+    void set_write_verification(bool verify_writes);
+
     /**
      * @brief Deletes a key-value association from the Redis server
      * @param[in] key The key which should be deleted from the Redis server
@@ -121,4 +141,5 @@ private:
     redox::Redox _redox; //!< The Redox instance
     std::string _instance_key_prefix = ""; //!< The instance key prefix, which is added before to every user-given key.
     std::string _key_subparts_separator = ":"; //!< The key subparts separator, which is put between the instance key prefix and the user-given key.
+    bool _verify_writes = false; //!< Whether written values are read back to check them
 };
@@ -0,0 +1,269 @@
+/**
+ * @file sweep.cpp
+ * @brief Parameter sweeps and what-if branches, that run several simulations from a state computed once
+ */
+
+#include "sweep.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <simgrid/s4u.hpp>
+#include <xbt/config.hpp>
+
+#include <zmq.h>
+
+#include "batsim.hpp"
+#include "context.hpp"
+#include "export.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(sweep, "sweep"); //!< Logging
+
+using namespace std;
+using namespace rapidjson;
+
+//! The branches forked by the current process
+static vector<pid_t> forked_branches;
+
+vector<SweepWorker> sweep_workers_from_json(const string & json_str)
+{
+    Document doc;
+    doc.Parse(json_str.c_str());
+    if (doc.HasParseError() || !doc.IsArray() || doc.Size() == 0)
+    {
+        throw runtime_error("the sweep description should be a non-empty JSON array");
+    }
+
+    vector<SweepWorker> workers;
+    workers.reserve(doc.Size());
+    for (SizeType i = 0; i < doc.Size(); ++i)
+    {
+        const Value & worker_value = doc[i];
+        if (!worker_value.IsObject())
+        {
+            throw runtime_error("worker " + to_string(i) + " should be an object");
+        }
+
+        SweepWorker worker;
+        for (auto it = worker_value.MemberBegin(); it != worker_value.MemberEnd(); ++it)
+        {
+            const string key = it->name.GetString();
+            const Value & value = it->value;
+
+            if (key == "sched_config" && value.IsObject())
+            {
+                StringBuffer buffer;
+                rapidjson::Writer<StringBuffer> writer(buffer);
+                value.Accept(writer);
+                worker.sched_config = string(buffer.GetString(), buffer.GetSize());
+                continue;
+            }
+
+            if (!value.IsString())
+            {
+                throw runtime_error("the '" + key + "' value of worker " + to_string(i) + " should be a string");
+            }
+
+            if (key == "socket_endpoint")
+            {
+                worker.socket_endpoint = value.GetString();
+            }
+            else if (key == "export_prefix")
+            {
+                worker.export_prefix = value.GetString();
+            }
+            else if (key == "redis_prefix")
+            {
+                worker.redis_prefix = value.GetString();
+            }
+            else if (key == "sched_config")
+            {
+                worker.sched_config = value.GetString();
+            }
+            else
+            {
+                throw runtime_error("unknown key '" + key + "' in worker " + to_string(i));
+            }
+        }
+
+        workers.push_back(worker);
+    }
+
+    return workers;
+}
+
+bool fork_workers(int nb_workers, int max_parallelism, int & worker_index, int & return_code)
+{
+    xbt_assert(nb_workers > 0, "Invalid number of workers to fork (%d)", nb_workers);
+    if (max_parallelism <= 0 || max_parallelism > nb_workers)
+    {
+        max_parallelism = nb_workers;
+    }
+
+    map<pid_t, int> running_workers;
+    int nb_forked_workers = 0;
+    return_code = 0;
+
+    while (nb_forked_workers < nb_workers || !running_workers.empty())
+    {
+        if (nb_forked_workers < nb_workers && static_cast<int>(running_workers.size()) < max_parallelism)
+        {
+            // Buffered outputs would otherwise be written again by the worker
+            fflush(stdout);
+            fflush(stderr);
+
+            pid_t pid = fork();
+            xbt_assert(pid != -1, "Cannot fork worker %d (errno=%s)", nb_forked_workers, strerror(errno));
+
+            if (pid == 0)
+            {
+                worker_index = nb_forked_workers;
+                return true;
+            }
+
+            XBT_INFO("Worker %d has been forked (pid=%d).", nb_forked_workers, static_cast<int>(pid));
+            running_workers[pid] = nb_forked_workers;
+            ++nb_forked_workers;
+        }
+        else
+        {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, 0);
+            xbt_assert(pid != -1, "Cannot wait for workers (errno=%s)", strerror(errno));
+
+            auto worker_it = running_workers.find(pid);
+            if (worker_it == running_workers.end())
+            {
+                continue;
+            }
+
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            {
+                XBT_INFO("Worker %d has finished.", worker_it->second);
+            }
+            else
+            {
+                XBT_ERROR("Worker %d has failed (wait status=%d).", worker_it->second, status);
+                return_code = 1;
+            }
+            running_workers.erase(worker_it);
+        }
+    }
+
+    worker_index = -1;
+    return false;
+}
+
+int fork_branches(int nb_branches)
+{
+    xbt_assert(nb_branches > 0, "Invalid number of branches to fork (%d)", nb_branches);
+
+    for (int branch = 1; branch <= nb_branches; ++branch)
+    {
+        // Buffered outputs would otherwise be written again by the branch
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        xbt_assert(pid != -1, "Cannot fork branch %d (errno=%s)", branch, strerror(errno));
+
+        if (pid == 0)
+        {
+            // The previously forked branches are siblings, not children
+            forked_branches.clear();
+            return branch;
+        }
+
+        XBT_INFO("Branch %d has been forked (pid=%d).", branch, static_cast<int>(pid));
+        forked_branches.push_back(pid);
+    }
+
+    return 0;
+}
+
+int wait_for_branches()
+{
+    int return_code = 0;
+    for (size_t i = 0; i < forked_branches.size(); ++i)
+    {
+        int status = 0;
+        pid_t pid = waitpid(forked_branches[i], &status, 0);
+        xbt_assert(pid != -1, "Cannot wait for branch %zu (errno=%s)", i + 1, strerror(errno));
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            XBT_INFO("Branch %zu has finished.", i + 1);
+        }
+        else
+        {
+            XBT_ERROR("Branch %zu has failed (wait status=%d).", i + 1, status);
+            return_code = 1;
+        }
+    }
+    forked_branches.clear();
+
+    return return_code;
+}
+
+void branch_process(BatsimContext * context, const MainArguments * main_args)
+{
+    simgrid::s4u::this_actor::sleep_until(main_args->branch_at);
+
+    // The other actors are not running while this one is, so the whole simulation state is consistent there.
+    // The decision process is not being called either, as calls block the simulation.
+    // Threaded contexts are rejected before the simulation starts, this is only a safety net.
+    xbt_assert(simgrid::config::get_value<std::string>("contexts/factory") != "thread" &&
+               simgrid::config::get_value<int>("contexts/nthreads") <= 1,
+               "The simulation cannot be branched if SimGrid actors run in threads "
+               "(contexts/factory:thread or contexts/nthreads > 1)");
+    XBT_INFO("Branching the simulation into %zu branches.", main_args->sweep_workers.size());
+    suspend_batsim_outputs();
+
+    // Outputs are copied before forking, as the original process appends to its files as soon as it resumes them
+    vector<string> export_prefixes;
+    for (size_t i = 0; i < main_args->sweep_workers.size(); ++i)
+    {
+        const SweepWorker & worker = main_args->sweep_workers[i];
+        export_prefixes.push_back(worker.export_prefix.empty() ? context->export_prefix + "_" + to_string(i + 1) : worker.export_prefix);
+        copy_batsim_outputs(context, export_prefixes.back());
+    }
+
+    int branch = fork_branches(static_cast<int>(main_args->sweep_workers.size()));
+
+    if (branch == 0)
+    {
+        resume_batsim_outputs(context, context->export_prefix);
+        return;
+    }
+
+    const SweepWorker & worker = main_args->sweep_workers[static_cast<size_t>(branch - 1)];
+    const string & export_prefix = export_prefixes[static_cast<size_t>(branch - 1)];
+    resume_batsim_outputs(context, export_prefix);
+
+    // The ZMQ context of the parent process cannot be used nor destroyed, as its I/O threads have not been duplicated
+    context->zmq_context = zmq_ctx_new();
+    xbt_assert(context->zmq_context != nullptr, "Cannot create ZMQ context");
+    context->zmq_socket = zmq_socket(context->zmq_context, ZMQ_REQ);
+    xbt_assert(context->zmq_socket != nullptr, "Cannot create ZMQ REQ socket (errno=%s)", strerror(errno));
+    int err = zmq_connect(context->zmq_socket, worker.socket_endpoint.c_str());
+    (void) err; // Avoids a warning if assertions are ignored
+    xbt_assert(err == 0, "Cannot connect ZMQ socket to '%s' (errno=%s)", worker.socket_endpoint.c_str(), strerror(errno));
+
+    // Lets the decision process of the branch know where it starts from
+    context->proto_writer->append_notify_simulation_branched(branch, simgrid::s4u::Engine::get_clock());
+
+    XBT_INFO("Running branch %d (socket endpoint: '%s', export prefix: '%s').",
+             branch, worker.socket_endpoint.c_str(), export_prefix.c_str());
+}
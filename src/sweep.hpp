@@ -0,0 +1,68 @@
+/**
+ * @file sweep.hpp
+ * @brief Parameter sweeps and what-if branches, that run several simulations from a state computed once
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct BatsimContext;
+struct MainArguments;
+
+/**
+ * @brief The parameters specific to one worker of a parameter sweep
+ * @details Empty parameters are derived from the command-line ones (see sweep_workers_from_json).
+ */
+struct SweepWorker
+{
+    std::string socket_endpoint; //!< The Decision process socket endpoint of the worker
+    std::string export_prefix;   //!< The export prefix of the worker
+    std::string redis_prefix;    //!< The Redis prefix of the worker
+    std::string sched_config;    //!< The scheduler configuration of the worker
+};
+
+/**
+ * @brief Reads the workers of a parameter sweep from a JSON description
+ * @details The description is an array of objects with optional 'socket_endpoint', 'export_prefix',
+ *          'redis_prefix' and 'sched_config' (string or object) fields.
+ * @param[in] json_str The JSON description (as a string)
+ * @return The workers, in the description order. An exception is thrown if the description is invalid.
+ */
+std::vector<SweepWorker> sweep_workers_from_json(const std::string & json_str);
+
+/**
+ * @brief Forks worker processes and waits for them in the calling (parent) process
+ * @details At most max_parallelism workers run at the same time.
+ *          Workers share the memory of the parent process (copy-on-write) at the time they are forked,
+ *          which must not have started any thread.
+ * @param[in] nb_workers The number of workers to fork
+ * @param[in] max_parallelism The maximum number of workers that run at the same time. 0 means no limit.
+ * @param[out] worker_index The index of the worker in [0, nb_workers[ in worker processes, -1 in the parent process
+ * @param[out] return_code The return code of the parent process (non-zero if a worker failed)
+ * @return true in worker processes, false in the parent process once all workers have finished
+ */
+bool fork_workers(int nb_workers, int max_parallelism, int & worker_index, int & return_code);
+
+/**
+ * @brief Forks branch processes. Unlike fork_workers, the calling (parent) process does not wait for them.
+ * @param[in] nb_branches The number of branches to fork
+ * @return The index of the branch in [1, nb_branches] in branch processes, 0 in the parent process
+ */
+int fork_branches(int nb_branches);
+
+/**
+ * @brief Waits for the branches forked by the current process
+ * @return A non-zero value if a branch failed, 0 otherwise
+ */
+int wait_for_branches();
+
+/**
+ * @brief The process that forks the simulation into what-if branches at a given simulated time
+ * @details Each branch (child process) continues the simulation with its own decision process, export prefix and
+ *          Redis-free context. The parent process continues the simulation as is.
+ * @param[in,out] context The BatsimContext
+ * @param[in] main_args The command-line arguments (branch_at and sweep_workers are used)
+ */
+void branch_process(BatsimContext * context, const MainArguments * main_args);
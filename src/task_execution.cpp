@@ -470,6 +470,9 @@ int execute_parallel_task(BatTask * btask,
     auto profile = btask->profile;
     std::vector<simgrid::s4u::Host*> hosts_to_use = allocation->hosts;
 
+    // The machines are read and the ptask is made visible to the killer process of the job until the ptask is started
+    auto shared_state_lock = lock_shared_state(context);
+
     std::vector<double> computation_vector;
     std::vector<double> communication_matrix;
 
@@ -652,6 +655,7 @@ int execute_parallel_task(BatTask * btask,
         try
         {
             ptask->start();
+            release_shared_state(shared_state_lock);
             ptask->wait();
         }
         catch (const simgrid::CancelException &)
@@ -667,6 +671,7 @@ int execute_parallel_task(BatTask * btask,
         try
         {
             ptask->start();
+            release_shared_state(shared_state_lock);
             ptask->wait_for(*remaining_time);
         }
         catch (const simgrid::TimeoutException &)
@@ -1,9 +1,16 @@
 #include <gtest/gtest.h>
 
 #include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
 
 #include <intervalset.hpp>
 
+#include <zlib.h>
+
 #include "../export.hpp"
 
 TEST(buffered_outputting, write_buffer)
@@ -37,6 +44,165 @@ TEST(buffered_outputting, write_buffer)
     EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
 }
 
+TEST(buffered_outputting, write_buffer_sync_async_content)
+{
+    const char * sync_filename = "/tmp/test_wbuf_sync";
+    const char * async_filename = "/tmp/test_wbuf_async";
+    WriteBuffer * sync_buf = new WriteBuffer(sync_filename, 8, false);
+    WriteBuffer * async_buf = new WriteBuffer(async_filename, 8, true);
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        // Alternates texts smaller, equal and bigger than the buffer size
+        const std::string text = std::string(static_cast<size_t>(i % 13), static_cast<char>('a' + i % 26)) + "\n";
+        sync_buf->append_text(text.c_str());
+        async_buf->append_text(text.c_str());
+        expected += text;
+
+        if (i % 100 == 0)
+        {
+            async_buf->flush_buffer();
+        }
+    }
+
+    // Flush content, close files and release memory
+    delete sync_buf;
+    delete async_buf;
+
+    for (const char * filename : {sync_filename, async_filename})
+    {
+        std::ifstream f(filename);
+        std::stringstream content;
+        content << f.rdbuf();
+        EXPECT_EQ(content.str(), expected) << "Unexpected content in file " << filename;
+
+        // Remove temporary file
+        int remove_ret = remove(filename);
+        EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
+    }
+}
+
+TEST(buffered_outputting, write_buffer_gzip)
+{
+    EXPECT_EQ(output_compression_from_filename("/tmp/out_jobs.csv"), OutputCompression::NONE);
+    EXPECT_EQ(output_compression_from_filename("/tmp/out_jobs.csv.gz"), OutputCompression::GZIP);
+    EXPECT_EQ(output_compression_from_string("none"), OutputCompression::NONE);
+    EXPECT_EQ(output_compression_from_string("gzip"), OutputCompression::GZIP);
+    EXPECT_THROW(output_compression_from_string("zip"), std::runtime_error);
+
+    const char * sync_filename = "/tmp/test_wbuf_sync.gz";
+    const char * async_filename = "/tmp/test_wbuf_async.gz";
+    WriteBuffer * sync_buf = new WriteBuffer(sync_filename, 8, false);
+    WriteBuffer * async_buf = new WriteBuffer(async_filename, 8, true);
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::string text = std::to_string(i) + std::string(static_cast<size_t>(i % 13), 'x') + "\n";
+        sync_buf->append_text(text.c_str());
+        async_buf->append_text(text.c_str());
+        expected += text;
+    }
+
+    // Flush content, close files and release memory
+    delete sync_buf;
+    delete async_buf;
+
+    for (const char * filename : {sync_filename, async_filename})
+    {
+        gzFile gz = gzopen(filename, "rb");
+        ASSERT_NE(gz, nullptr) << "Could not open file " << filename;
+
+        std::string content;
+        char read_buffer[256];
+        int nb_read;
+        while ((nb_read = gzread(gz, read_buffer, sizeof(read_buffer))) > 0)
+        {
+            content.append(read_buffer, static_cast<size_t>(nb_read));
+        }
+        EXPECT_EQ(nb_read, 0) << "Could not decompress file " << filename;
+        EXPECT_EQ(gzclose(gz), Z_OK);
+        EXPECT_EQ(content, expected) << "Unexpected content in file " << filename;
+
+        // Remove temporary file
+        int remove_ret = remove(filename);
+        EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
+    }
+}
+
+TEST(buffered_outputting, jobs_columns)
+{
+    std::vector<JobsColumn> all_columns = jobs_columns_from_string("all");
+    ASSERT_EQ(all_columns.size(), static_cast<size_t>(JobsColumn::NB_COLUMNS));
+    EXPECT_STREQ(jobs_column_to_string(all_columns.front()), "job_id");
+    EXPECT_STREQ(jobs_column_to_string(all_columns.back()), "metadata");
+
+    std::vector<JobsColumn> columns = jobs_columns_from_string("finish_time,job_id,success");
+    std::vector<JobsColumn> expected_columns = {JobsColumn::FINISH_TIME, JobsColumn::JOB_ID, JobsColumn::SUCCESS};
+    EXPECT_EQ(columns, expected_columns);
+
+    EXPECT_THROW(jobs_columns_from_string("job_id,unknown"), std::runtime_error);
+    EXPECT_THROW(jobs_columns_from_string("job_id,job_id"), std::runtime_error);
+    EXPECT_THROW(jobs_columns_from_string(""), std::runtime_error);
+}
+
+TEST(buffered_outputting, npy_columns)
+{
+    const char * filename = "/tmp/test_npy_column.npy";
+    const std::string list_prefix = "/tmp/test_npy_list_column";
+    {
+        NpyColumnWriter column(filename, 'f', sizeof(double), 1, 2);
+        NpyListColumnWriter list_column(list_prefix, 'S', sizeof(char));
+        for (double value : {1.5, -2.0, 42.25})
+        {
+            column.append(value);
+        }
+        list_column.append_string("ab");
+        list_column.append_string("");
+        list_column.append_string("cde");
+    }
+
+    std::ifstream f(filename, std::ios::binary);
+    std::stringstream content_stream;
+    content_stream << f.rdbuf();
+    const std::string content = content_stream.str();
+
+    const size_t header_size = 128;
+    ASSERT_EQ(content.size(), header_size + 3 * sizeof(double));
+    EXPECT_EQ(content.substr(1, 5), "NUMPY");
+    EXPECT_NE(content.find("'shape': (3,)"), std::string::npos);
+    EXPECT_EQ(content[header_size - 1], '\n');
+
+    double values[3];
+    memcpy(values, content.data() + header_size, sizeof(values));
+    EXPECT_EQ(values[0], 1.5);
+    EXPECT_EQ(values[1], -2.0);
+    EXPECT_EQ(values[2], 42.25);
+
+    std::ifstream values_f(list_prefix + ".values.npy", std::ios::binary);
+    std::stringstream values_stream;
+    values_stream << values_f.rdbuf();
+    EXPECT_EQ(values_stream.str().substr(header_size), "abcde");
+
+    std::ifstream offsets_f(list_prefix + ".offsets.npy", std::ios::binary);
+    std::stringstream offsets_stream;
+    offsets_stream << offsets_f.rdbuf();
+    const std::string offsets_content = offsets_stream.str();
+    ASSERT_EQ(offsets_content.size(), header_size + 4 * sizeof(int64_t));
+    int64_t offsets[4];
+    memcpy(offsets, offsets_content.data() + header_size, sizeof(offsets));
+    EXPECT_EQ(offsets[0], 0);
+    EXPECT_EQ(offsets[1], 2);
+    EXPECT_EQ(offsets[2], 2);
+    EXPECT_EQ(offsets[3], 5);
+
+    for (const std::string & name : {std::string(filename), list_prefix + ".values.npy", list_prefix + ".offsets.npy"})
+    {
+        int remove_ret = remove(name.c_str());
+        EXPECT_EQ(remove_ret, 0) << "Could not remove file " << name;
+    }
+}
 
 TEST(buffered_outputting, pstate_writer)
 {
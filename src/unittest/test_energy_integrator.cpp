@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <simgrid/plugins/energy.h>
+#include <simgrid/s4u.hpp>
+
+#include "../machines.hpp"
+
+// Computes the energy consumed by a range of machines the way Batsim did before the integrator: one SimGrid call per machine
+static long double full_scan_energy(const std::vector<Machine *> & machines, int first, int last)
+{
+    long double energy = 0;
+    for (int machine_id = first; machine_id <= last; ++machine_id)
+    {
+        energy += static_cast<long double>(sg_host_get_consumed_energy(machines[static_cast<size_t>(machine_id)]->host));
+    }
+    return energy;
+}
+
+// Checks that the integrator returns the full scan values on several ranges and on all the machines
+static void check_energy(EnergyIntegrator & integrator, const std::vector<Machine *> & machines)
+{
+    const int last_machine = static_cast<int>(machines.size()) - 1;
+    const std::vector<std::pair<int, int>> ranges = {{0, last_machine}, {0, 0}, {2, 5}, {3, 10}, {4, 4}, {60, last_machine}};
+
+    for (const auto & range : ranges)
+    {
+        const long double expected = full_scan_energy(machines, range.first, range.second);
+        EXPECT_NEAR(static_cast<double>(integrator.consumed_energy(range.first, range.second)),
+                    static_cast<double>(expected), 1e-6 * static_cast<double>(expected))
+            << "range [" << range.first << "," << range.second << "] at time " << simgrid::s4u::Engine::get_clock();
+    }
+
+    for (const Machine * machine : {machines[0], machines[4], machines[static_cast<size_t>(last_machine)]})
+    {
+        const long double expected = full_scan_energy(machines, machine->id, machine->id);
+        EXPECT_NEAR(static_cast<double>(integrator.consumed_energy(machine)), static_cast<double>(expected),
+                    1e-6 * static_cast<double>(expected)) << "machine " << machine->id;
+    }
+
+    const long double expected = full_scan_energy(machines, 0, last_machine);
+    EXPECT_NEAR(static_cast<double>(integrator.total_consumed_energy()), static_cast<double>(expected),
+                1e-6 * static_cast<double>(expected));
+}
+
+// Changes the state of some machines, notifying the integrator like Machines does
+static void set_state(EnergyIntegrator & integrator, const std::vector<Machine *> & machines,
+                      int first, int last, MachineState state)
+{
+    for (int machine_id = first; machine_id <= last; ++machine_id)
+    {
+        machines[static_cast<size_t>(machine_id)]->state = state;
+        integrator.on_power_change(machines[static_cast<size_t>(machine_id)]);
+    }
+}
+
+TEST(energy_integrator, equals_full_scan)
+{
+    int argc = 1;
+    char argv0[] = "batunittest";
+    char * argv[] = {argv0, nullptr};
+    sg_host_energy_plugin_init();
+    simgrid::s4u::Engine engine(&argc, argv);
+    engine.load_platform(std::string(BATSIM_PLATFORMS_DIR) + "/energy_platform_homogeneous_no_net_128.xml");
+
+    Machines machines_owner;
+    std::vector<Machine *> machines;
+    for (simgrid::s4u::Host * host : engine.get_all_hosts())
+    {
+        if (host->get_name() == "master_host")
+        {
+            continue;
+        }
+
+        Machine * machine = new Machine(&machines_owner);
+        machine->id = static_cast<int>(machines.size());
+        machine->name = host->get_name();
+        machine->host = host;
+        machines.push_back(machine);
+    }
+    ASSERT_EQ(machines.size(), 128u);
+
+    simgrid::s4u::Actor::create("checker", engine.host_by_name("master_host"), [&machines]() {
+        EnergyIntegrator integrator;
+        integrator.initialize(machines);
+        check_energy(integrator, machines); // All machines are unstable
+
+        simgrid::s4u::this_actor::sleep_for(10);
+        check_energy(integrator, machines); // Idle machines become stable
+        simgrid::s4u::this_actor::sleep_for(10);
+        check_energy(integrator, machines); // Stable machines are integrated
+
+        // Machines 2 to 5 compute while machine 10 changes its power state
+        set_state(integrator, machines, 2, 5, MachineState::COMPUTING);
+        std::vector<simgrid::s4u::ActorPtr> workers;
+        for (int machine_id = 2; machine_id <= 5; ++machine_id)
+        {
+            workers.push_back(simgrid::s4u::Actor::create("worker", machines[static_cast<size_t>(machine_id)]->host, []() {
+                simgrid::s4u::this_actor::execute(1e9);
+            }));
+        }
+        machines[10]->host->set_pstate(2);
+        integrator.on_power_change(machines[10]);
+        check_energy(integrator, machines);
+
+        simgrid::s4u::this_actor::sleep_for(3);
+        check_energy(integrator, machines);
+        simgrid::s4u::this_actor::sleep_for(3);
+        check_energy(integrator, machines);
+
+        for (auto & worker : workers)
+        {
+            worker->join();
+        }
+        set_state(integrator, machines, 2, 5, MachineState::IDLE);
+        check_energy(integrator, machines);
+
+        // Machine 4 is the target of an IO job: its load changes while its state does not
+        integrator.begin_exact_period(machines[4]);
+        auto io_worker = simgrid::s4u::Actor::create("io_worker", machines[4]->host, []() {
+            simgrid::s4u::this_actor::sleep_for(2);
+            simgrid::s4u::this_actor::execute(1e8);
+        });
+        simgrid::s4u::this_actor::sleep_for(1);
+        check_energy(integrator, machines);
+        simgrid::s4u::this_actor::sleep_for(2);
+        check_energy(integrator, machines);
+        io_worker->join();
+        integrator.end_exact_period(machines[4]);
+
+        simgrid::s4u::this_actor::sleep_for(5);
+        check_energy(integrator, machines); // Machine 4 is integrated again
+        simgrid::s4u::this_actor::sleep_for(5);
+        check_energy(integrator, machines);
+    });
+
+    engine.run();
+
+    for (Machine * machine : machines)
+    {
+        delete machine;
+    }
+}
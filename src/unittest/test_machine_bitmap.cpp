@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "../machines.hpp"
+
+TEST(machine_bitmap, set_and_test)
+{
+    MachineBitmap bitmap;
+    bitmap.resize(130);
+    EXPECT_EQ(bitmap.size(), 130u);
+
+    for (int machine_id : {0, 63, 64, 129})
+    {
+        EXPECT_FALSE(bitmap.test(machine_id));
+        bitmap.set(machine_id, true);
+        EXPECT_TRUE(bitmap.test(machine_id));
+    }
+
+    bitmap.set(64, false);
+    EXPECT_FALSE(bitmap.test(64));
+    EXPECT_TRUE(bitmap.test(63));
+}
+
+TEST(machine_bitmap, all_in_range)
+{
+    MachineBitmap bitmap;
+    bitmap.resize(200);
+    for (int machine_id = 10; machine_id <= 150; ++machine_id)
+    {
+        bitmap.set(machine_id, true);
+    }
+
+    EXPECT_TRUE(bitmap.all_in_range(10, 150));
+    EXPECT_TRUE(bitmap.all_in_range(60, 70));
+    EXPECT_TRUE(bitmap.all_in_range(64, 127));
+    EXPECT_FALSE(bitmap.all_in_range(9, 150));
+    EXPECT_FALSE(bitmap.all_in_range(10, 151));
+
+    bitmap.set(100, false);
+    EXPECT_FALSE(bitmap.all_in_range(10, 150));
+    EXPECT_TRUE(bitmap.all_in_range(101, 150));
+
+    // Ranges out of the bitmap are never valid
+    EXPECT_FALSE(bitmap.all_in_range(-1, 20));
+    EXPECT_FALSE(bitmap.all_in_range(20, 200));
+    EXPECT_FALSE(bitmap.all_in_range(30, 20));
+}
+
+TEST(machine_bitmap, none_in_range_of_both)
+{
+    MachineBitmap busy, compute;
+    busy.resize(256);
+    compute.resize(256);
+
+    for (int machine_id = 0; machine_id < 128; ++machine_id)
+    {
+        compute.set(machine_id, true);
+    }
+    busy.set(200, true);
+    EXPECT_TRUE(busy.none_in_range_of_both(compute, 0, 255));
+
+    busy.set(127, true);
+    EXPECT_FALSE(busy.none_in_range_of_both(compute, 0, 255));
+    EXPECT_FALSE(busy.none_in_range_of_both(compute, 127, 127));
+    EXPECT_TRUE(busy.none_in_range_of_both(compute, 0, 126));
+    EXPECT_TRUE(busy.none_in_range_of_both(compute, 128, 255));
+}
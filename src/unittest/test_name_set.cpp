@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../name_set.hpp"
+
+TEST(name_set, numeric_names)
+{
+    NameSet names;
+    for (int i = 0; i < 10000; ++i)
+    {
+        names.insert(std::to_string(i));
+    }
+
+    EXPECT_EQ(names.size(), 10000u);
+    EXPECT_EQ(names.nb_stored_items(), 1u);
+    EXPECT_TRUE(names.contains("0"));
+    EXPECT_TRUE(names.contains("9999"));
+    EXPECT_FALSE(names.contains("10000"));
+
+    // Names that look like integers but are not canonical are different names
+    EXPECT_FALSE(names.contains("042"));
+    EXPECT_FALSE(names.contains("-1"));
+    EXPECT_FALSE(names.contains("+1"));
+    names.insert("042");
+    EXPECT_TRUE(names.contains("042"));
+    EXPECT_EQ(names.nb_stored_items(), 2u);
+}
+
+TEST(name_set, other_names)
+{
+    NameSet names;
+    names.insert("job_a");
+    names.insert("");
+    names.insert("99999999999999999999");
+
+    EXPECT_TRUE(names.contains("job_a"));
+    EXPECT_TRUE(names.contains(""));
+    EXPECT_TRUE(names.contains("99999999999999999999"));
+    EXPECT_FALSE(names.contains("job_b"));
+    EXPECT_EQ(names.size(), 3u);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../pool.hpp"
+
+TEST(pool, reuses_blocks)
+{
+    FixedSizePool pool(24, 4);
+    EXPECT_EQ(pool.block_size() % alignof(std::max_align_t), 0u);
+    EXPECT_GE(pool.block_size(), 24u);
+
+    std::vector<void *> blocks;
+    for (int i = 0; i < 4; ++i)
+    {
+        blocks.push_back(pool.allocate());
+    }
+    EXPECT_EQ(pool.nb_slabs(), 1u);
+    EXPECT_EQ(pool.nb_allocated_blocks(), 4u);
+
+    // Blocks of a slab are contiguous and distinct
+    EXPECT_EQ(std::set<void *>(blocks.begin(), blocks.end()).size(), 4u);
+    EXPECT_EQ(static_cast<char *>(blocks[1]) - static_cast<char *>(blocks[0]), static_cast<ptrdiff_t>(pool.block_size()));
+
+    // A freed block is given back by the next allocation
+    pool.deallocate(blocks[2]);
+    EXPECT_EQ(pool.allocate(), blocks[2]);
+    EXPECT_EQ(pool.nb_slabs(), 1u);
+
+    // A new slab is only created when the pool is exhausted
+    void * block = pool.allocate();
+    EXPECT_EQ(pool.nb_slabs(), 2u);
+    EXPECT_EQ(pool.nb_allocated_blocks(), 5u);
+
+    pool.deallocate(block);
+    for (void * b : blocks)
+    {
+        pool.deallocate(b);
+    }
+    EXPECT_EQ(pool.nb_allocated_blocks(), 0u);
+}
+
+TEST(pool, allocate_shared)
+{
+    struct Value
+    {
+        explicit Value(int v) : value(v) {}
+        int value;
+        std::string name = "value";
+    };
+
+    auto ptr = std::allocate_shared<Value>(PoolAllocator<Value>(), 42);
+    EXPECT_EQ(ptr->value, 42);
+    EXPECT_EQ(ptr->name, "value");
+
+    std::weak_ptr<Value> weak = ptr;
+    ptr.reset();
+    EXPECT_TRUE(weak.expired());
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <rapidjson/document.h>
+
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../workload.hpp"
+
+// Builds a workload whose 'phg' profile is a template, while its 'delay' profile is not
+static Workload * create_workload()
+{
+    Workload * workload = Workload::new_static_workload("w0", "unused.json");
+    workload->jobs = new Jobs;
+    workload->profiles = new Profiles;
+    workload->jobs->set_workload(workload);
+    workload->jobs->set_profiles(workload->profiles);
+
+    ProfilePtr phg = Profile::from_json("phg", R"({"type": "parallel_homogeneous", "cpu": 1e6, "com": 1e3, "template": true})");
+    workload->profiles->add_profile("phg", phg);
+    ProfilePtr delay = Profile::from_json("delay", R"({"type": "delay", "delay": 10})");
+    workload->profiles->add_profile("delay", delay);
+    return workload;
+}
+
+// Creates a job from its JSON description and adds it into the workload
+static JobPtr add_job(Workload * workload, const std::string & json_description)
+{
+    auto job = Job::from_json(json_description, workload);
+    workload->jobs->add_job(job);
+    return job;
+}
+
+TEST(profile_templates, parameter_binding)
+{
+    Workload * workload = create_workload();
+    auto job = add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "phg", "cpu": 1e12}})");
+
+    EXPECT_EQ(job->profile->name, "phg@1");
+    EXPECT_EQ(job->profile->registered_name(), "phg");
+    EXPECT_EQ(job->profile->type, ProfileType::PARALLEL_HOMOGENEOUS);
+    auto * data = static_cast<ParallelHomogeneousProfileData *>(job->profile->data);
+    EXPECT_DOUBLE_EQ(data->cpu, 1e12); // Bound parameter
+    EXPECT_DOUBLE_EQ(data->com, 1e3); // Template value
+
+    // The template itself is unchanged
+    auto * template_data = static_cast<ParallelHomogeneousProfileData *>(workload->profiles->at("phg")->data);
+    EXPECT_DOUBLE_EQ(template_data->cpu, 1e6);
+    EXPECT_TRUE(workload->profiles->at("phg")->is_template);
+
+    delete workload;
+}
+
+TEST(profile_templates, type_cannot_be_overridden)
+{
+    Workload * workload = create_workload();
+    EXPECT_DEATH(add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "phg", "type": "delay"}})"),
+                 "cannot be overridden");
+    delete workload;
+}
+
+TEST(profile_templates, unknown_template)
+{
+    Workload * workload = create_workload();
+    EXPECT_DEATH(add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "unknown", "cpu": 1}})"),
+                 "does not exist");
+    delete workload;
+}
+
+TEST(profile_templates, reuse_after_garbage_collection)
+{
+    Workload * workload = create_workload();
+    add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "phg", "cpu": 1e12}})");
+    add_job(workload, R"({"id": "2", "subtime": 0, "res": 4, "profile": "phg"})");
+
+    // Deleting the jobs garbage collects their profiles, but not the template
+    workload->jobs->delete_job(JobIdentifier("w0", "1"), true);
+    workload->jobs->delete_job(JobIdentifier("w0", "2"), true);
+
+    auto job = add_job(workload, R"({"id": "3", "subtime": 0, "res": 4, "profile": {"template": "phg", "cpu": 1e9}})");
+    EXPECT_EQ(job->profile->name, "phg@3");
+    EXPECT_DOUBLE_EQ(static_cast<ParallelHomogeneousProfileData *>(job->profile->data)->cpu, 1e9);
+
+    delete workload;
+}
+
+TEST(profile_templates, templates_are_marked_at_load)
+{
+    Workload * workload = create_workload();
+    EXPECT_TRUE(workload->profiles->at("phg")->is_template);
+    EXPECT_FALSE(workload->profiles->at("delay")->is_template);
+
+    // Templates are kept even if nothing references them yet
+    workload->profiles->remove_unreferenced_profiles();
+    workload->profiles->remove_profile("phg");
+    auto job = add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "phg", "com": 0}})");
+    EXPECT_EQ(job->profile->name, "phg@1");
+
+    delete workload;
+}
+
+TEST(profile_templates, not_a_template)
+{
+    Workload * workload = create_workload();
+    EXPECT_DEATH(add_job(workload, R"({"id": "1", "subtime": 0, "res": 1, "profile": {"template": "delay", "delay": 1}})"),
+                 "is not a template");
+    delete workload;
+}
+
+TEST(profile_templates, instances_only_store_their_parameters)
+{
+    Workload * workload = create_workload();
+    auto job = add_job(workload, R"({"id": "1", "subtime": 0, "res": 4, "profile": {"template": "phg", "cpu": 1e12}})");
+
+    EXPECT_TRUE(job->profile->json_description.empty());
+    EXPECT_FALSE(job->profile->is_template);
+    EXPECT_EQ(job->profile->parsed_description, nullptr);
+
+    rapidjson::Document description;
+    description.Parse(job->profile->full_json_description().c_str());
+    ASSERT_FALSE(description.HasParseError());
+    EXPECT_STREQ(description["type"].GetString(), "parallel_homogeneous");
+    EXPECT_DOUBLE_EQ(description["cpu"].GetDouble(), 1e12);
+    EXPECT_DOUBLE_EQ(description["com"].GetDouble(), 1e3);
+    EXPECT_FALSE(description.HasMember("template"));
+
+    delete workload;
+}
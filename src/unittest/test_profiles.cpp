@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../profiles.hpp"
+
+// Builds profiles containing two delay profiles
+static Profiles * create_profiles(bool compact_tombstones)
+{
+    Profiles * profiles = new Profiles;
+    profiles->set_compact_tombstones(compact_tombstones);
+
+    ProfilePtr delay = Profile::from_json("delay", R"({"type": "delay", "delay": 10})");
+    profiles->add_profile("delay", delay);
+    ProfilePtr other_delay = Profile::from_json("other_delay", R"({"type": "delay", "delay": 20})");
+    profiles->add_profile("other_delay", other_delay);
+    return profiles;
+}
+
+// Removed profiles still exist but can no longer be accessed, whether tombstones are compacted or not
+static void check_removal(bool compact_tombstones)
+{
+    Profiles * profiles = create_profiles(compact_tombstones);
+    profiles->remove_profile("delay");
+
+    EXPECT_TRUE(profiles->exists("delay"));
+    EXPECT_FALSE(profiles->exists("unknown"));
+    EXPECT_DEATH(profiles->at("delay"), "no longer accessible");
+    EXPECT_DEATH(profiles->at("unknown"), "does not exist");
+    EXPECT_EQ(profiles->nb_profiles(), 2);
+    EXPECT_EQ(profiles->profiles().count("delay"), compact_tombstones ? 0u : 1u);
+
+    // Other profiles are unaffected
+    EXPECT_EQ(profiles->at("other_delay")->name, "other_delay");
+
+    // Removing a profile twice does nothing, and unknown profiles cannot be removed
+    profiles->remove_profile("delay");
+    EXPECT_TRUE(profiles->exists("delay"));
+    EXPECT_DEATH(profiles->remove_profile("unknown"), "never existed");
+
+    // Names of removed profiles cannot be reused
+    ProfilePtr delay = Profile::from_json("delay", R"({"type": "delay", "delay": 5})");
+    EXPECT_DEATH(profiles->add_profile("delay", delay), "already exists");
+
+    delete profiles;
+}
+
+TEST(profiles, remove_with_tombstones)
+{
+    check_removal(false);
+}
+
+TEST(profiles, remove_with_compacted_tombstones)
+{
+    check_removal(true);
+}
+
+TEST(profiles, remove_unreferenced_with_compacted_tombstones)
+{
+    Profiles * profiles = create_profiles(true);
+    ProfilePtr used_profile = profiles->at("other_delay");
+    profiles->remove_unreferenced_profiles();
+
+    EXPECT_TRUE(profiles->exists("delay"));
+    EXPECT_DEATH(profiles->at("delay"), "no longer accessible");
+    EXPECT_EQ(profiles->at("other_delay"), used_profile);
+    EXPECT_EQ(profiles->profiles().size(), 1u);
+    EXPECT_EQ(profiles->nb_profiles(), 2);
+
+    // Profiles that are no longer used can be removed later on
+    used_profile = nullptr;
+    profiles->remove_unreferenced_profiles();
+    EXPECT_TRUE(profiles->profiles().empty());
+    EXPECT_EQ(profiles->nb_profiles(), 2);
+
+    delete profiles;
+}
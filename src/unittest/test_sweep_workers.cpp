@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../sweep.hpp"
+
+TEST(sweep_workers, parse)
+{
+    auto workers = sweep_workers_from_json(R"([
+        {"socket_endpoint": "tcp://localhost:28001", "export_prefix": "out/easy", "sched_config": {"variant": "easy"}},
+        {"redis_prefix": "fcfs", "sched_config": "{\"variant\": \"fcfs\"}"},
+        {}
+    ])");
+
+    ASSERT_EQ(workers.size(), 3u);
+
+    EXPECT_EQ(workers[0].socket_endpoint, "tcp://localhost:28001");
+    EXPECT_EQ(workers[0].export_prefix, "out/easy");
+    EXPECT_EQ(workers[0].redis_prefix, "");
+    EXPECT_EQ(workers[0].sched_config, R"({"variant":"easy"})"); // Objects are serialized
+
+    EXPECT_EQ(workers[1].socket_endpoint, "");
+    EXPECT_EQ(workers[1].export_prefix, "");
+    EXPECT_EQ(workers[1].redis_prefix, "fcfs");
+    EXPECT_EQ(workers[1].sched_config, R"({"variant": "fcfs"})"); // Strings are kept as is
+
+    // Empty parameters are derived from the command-line ones later on
+    EXPECT_EQ(workers[2].socket_endpoint, "");
+    EXPECT_EQ(workers[2].export_prefix, "");
+    EXPECT_EQ(workers[2].redis_prefix, "");
+    EXPECT_EQ(workers[2].sched_config, "");
+}
+
+TEST(sweep_workers, invalid_descriptions)
+{
+    const std::vector<std::string> invalid_descriptions = {
+        "",                                                  // Not JSON
+        R"({"socket_endpoint": "tcp://localhost:28001"})",   // Not an array
+        "[]",                                                // Empty array
+        "[42]",                                              // Worker is not an object
+        R"([{"export_prefix": 42}])",                        // Value is not a string
+        R"([{"unknown": "value"}])",                         // Unknown key
+    };
+
+    for (const auto & description : invalid_descriptions)
+    {
+        EXPECT_THROW(sweep_workers_from_json(description), std::runtime_error) << "description: " << description;
+    }
+}
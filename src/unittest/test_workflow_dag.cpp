@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../workflow.hpp"
+
+// Builds the diamond a -> {b, c} -> d, plus an isolated task e
+static void build_diamond(Workflow & workflow)
+{
+    int a = workflow.add_task(1, 10, "a");
+    int b = workflow.add_task(2, 20, "b");
+    int c = workflow.add_task(1, 5, "c");
+    int d = workflow.add_task(4, 1, "d");
+    workflow.add_task(1, 1, "e");
+
+    workflow.add_edge(a, b);
+    workflow.add_edge(a, c);
+    workflow.add_edge(b, d);
+    workflow.add_edge(c, d);
+    workflow.add_edge(a, b); // Duplicated edges are ignored
+    workflow.build_dag();
+}
+
+TEST(workflow_dag, csr)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    EXPECT_EQ(workflow.nb_tasks(), 5);
+    EXPECT_EQ(workflow.get_task_index("d"), 3);
+    EXPECT_EQ(workflow.children_indexes.size(), 4u);
+
+    ASSERT_EQ(workflow.nb_children(0), 2);
+    EXPECT_EQ(workflow.children(0)[0], 1);
+    EXPECT_EQ(workflow.children(0)[1], 2);
+    EXPECT_EQ(workflow.nb_children(3), 0);
+    EXPECT_EQ(workflow.nb_children(4), 0);
+
+    EXPECT_EQ(workflow.nb_parents, std::vector<int>({0, 1, 1, 2, 0}));
+    EXPECT_EQ(workflow.get_source_tasks(), std::vector<int>({0, 4}));
+    EXPECT_EQ(workflow.get_sink_tasks(), std::vector<int>({3, 4}));
+}
+
+TEST(workflow_dag, depth)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    EXPECT_EQ(workflow.tasks[0].depth, 0);
+    EXPECT_EQ(workflow.tasks[1].depth, 1);
+    EXPECT_EQ(workflow.tasks[2].depth, 1);
+    EXPECT_EQ(workflow.tasks[3].depth, 2);
+    EXPECT_EQ(workflow.tasks[4].depth, 0);
+    EXPECT_EQ(workflow.get_maximum_depth(), 2);
+}
+
+TEST(workflow_dag, ready_queue_fifo)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    WorkflowReadyQueue queue(&workflow, WorkflowTaskOrder::FIFO);
+    EXPECT_TRUE(queue.empty());
+    queue.push(3);
+    queue.push(0);
+    queue.push(2);
+    EXPECT_EQ(queue.size(), 3u);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_EQ(queue.pop(), 0);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(workflow_dag, ready_queue_depth)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    WorkflowReadyQueue queue(&workflow, WorkflowTaskOrder::DEPTH);
+    queue.push(3);
+    queue.push(2);
+    queue.push(4);
+    queue.push(1);
+    EXPECT_EQ(queue.pop(), 4);
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(workflow_dag, levels)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    EXPECT_DOUBLE_EQ(workflow.tasks[0].top_level, 0);
+    EXPECT_DOUBLE_EQ(workflow.tasks[2].top_level, 10);
+    EXPECT_DOUBLE_EQ(workflow.tasks[3].top_level, 30);
+    EXPECT_DOUBLE_EQ(workflow.tasks[0].bottom_level, 31);
+    EXPECT_DOUBLE_EQ(workflow.tasks[1].bottom_level, 21);
+    EXPECT_DOUBLE_EQ(workflow.tasks[2].bottom_level, 6);
+    EXPECT_DOUBLE_EQ(workflow.tasks[3].bottom_level, 1);
+    EXPECT_DOUBLE_EQ(workflow.tasks[4].bottom_level, 1);
+    EXPECT_DOUBLE_EQ(workflow.critical_path_length, 31);
+}
+
+TEST(workflow_dag, ready_queue_critical_path)
+{
+    Workflow workflow("w");
+    build_diamond(workflow);
+
+    WorkflowReadyQueue queue(&workflow, WorkflowTaskOrder::CRITICAL_PATH);
+    queue.push(4);
+    queue.push(2);
+    queue.push(3);
+    queue.push(1);
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_EQ(queue.pop(), 4);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(workflow_dag, task_orders)
+{
+    EXPECT_EQ(workflow_task_order_from_string("fifo"), WorkflowTaskOrder::FIFO);
+    EXPECT_EQ(workflow_task_order_from_string("depth"), WorkflowTaskOrder::DEPTH);
+    EXPECT_EQ(workflow_task_order_from_string("critical-path"), WorkflowTaskOrder::CRITICAL_PATH);
+    EXPECT_EQ(workflow_task_order_to_string(WorkflowTaskOrder::DEPTH), "depth");
+    EXPECT_EQ(workflow_task_order_to_string(WorkflowTaskOrder::CRITICAL_PATH), "critical-path");
+    EXPECT_THROW(workflow_task_order_from_string("lifo"), std::runtime_error);
+}
+
+// Writes some content into a new temporary file, and returns the file name
+static std::string write_temporary_file(const std::string & content)
+{
+    // A unique file name avoids clashes between concurrent runs of the test
+    char filename[] = "/tmp/test_workflow_dag_XXXXXX";
+    int fd = mkstemp(filename);
+    EXPECT_NE(fd, -1) << "Could not create a temporary file";
+    close(fd);
+
+    std::ofstream f(filename);
+    f << content;
+    return filename;
+}
+
+TEST(workflow_dag, load_from_xml)
+{
+    const std::string filename = write_temporary_file(R"(<?xml version="1.0" encoding="UTF-8"?>
+<!-- generated: 2 <jobs> & a forward reference -->
+<!DOCTYPE adag [ <!ENTITY unused "x"> ]>
+<adag xmlns="http://pegasus.isi.edu/schema/DAX" version='2.1' count="1" index="0">
+  <child ref="ID01"><parent ref='ID&amp;00'/></child>
+  <job id='ID&amp;00' namespace="ns" name="a" runtime="12.5" num_procs="4">
+    <uses file="in&lt;put&#x41;" link="input" size="10"/>
+  </job>
+  <job id="ID01" name="b" runtime="3"><![CDATA[ <job id="fake"/> ]]></job>
+  <job id="ID02" name="c" runtime="1" num_procs="0"/>
+  <child ref="ID02">
+    <parent ref="ID01"/>
+    <parent ref="ID&amp;00"/>
+  </child>
+</adag>
+)");
+
+    Workflow workflow("w");
+    workflow.load_from_xml(filename);
+
+    ASSERT_EQ(workflow.nb_tasks(), 3);
+    EXPECT_EQ(workflow.tasks[0].id, "ID&00");
+    EXPECT_EQ(workflow.tasks[0].num_procs, 4);
+    EXPECT_DOUBLE_EQ(workflow.tasks[0].execution_time, 12.5);
+    EXPECT_EQ(workflow.tasks[1].num_procs, 1);
+    EXPECT_EQ(workflow.tasks[2].num_procs, 1);
+
+    EXPECT_EQ(workflow.nb_parents, std::vector<int>({0, 1, 2}));
+    EXPECT_EQ(workflow.children_indexes, std::vector<int>({1, 2, 2}));
+    EXPECT_EQ(workflow.get_maximum_depth(), 2);
+
+    int remove_ret = remove(filename.c_str());
+    EXPECT_EQ(remove_ret, 0) << "Could not remove file " << filename;
+}
+
+TEST(workflow_dag, load_from_xml_errors)
+{
+    // Errors are reported with exceptions, so that workflows can be loaded from several threads
+    const std::vector<std::string> invalid_contents = {
+        R"(<adag><job id="a" runtime="1"></adag>)", // Invalid XML
+        R"(<adag><job id="a" runtime="1"/><job id="a" runtime="2"/></adag>)", // Duplicated task id
+        R"(<adag><job id="a" runtime="1"/><child ref="a"><parent ref="b"/></child></adag>)", // Unknown task id
+        R"(<adag><job id="a" runtime="1"/><job id="b" runtime="1"/>
+             <child ref="a"><parent ref="b"/></child><child ref="b"><parent ref="a"/></child></adag>)", // Cycle
+    };
+
+    for (const std::string & content : invalid_contents)
+    {
+        const std::string filename = write_temporary_file(content);
+        Workflow workflow("w");
+        EXPECT_THROW(workflow.load_from_xml(filename), std::runtime_error) << content;
+        remove(filename.c_str());
+    }
+}
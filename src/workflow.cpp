@@ -5,16 +5,20 @@
 
 #include "workflow.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <stdexcept>
 #include <streambuf>
 
+#include "pugixml.hpp"
+
 #include "context.hpp"
 #include "jobs.hpp"
 #include "profiles.hpp"
 #include "jobs_execution.hpp"
 
 using namespace std;
-using namespace pugi;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(workflow, "workflow"); //!< Logging
 
@@ -33,76 +37,51 @@ Workflow::~Workflow()
 
 void Workflow::load_from_xml(const std::string &xml_filename)
 {
-    XBT_INFO("Loading XML workflow '%s'...", xml_filename.c_str());
-
-    // XML document creation
-    xml_parse_result result = dax_tree.load_file(xml_filename.c_str());
-    (void) result; // Avoids a warning if assertions are ignored
-    xbt_assert(result, "Invalid XML file");
-
-    xml_node dag = dax_tree.child("adag");
-    for (xml_node job = dag.child("job"); job; job = job.next_sibling("job"))
     {
-        // Parse the number of processors, if any
-        int num_procs = 1;
-        if (job.attribute("num_procs"))
+        // The XML document only lives during the parsing: it is freed as soon as tasks and edges are built
+        pugi::xml_document dax_tree;
+        pugi::xml_parse_result result = dax_tree.load_file(xml_filename.c_str());
+        if (!result)
         {
-            num_procs = static_cast<int>(strtol(job.attribute("num_procs").value(),NULL,10));
+            throw std::runtime_error("Invalid XML file '" + xml_filename + "': " + result.description() +
+                                     " (at offset " + std::to_string(result.offset) + ")");
         }
-        if (num_procs <= 0)
+
+        pugi::xml_node dag = dax_tree.child("adag");
+        for (pugi::xml_node job = dag.child("job"); job; job = job.next_sibling("job"))
         {
-            num_procs = 1;
+            // Parse the number of processors, if any
+            int num_procs = 1;
+            if (job.attribute("num_procs"))
+            {
+                num_procs = static_cast<int>(strtol(job.attribute("num_procs").value(),NULL,10));
+            }
+            if (num_procs <= 0)
+            {
+                num_procs = 1;
+            }
+
+            add_task(num_procs, strtod(job.attribute("runtime").value(),NULL), job.attribute("id").value());
         }
 
-        Task *task = new Task (num_procs, strtod(job.attribute("runtime").value(),NULL),
-                               job.attribute("id").value());
-        add_task(*task);
-    }
-
-    for (xml_node edge_bottom = dag.child("child"); edge_bottom;
-         edge_bottom = edge_bottom.next_sibling("child"))
-    {
-        Task *dest = get_task(edge_bottom.attribute("ref").value());
-
-        for (xml_node edge_top = edge_bottom.child("parent"); edge_top;
-             edge_top = edge_top.next_sibling("parent"))
+        for (pugi::xml_node edge_bottom = dag.child("child"); edge_bottom;
+             edge_bottom = edge_bottom.next_sibling("child"))
         {
-            Task *source = get_task(edge_top.attribute("ref").value());
-
-            //std::cout << "Test : " << source->id << " --> " << dest->id << std::endl;
-            add_edge(*source,*dest);
+            int dest = get_task_index(edge_bottom.attribute("ref").value());
+
+            for (pugi::xml_node edge_top = edge_bottom.child("parent"); edge_top;
+                 edge_top = edge_top.next_sibling("parent"))
+            {
+                int source = get_task_index(edge_top.attribute("ref").value());
+                add_edge(source, dest);
+            }
         }
     }
 
-    /* Testing things
-    std::cout << get_source_tasks().size() << std::endl;
-
-    Task *stuff1 = get_task("ID00017");
-    Task *stuff2 = get_task("ID00018");
-
-    std::cout << stuff1->execution_time << std::endl;
+    build_dag();
 
-    add_edge(*stuff1,*stuff2);
-
-    std::cout << get_sink_tasks().size() << std::endl;
-    */
-
-    /*
-    // Let's try to read the number of machines in the XML document
-    xbt_assert(doc.HasMember("nb_res"), "Invalid XML file '%s': the 'nb_res' field is missing", xml_filename.c_str());
-    const Value & nb_res_node = doc["nb_res"];
-    xbt_assert(nb_res_node.IsInt(), "Invalid XML file '%s': the 'nb_res' field is not an integer", xml_filename.c_str());
-    nb_machines = nb_res_node.GetInt();
-    xbt_assert(nb_machines > 0, "Invalid XML file '%s': the value of the 'nb_res' field is invalid (%d)",
-               xml_filename.c_str(), nb_machines);
-
-    jobs->load_from_xml(doc, xml_filename);
-    profiles->load_from_xml(doc, xml_filename);
-    */
-    XBT_INFO("XML workflow parsed sucessfully.");
-    XBT_INFO("Checking workflow validity...");
-    check_validity();
-    XBT_INFO("Workflow seems to be valid.");
+    // Task ids are only needed to resolve the edges of the file
+    std::unordered_map<std::string, int>().swap(_task_indexes);
 
     this->filename = xml_filename;
 }
@@ -114,77 +93,169 @@ void Workflow::check_validity()
     return;
 }
 
-void Workflow::add_task(Task &task)
+int Workflow::add_task(int num_procs, double execution_time, const std::string & id)
 {
-    this->tasks[task.id] = &task;
+    const int index = static_cast<int>(tasks.size());
+    if (!_task_indexes.emplace(id, index).second)
+    {
+        throw std::runtime_error("Invalid workflow '" + name + "': task id '" + id + "' already exists");
+    }
+
+    tasks.emplace_back(num_procs, execution_time, id);
+    return index;
+}
+
+int Workflow::get_task_index(const std::string & id) const
+{
+    auto it = _task_indexes.find(id);
+    if (it == _task_indexes.end())
+    {
+        throw std::runtime_error("Invalid workflow '" + name + "': task id '" + id + "' does not exist");
+    }
+    return it->second;
 }
 
-Task * Workflow::get_task(std::string id)
+void Workflow::add_edge(int parent, int child)
 {
-    xbt_assert(this->tasks.count(id) == 1,
-               "Invalid Workflow::get_task call: id '%s' does not exist", id.c_str());
-    return this->tasks[id];
+    xbt_assert(parent >= 0 && parent < nb_tasks() && child >= 0 && child < nb_tasks(),
+               "Invalid Workflow::add_edge call: (%d, %d) is not an edge between existing tasks", parent, child);
+    _edges.emplace_back(parent, child);
 }
 
-void Workflow::add_edge(Task &parent, Task &child)
+void Workflow::build_dag()
 {
-    if(std::find(child.parents.begin(), child.parents.end(), &parent) != child.parents.end())
+    const int n = nb_tasks();
+
+    // Edges that have already been built are added again, so that build_dag can be called several times
+    for (int parent = 0; parent < static_cast<int>(children_offsets.size()) - 1; ++parent)
     {
-        // Edge already there, no hyperedge
+        for (int i = children_offsets[parent]; i < children_offsets[parent + 1]; ++i)
+        {
+            _edges.emplace_back(parent, children_indexes[i]);
+        }
     }
-    else
+
+    // Sorting edges groups them by parent and puts duplicates side by side (no hyperedge)
+    std::sort(_edges.begin(), _edges.end());
+    _edges.erase(std::unique(_edges.begin(), _edges.end()), _edges.end());
+
+    children_offsets.assign(static_cast<size_t>(n) + 1, 0);
+    children_indexes.resize(_edges.size());
+    nb_parents.assign(static_cast<size_t>(n), 0);
+    for (size_t i = 0; i < _edges.size(); ++i)
     {
-        child.parents.push_back(&parent);
+        children_offsets[static_cast<size_t>(_edges[i].first) + 1]++;
+        children_indexes[i] = _edges[i].second;
+        nb_parents[static_cast<size_t>(_edges[i].second)]++;
     }
+    for (int task = 0; task < n; ++task)
+    {
+        children_offsets[static_cast<size_t>(task) + 1] += children_offsets[static_cast<size_t>(task)];
+    }
+    _edges.clear();
+    _edges.shrink_to_fit();
+
+    // The depth and top level of the tasks are computed in topological order
+    std::vector<int> nb_unvisited_parents = nb_parents;
+    std::vector<int> to_visit = get_source_tasks();
+    std::vector<int> topological_order;
+    topological_order.reserve(static_cast<size_t>(n));
+    for (auto & task : tasks)
+    {
+        task.depth = 0;
+        task.top_level = 0;
+    }
+    while (!to_visit.empty())
+    {
+        int task = to_visit.back();
+        to_visit.pop_back();
+        topological_order.push_back(task);
+        const Task & parent = tasks[static_cast<size_t>(task)];
 
-    if(std::find(parent.children.begin(), parent.children.end(), &parent) != parent.children.end())
+        const int * task_children = children(task);
+        for (int i = 0; i < nb_children(task); ++i)
+        {
+            Task & child = tasks[static_cast<size_t>(task_children[i])];
+            child.depth = std::max(child.depth, parent.depth + 1);
+            child.top_level = std::max(child.top_level, parent.top_level + parent.execution_time);
+            if (--nb_unvisited_parents[static_cast<size_t>(task_children[i])] == 0)
+            {
+                to_visit.push_back(task_children[i]);
+            }
+        }
+    }
+    if (static_cast<int>(topological_order.size()) != n)
     {
-        // Edge already there, no hyperedge
+        throw std::runtime_error("Invalid workflow '" + name + "': its tasks dependencies contain a cycle");
     }
-    else
+
+    // The bottom level of the tasks is computed in reverse topological order
+    critical_path_length = 0;
+    for (auto it = topological_order.rbegin(); it != topological_order.rend(); ++it)
     {
-        parent.children.push_back(&child);
+        Task & task = tasks[static_cast<size_t>(*it)];
+        double longest_child_bottom_level = 0;
+
+        const int * task_children = children(*it);
+        for (int i = 0; i < nb_children(*it); ++i)
+        {
+            longest_child_bottom_level = std::max(longest_child_bottom_level,
+                                                  tasks[static_cast<size_t>(task_children[i])].bottom_level);
+        }
+
+        task.bottom_level = task.execution_time + longest_child_bottom_level;
+        critical_path_length = std::max(critical_path_length, task.bottom_level);
     }
 }
 
+int Workflow::nb_tasks() const
+{
+    return static_cast<int>(tasks.size());
+}
+
+const int * Workflow::children(int task) const
+{
+    return children_indexes.data() + children_offsets[static_cast<size_t>(task)];
+}
 
-std::vector<Task *> Workflow::get_source_tasks()
+int Workflow::nb_children(int task) const
 {
-    std::vector<Task *> task_list;
-    for(std::map<std::string, Task *>::iterator it = this->tasks.begin(); it != this->tasks.end(); ++it)
+    return children_offsets[static_cast<size_t>(task) + 1] - children_offsets[static_cast<size_t>(task)];
+}
+
+std::vector<int> Workflow::get_source_tasks() const
+{
+    std::vector<int> task_list;
+    for (int task = 0; task < nb_tasks(); ++task)
     {
-        if ((it->second)->parents.empty())
+        if (nb_parents[static_cast<size_t>(task)] == 0)
         {
-            task_list.push_back(it->second);
+            task_list.push_back(task);
         }
     }
     return task_list;
 }
 
-std::vector<Task *> Workflow::get_sink_tasks()
+std::vector<int> Workflow::get_sink_tasks() const
 {
-    std::vector<Task *> task_list;
-    for(std::map<std::string, Task *>::iterator it = this->tasks.begin(); it != this->tasks.end(); ++it)
+    std::vector<int> task_list;
+    for (int task = 0; task < nb_tasks(); ++task)
     {
-        if ((it->second)->children.empty())
+        if (nb_children(task) == 0)
         {
-            task_list.push_back(it->second);
+            task_list.push_back(task);
         }
     }
     return task_list;
 }
 
 
-int Workflow::get_maximum_depth()
+int Workflow::get_maximum_depth() const
 {
     int max_depth = -1;
-    std::vector<Task *> sinks = this->get_sink_tasks();
-    for (std::vector<Task*>::iterator it = sinks.begin(); it != sinks.end(); ++it)
+    for (int task : get_sink_tasks())
     {
-        if ((max_depth == -1) || ((*it)->depth > max_depth))
-        {
-            max_depth = (*it)->depth;
-        }
+        max_depth = std::max(max_depth, tasks[static_cast<size_t>(task)].depth);
     }
     return max_depth;
 }
@@ -198,17 +269,91 @@ Task::Task(const int num_procs, const double execution_time, const std::string &
 {
 }
 
-Task::~Task()
+
+WorkflowTaskOrder workflow_task_order_from_string(const std::string & str)
+{
+    if (str == "fifo")
+    {
+        return WorkflowTaskOrder::FIFO;
+    }
+    else if (str == "depth")
+    {
+        return WorkflowTaskOrder::DEPTH;
+    }
+    else if (str == "critical-path")
+    {
+        return WorkflowTaskOrder::CRITICAL_PATH;
+    }
+    else
+    {
+        throw std::runtime_error("Invalid workflow task order string");
+    }
+}
+
+std::string workflow_task_order_to_string(WorkflowTaskOrder order)
+{
+    switch (order)
+    {
+    case WorkflowTaskOrder::FIFO:
+        return "fifo";
+    case WorkflowTaskOrder::DEPTH:
+        return "depth";
+    case WorkflowTaskOrder::CRITICAL_PATH:
+        return "critical-path";
+    }
+
+    xbt_die("Unknown workflow task order");
+}
+
+
+WorkflowReadyQueue::WorkflowReadyQueue(const Workflow * workflow, WorkflowTaskOrder order) :
+    _workflow(workflow),
+    _order(order)
 {
-    this->parents.clear();
-    this->children.clear();
 }
 
+void WorkflowReadyQueue::push(int task)
+{
+    switch (_order)
+    {
+    case WorkflowTaskOrder::FIFO:
+        _fifo.push_back(task);
+        break;
+    case WorkflowTaskOrder::DEPTH:
+        // The heap pops its greatest element first: Smallest depths, then smallest indexes
+        _heap.emplace(-static_cast<double>(_workflow->tasks[static_cast<size_t>(task)].depth), -task);
+        break;
+    case WorkflowTaskOrder::CRITICAL_PATH:
+        // Largest bottom levels first, then smallest indexes
+        _heap.emplace(_workflow->tasks[static_cast<size_t>(task)].bottom_level, -task);
+        break;
+    }
+}
+
+int WorkflowReadyQueue::pop()
+{
+    xbt_assert(!empty(), "Invalid WorkflowReadyQueue::pop call: the queue is empty");
+
+    if (_order == WorkflowTaskOrder::FIFO)
+    {
+        int task = _fifo.front();
+        _fifo.pop_front();
+        return task;
+    }
+
+    int task = -_heap.top().second;
+    _heap.pop();
+    return task;
+}
 
+bool WorkflowReadyQueue::empty() const
+{
+    return _fifo.empty() && _heap.empty();
+}
 
-void Task::set_batsim_job(JobPtr batsim_job)
+size_t WorkflowReadyQueue::size() const
 {
-    this->batsim_job = batsim_job;
+    return _fifo.size() + _heap.size();
 }
 
 
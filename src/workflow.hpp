@@ -8,18 +8,53 @@
 #include <string>
 #include <vector>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
 
-#include "pointers.hpp"
-#include "pugixml.hpp"
+/**
+ * @brief A workflow Task is some attributes. Its parents and children are stored by its Workflow.
+ */
+class Task
+{
+public:
+    /**
+     * @brief Constructor
+     * @param[in] num_procs The number of processors needed for the task
+     * @param[in] execution_time The execution time of the task
+     * @param[in] id The task id
+     */
+    Task(const int num_procs, const double execution_time, const std::string & id);
 
-struct Job;
-class Task;
+    /**
+     * @brief Task cannot be copied.
+     * @param[in] other Another instance
+     */
+    Task(const Task & other) = delete;
+
+    /**
+     * @brief Tasks can be moved (they are stored contiguously by their Workflow)
+     * @param[in] other Another instance
+     */
+    Task(Task && other) = default;
+
+public:
+    int num_procs; //!< The number of processors needed for the tas
+    double execution_time; //!< The execution time of the task
+    std::string id; //!< The task id (in the DAX file)
+    int depth = 0; //!< The task's top level
+    double top_level = 0; //!< The longest execution time of a path from a source task to this task (excluded)
+    double bottom_level = 0; //!< The longest execution time of a path from this task (included) to a sink task
+};
 
 /**
  * @brief A workflow is a DAG of tasks, with points to
  *        source tasks and sink tasks
+ * @details Tasks are identified by their integer index in the Workflow (in the order they have been added).
+ *          Once built (see build_dag), the DAG is stored in the compressed sparse row (CSR) format.
  */
 class Workflow
 {
@@ -43,7 +78,11 @@ public:
 
     /**
      * @brief Loads a complete workflow from an XML filename
+     * @details The XML document tree is freed once tasks and edges are built.
+     *          This function does not log anything and reports errors with exceptions,
+     *          so that different workflows can be loaded concurrently from different threads.
      * @param[in] xml_filename The name of the XML file
+     * @throw std::runtime_error if the file cannot be parsed or does not describe a valid DAG
      */
     void load_from_xml(const std::string & xml_filename);
 
@@ -54,94 +93,159 @@ public:
 
     /**
      * @brief Adds a task to the workflow
-     * @param[in] task The task to add into the Workflow
+     * @param[in] num_procs The number of processors needed for the task
+     * @param[in] execution_time The execution time of the task
+     * @param[in] id The task id
+     * @return The index of the new task
+     * @throw std::runtime_error if a task with the same id already exists
      */
-    void add_task(Task &task);
+    int add_task(int num_procs, double execution_time, const std::string & id);
 
     /**
-     * @brief Gets a task based on its ID
+     * @brief Gets the index of a task based on its ID
+     * @details Task ids are forgotten once the workflow is loaded from XML, as they are only needed to read its edges.
      * @param[in] id The task id
-     * @return The task corresponding to the given id
+     * @return The index of the task corresponding to the given id
+     * @throw std::runtime_error if no task has this id
      */
-    Task *get_task(std::string id);
+    int get_task_index(const std::string & id) const;
 
     /**
      * @brief Add an edge between a parent task and a child task
-     * @param[in,out] parent The parent task
-     * @param[in,out] child The child task
+     * @details Edges are only taken into account once build_dag is called. Duplicated edges are ignored.
+     * @param[in] parent The index of the parent task
+     * @param[in] child The index of the child task
+     */
+    void add_edge(int parent, int child);
+
+    /**
+     * @brief Builds the DAG (in CSR format) from the added edges, and computes the depth,
+     *        the top level and the bottom level of the tasks as well as the critical path length
+     * @throw std::runtime_error if the edges form a cycle
      */
-    void add_edge(Task &parent, Task &child);
+    void build_dag();
+
+    /**
+     * @brief Gets the number of tasks
+     * @return The number of tasks
+     */
+    int nb_tasks() const;
+
+    /**
+     * @brief Gets the children of a task
+     * @param[in] task The task index
+     * @return A pointer to the indexes of the children, whose number is nb_children(task)
+     */
+    const int * children(int task) const;
+
+    /**
+     * @brief Gets the number of children of a task
+     * @param[in] task The task index
+     * @return The number of children of the task
+     */
+    int nb_children(int task) const;
 
     /**
      * @brief Gets source tasks
-     * @return The source tasks
+     * @return The indexes of the source tasks
      */
-    std::vector<Task *> get_source_tasks();
+    std::vector<int> get_source_tasks() const;
 
     /**
      * @brief Gets the sink tasks
-     * @return The sink tasks
+     * @return The indexes of the sink tasks
      */
-    std::vector<Task *> get_sink_tasks();
+    std::vector<int> get_sink_tasks() const;
 
     /**
      * @brief Gets the maximum depth
      * @return The maximum depth
      */
-    int get_maximum_depth();
+    int get_maximum_depth() const;
 
 public:
     std::string filename;  //!< The DAX filename
     std::string name; //!< The Workflow name
-    std::map<std::string, Task *> tasks; //!< Hashmap of all tasks
+    std::vector<Task> tasks; //!< All tasks, by index
+    std::vector<int> nb_parents; //!< The number of parents of each task
+    std::vector<int> children_offsets; //!< The children of task i are children_indexes[children_offsets[i]:children_offsets[i+1]]
+    std::vector<int> children_indexes; //!< The children of all tasks, grouped by parent task
     double start_time = -1; //!< Workflow start time
+    double critical_path_length = 0; //!< The longest execution time of a path of the DAG (the largest bottom level)
 
 private:
-    pugi::xml_document dax_tree; //!< The DAX tree
+    std::unordered_map<std::string, int> _task_indexes; //!< Associates task ids with their index
+    std::vector<std::pair<int, int>> _edges; //!< The (parent, child) edges added since the last build_dag call
 };
 
 /**
- * @brief A workflow Task is some attributes, pointers to parent tasks,
- *        and pointers to children tasks.
+ * @brief Enumerates the orders in which the ready tasks of a workflow are submitted
  */
-class Task
+enum class WorkflowTaskOrder
+{
+    FIFO        //!< Tasks are submitted in the order they became ready
+    ,DEPTH      //!< Tasks of smallest depth (top level) are submitted first, then by index
+    ,CRITICAL_PATH //!< Tasks of largest bottom level are submitted first, then by index
+};
+
+/**
+ * @brief Returns the WorkflowTaskOrder corresponding to a string
+ * @param[in] str The string ("fifo", "depth" or "critical-path")
+ * @return The matching WorkflowTaskOrder. An exception is thrown if str is invalid.
+ */
+WorkflowTaskOrder workflow_task_order_from_string(const std::string & str);
+
+/**
+ * @brief Returns a string corresponding to a given WorkflowTaskOrder
+ * @param[in] order The WorkflowTaskOrder
+ * @return A string corresponding to the given WorkflowTaskOrder
+ */
+std::string workflow_task_order_to_string(WorkflowTaskOrder order);
+
+/**
+ * @brief The ready tasks of a workflow, that are popped in a given WorkflowTaskOrder
+ * @details Operations are in O(1) in FIFO order, in O(log(size)) otherwise.
+ */
+class WorkflowReadyQueue
 {
 public:
     /**
-     * @brief Constructor
-     * @param[in] num_procs The number of processors needed for the task
-     * @param[in] execution_time The execution time of the task
-     * @param[in] id The task id
+     * @brief Builds an empty WorkflowReadyQueue
+     * @param[in] workflow The workflow whose tasks are queued
+     * @param[in] order The order in which tasks are popped
      */
-    Task(const int num_procs, const double execution_time, const std::string & id);
+    WorkflowReadyQueue(const Workflow * workflow, WorkflowTaskOrder order);
 
     /**
-     * @brief Task cannot be copied.
-     * @param[in] other Another instance
+     * @brief Adds a ready task
+     * @param[in] task The task index
      */
-    Task(const Task & other) = delete;
+    void push(int task);
 
     /**
-     * @brief Destructor
+     * @brief Removes the next task to submit
+     * @return The index of the removed task
+     * @pre The queue is not empty
      */
-    ~Task();
+    int pop();
 
     /**
-     * @brief Associates a Batsim Job to the task
-     * @param[in] batsim_job The Batsim Job
+     * @brief Returns whether the queue is empty
+     * @return Whether the queue is empty
      */
-    void set_batsim_job(JobPtr batsim_job);
+    bool empty() const;
 
+    /**
+     * @brief Returns the number of tasks in the queue
+     * @return The number of tasks in the queue
+     */
+    size_t size() const;
 
-public:
-    int num_procs; //!< The number of processors needed for the tas
-    double execution_time; //!< The execution time of the task
-    std::string id; //!< The task id
-    JobPtr batsim_job = nullptr; //!< The batsim job created for this task
-    std::vector<Task *> parents; //!< The parent
-    std::vector<Task *> children; //!< The children
-    int nb_parent_completed = 0; //!< The number of preceding tasks completed
-    int depth = 0; //!< The task's top level
+private:
+    const Workflow * _workflow; //!< The workflow whose tasks are queued
+    WorkflowTaskOrder _order; //!< The order in which tasks are popped
+    std::deque<int> _fifo; //!< The queued tasks in FIFO order
+    std::priority_queue<std::pair<double, int>> _heap; //!< The queued tasks in other orders, as (priority, -index) pairs
 };
 
 
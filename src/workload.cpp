@@ -156,9 +156,9 @@ void Workload::check_validity()
 void Workload::check_single_job_validity(const JobPtr job)
 {
     //TODO This is already checked during creation of the job in Job::from_json
-    xbt_assert(profiles->exists(job->profile->name),
+    xbt_assert(profiles->exists(job->profile->registered_name()),
                "Invalid job %s: the associated profile '%s' does not exist",
-               job->id.to_cstring(), job->profile->name.c_str());
+               job->id.to_cstring(), job->profile->registered_name().c_str());
 
     if (job->profile->type == ProfileType::PARALLEL)
     {
@@ -259,9 +259,19 @@ void Workloads::insert_workload(const std::string &workload_name, Workload *work
     xbt_assert(!exists(workload->name), "workload '%s' already exists", workload->name.c_str());
 
     workload->name = workload_name;
+    workload->profiles->set_compact_tombstones(_compact_profile_tombstones);
     _workloads[workload_name] = workload;
 }
 
+void Workloads::set_compact_profile_tombstones(bool compact_profile_tombstones)
+{
+    _compact_profile_tombstones = compact_profile_tombstones;
+    for (auto & mit : _workloads)
+    {
+        mit.second->profiles->set_compact_tombstones(compact_profile_tombstones);
+    }
+}
+
 bool Workloads::exists(const std::string &workload_name) const
 {
     return _workloads.count(workload_name) == 1;
@@ -299,7 +309,7 @@ bool Workloads::job_profile_is_registered(const JobIdentifier &job_id)
 {
     //TODO this could be improved/simplified
     auto job = at(job_id.workload_name())->jobs->at(job_id);
-    return at(job_id.workload_name())->profiles->exists(job->profile->name);
+    return at(job_id.workload_name())->profiles->exists(job->profile->registered_name());
 }
 
 std::map<std::string, Workload *> &Workloads::workloads()
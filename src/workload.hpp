@@ -220,6 +220,13 @@ public:
     void insert_workload(const std::string & workload_name,
                          Workload * workload);
 
+    /**
+     * @brief Sets whether the profiles of the workloads should compact the tombstones of removed profiles
+     * @details This applies to the current workloads and to the ones inserted afterwards.
+     * @param[in] compact_profile_tombstones Whether the tombstones of removed profiles should be compacted
+     */
+    void set_compact_profile_tombstones(bool compact_profile_tombstones);
+
     /**
      * @brief Checks whether a Workload with the given name exist.
      * @param[in] workload_name The name of the Workload whose existence is checked
@@ -259,4 +266,5 @@ public:
 
 private:
     std::map<std::string, Workload*> _workloads; //!< Associates Workloads with their names
+    bool _compact_profile_tombstones = false; //!< Whether the profiles of the workloads compact the tombstones of removed profiles
 };
@@ -68,16 +68,19 @@ def pytest_generate_tests(metafunc):
 
     # Workloads
     workloads_def = {
+        "branching": "test_branching.json",
         "delay1": "test_one_delay_job.json",
         "delays": "test_delays.json",
         "delaysequences": "test_sequence_delay.json",
         "energymini0": "test_energy_minimal_load0.json",
         "energymini50": "test_energy_minimal_load50.json",
         "energymini100": "test_energy_minimal_load100.json",
+        "executeforms": "test_execute_forms.json",
         "compute1": "test_one_computation_job.json",
         "computetot1": "test_one_computation_job_tot.json",
         "farfuture": "test_long_workload.json",
         "genome": "GENOME.d.351024866.5.dax",
+        "jobmessages": "test_job_messages.json",
         "long": "test_batsim_paper_workload_seed1.json",
         "mixed": "test_various_profile_types.json",
         "samesubmittime": "test_same_submit_time.json",
@@ -180,10 +183,18 @@ def pytest_generate_tests(metafunc):
         metafunc.parametrize('smpi_mapping_workload', generate_workloads(workload_dir, workloads_def, ['smpimapping']))
     if 'long_workload' in metafunc.fixturenames:
         metafunc.parametrize('long_workload', generate_workloads(workload_dir, workloads_def, ['long']))
+    if 'delays_workload' in metafunc.fixturenames:
+        metafunc.parametrize('delays_workload', generate_workloads(workload_dir, workloads_def, ['delays']))
     if 'delaysequences_workload' in metafunc.fixturenames:
         metafunc.parametrize('delaysequences_workload', generate_workloads(workload_dir, workloads_def, ['delaysequences']))
     if 'mixed_workload' in metafunc.fixturenames:
         metafunc.parametrize('mixed_workload', generate_workloads(workload_dir, workloads_def, ['mixed']))
+    if 'job_messages_workload' in metafunc.fixturenames:
+        metafunc.parametrize('job_messages_workload', generate_workloads(workload_dir, workloads_def, ['jobmessages']))
+    if 'branching_workload' in metafunc.fixturenames:
+        metafunc.parametrize('branching_workload', generate_workloads(workload_dir, workloads_def, ['branching']))
+    if 'execute_forms_workload' in metafunc.fixturenames:
+        metafunc.parametrize('execute_forms_workload', generate_workloads(workload_dir, workloads_def, ['executeforms']))
 
     # External Events
     if 'simple_events' in metafunc.fixturenames:
@@ -46,6 +46,11 @@ def gen_batsim_cmd(platform, workload, output_dir, more_flags, is_workload=True)
     else:
         return batcmd
 
+def gen_scripted_sched_cmd(script_filename):
+    '''Returns the command of a scheduler driven by a JSON script (see scripted_sched.py).'''
+    script_dir = os.path.dirname(os.path.realpath(__file__))
+    return f"python3 '{script_dir}/scripted_sched.py' '{script_filename}'"
+
 def write_file(filename, content):
     file = open(filename, "w")
     file.write(content)
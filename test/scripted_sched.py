@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+'''A minimal scheduler driven by a JSON script, for tests that need precise protocol interactions.
+
+Usage: scripted_sched.py <script_file>
+
+Jobs are executed in submission order (FCFS without backfilling) on the first free machines.
+The script is a JSON object with the following optional fields.
+- socket_endpoint: The endpoint to bind (default: tcp://*:28000).
+- nb_resources: The number of machines, for schedulers that do not receive SIMULATION_BEGINS
+  (branches read it from the state snapshot of their simulation_branched notification otherwise).
+- initial_events: Events sent in the first reply, as {"type": ..., "data": ...} objects.
+- timed_events: Events sent at given simulation times, as {"timestamp": ..., "type": ..., "data": ...} objects.
+- after_start: Events sent some time after a job has started, as {job_id: [{"delay": ..., "type": ..., "data": ...}]}.
+- rejected_jobs: The ids of the jobs to reject instead of executing them.
+- execute_data: The EXECUTE_JOB data of some jobs, as {job_id: {"alloc": ..., "mapping": ...}}.
+  Such jobs are executed on their given allocation (string or array form) once it is free.
+- received_events_file: Where the received events are written (as a JSON array) at the end of the simulation.
+- schedulers: A list of scripts. If set, one scheduler process is run per script instead (e.g., for sweeps or branches).
+'''
+import json
+import sys
+
+import zmq
+
+def parse_intervals(intervals):
+    '''Returns the list of machines of an interval set string such as "0-3 5".'''
+    machines = []
+    for interval in intervals.split():
+        bounds = [int(bound) for bound in interval.split('-')]
+        machines.extend(range(bounds[0], bounds[-1] + 1))
+    return machines
+
+def parse_allocation(alloc):
+    '''Returns the list of machines of an allocation, given as a string or as an array of ids and [first, last] intervals.'''
+    if isinstance(alloc, str):
+        return parse_intervals(alloc)
+    machines = []
+    for element in alloc:
+        machines.extend(range(element[0], element[1] + 1) if isinstance(element, list) else [element])
+    return machines
+
+class ScriptedScheduler(object):
+    def __init__(self, script):
+        self.script = script
+        self.nb_resources = script.get('nb_resources', 0)
+        self.free_machines = set(range(self.nb_resources))
+        self.queue = []
+        self.allocations = {}
+        self.pending_events = [dict(e) for e in script.get('timed_events', [])]
+        self.rejected_jobs = set(script.get('rejected_jobs', []))
+        self.received_events = []
+        self.first_reply = True
+
+    def on_event(self, now, event, reply):
+        self.received_events.append(event)
+        data = event['data']
+        if event['type'] == 'SIMULATION_BEGINS':
+            self.nb_resources = data['nb_compute_resources']
+            self.free_machines = set(range(self.nb_resources))
+        elif event['type'] == 'JOB_SUBMITTED':
+            if data['job_id'] in self.rejected_jobs:
+                reply.append({'timestamp': now, 'type': 'REJECT_JOB', 'data': {'job_id': data['job_id']}})
+            else:
+                # Jobs are not described if Redis is enabled or if the scheduler unsubscribed from descriptions
+                self.queue.append((data['job_id'], data['job']['res'] if 'job' in data else 1))
+        elif event['type'] == 'NOTIFY' and data['type'] == 'simulation_branched':
+            # Branches start from the state of the simulation at the branch time
+            if self.nb_resources == 0:
+                self.nb_resources = sum([len(parse_intervals(m)) for m in data['machine_states'].values()])
+            self.allocations = {job_id: parse_intervals(job['alloc']) for job_id, job in data['running_jobs'].items()}
+            self.free_machines = set(range(self.nb_resources)).difference(*self.allocations.values())
+            self.queue = [(job_id, job['res']) for job_id, job in sorted(data['pending_jobs'].items(),
+                          key=lambda item: (item[1]['subtime'], item[0]))]
+        elif event['type'] == 'JOB_COMPLETED':
+            self.free_machines.update(self.allocations.pop(data['job_id'], []))
+
+    def execute_jobs(self, now, reply):
+        while len(self.queue) > 0:
+            job_id, nb_res = self.queue[0]
+            data = dict(self.script.get('execute_data', {}).get(job_id, {}), job_id=job_id)
+            if 'alloc' in data:
+                machines = parse_allocation(data['alloc'])
+                if not self.free_machines.issuperset(machines):
+                    break
+            else:
+                if nb_res > len(self.free_machines):
+                    break
+                machines = sorted(self.free_machines)[:nb_res]
+                data['alloc'] = ' '.join([str(m) for m in machines])
+
+            self.queue.pop(0)
+            self.free_machines.difference_update(machines)
+            self.allocations[job_id] = machines
+            reply.append({'timestamp': now, 'type': 'EXECUTE_JOB', 'data': data})
+
+            for e in self.script.get('after_start', {}).get(job_id, []):
+                self.pending_events.append({'timestamp': now + e['delay'], 'type': e['type'], 'data': e['data']})
+                reply.append({'timestamp': now, 'type': 'CALL_ME_LATER', 'data': {'timestamp': now + e['delay']}})
+
+    def decide(self, message):
+        now = message['now']
+        reply = []
+        if self.first_reply:
+            self.first_reply = False
+            reply.extend([dict(e, timestamp=now) for e in self.script.get('initial_events', [])])
+            for e in self.pending_events:
+                reply.append({'timestamp': now, 'type': 'CALL_ME_LATER', 'data': {'timestamp': e['timestamp']}})
+
+        for event in message['events']:
+            self.on_event(now, event, reply)
+
+        due_events = [e for e in self.pending_events if e['timestamp'] <= now]
+        self.pending_events = [e for e in self.pending_events if e['timestamp'] > now]
+        reply.extend([dict(e, timestamp=now) for e in due_events])
+
+        self.execute_jobs(now, reply)
+        return {'now': now, 'events': reply}
+
+    def run(self):
+        context = zmq.Context()
+        socket = context.socket(zmq.REP)
+        socket.bind(self.script.get('socket_endpoint', 'tcp://*:28000'))
+
+        simulation_ended = False
+        while not simulation_ended:
+            message = json.loads(socket.recv())
+            simulation_ended = any([e['type'] == 'SIMULATION_ENDS' for e in message['events']])
+            socket.send_string(json.dumps(self.decide(message)))
+
+        if 'received_events_file' in self.script:
+            with open(self.script['received_events_file'], 'w') as f:
+                json.dump(self.received_events, f)
+
+def run_schedulers(scripts):
+    '''Runs one scheduler process per script, and returns whether they all succeeded.'''
+    import multiprocessing
+    processes = [multiprocessing.Process(target=ScriptedScheduler(script).run) for script in scripts]
+    for process in processes:
+        process.start()
+    for process in processes:
+        process.join()
+    return all([process.exitcode == 0 for process in processes])
+
+if __name__ == '__main__':
+    with open(sys.argv[1]) as f:
+        script = json.load(f)
+
+    if 'schedulers' in script:
+        sys.exit(0 if run_schedulers(script['schedulers']) else 1)
+    ScriptedScheduler(script).run()
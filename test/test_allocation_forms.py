@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+'''EXECUTE_JOB allocation and mapping forms tests.
+
+These tests check that the array forms of EXECUTE_JOB allocations (resource ids and closed intervals)
+and mappings (dense arrays) are equivalent to their string and object forms.
+'''
+import json
+import pandas as pd
+from helper import *
+
+def test_allocation_forms(cluster_platform, execute_forms_workload):
+    '''Job 1 uses a numeric allocation and a dense mapping that puts two executors on each host,
+    job 2 uses a numeric allocation that mixes ids and intervals, job 3 uses the string form.'''
+    test_name = f'allocationforms-scripted-{cluster_platform.name}-{execute_forms_workload.name}'
+    output_dir, robin_filename, _ = init_instance(test_name)
+
+    script = {
+        'execute_data': {
+            'w0!1': {'alloc': [[10, 11]], 'mapping': [0, 0, 1, 1]},
+            'w0!2': {'alloc': [3, [5, 6], 8]},
+        },
+    }
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    batcmd = gen_batsim_cmd(cluster_platform.filename, execute_forms_workload.filename, output_dir, '')
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=gen_scripted_sched_cmd(script_filename),
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    jobs = pd.read_csv(f'{output_dir}/batres_jobs.csv')
+    jobs['job_id'] = jobs['job_id'].astype('string')
+
+    # Each executor computes 1e9 flops on 1 Gf hosts: sharing a host doubles the execution time
+    expected = {
+        '1': ('10-11', 2),
+        '2': ('3 5-6 8', 1),
+        '3': ('0-2 4', 1),
+    }
+    for job_name, (allocated_resources, execution_time) in expected.items():
+        job = jobs[jobs['job_id'] == job_name].iloc[0]
+        if job['final_state'] != 'COMPLETED_SUCCESSFULLY' or job['allocated_resources'] != allocated_resources or \
+           abs(job['execution_time'] - execution_time) > 0.01:
+            print(jobs)
+            raise Exception(f"Unexpected execution of job {job_name}: {job['final_state']} on '{job['allocated_resources']}' in {job['execution_time']}")
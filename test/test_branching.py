@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+'''Simulation branching tests.
+
+These tests check that each branch of a simulation (--branch-at) writes its own outputs,
+and that what happened before the branch time is the same in all branches.
+'''
+import json
+import os.path
+import pandas as pd
+from helper import *
+
+def read_jobs(filename):
+    jobs = pd.read_csv(filename)
+    jobs['job_id'] = jobs['job_id'].astype('string')
+    return jobs.sort_values(by=['job_id']).reset_index(drop=True)
+
+def test_branching(small_platform, branching_workload):
+    '''Jobs 1 and 2 run before the branch time, job 5 runs and job 6 is pending at the branch time,
+    while branch 1 rejects job 3 submitted afterwards.'''
+    test_name = f'branching-scripted-{small_platform.name}-{branching_workload.name}'
+    output_dir, robin_filename, _ = init_instance(test_name)
+
+    branch_at = 10
+    script = {
+        'schedulers': [
+            {'socket_endpoint': 'tcp://*:28000'},
+            {'socket_endpoint': 'tcp://*:28001', 'rejected_jobs': ['w0!3'],
+             'received_events_file': f'{output_dir}/branch1_events.json'},
+            {'socket_endpoint': 'tcp://*:28002',
+             'received_events_file': f'{output_dir}/branch2_events.json'},
+        ]
+    }
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    batcmd = gen_batsim_cmd(small_platform.filename, branching_workload.filename, output_dir,
+                            f"-s tcp://localhost:28000 --branch-at {branch_at} --branches 2")
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=gen_scripted_sched_cmd(script_filename),
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    # Each branch has its own export prefix
+    prefixes = ['batres', 'batres_1', 'batres_2']
+    for prefix in prefixes:
+        if not os.path.isfile(f'{output_dir}/{prefix}_jobs.csv'):
+            raise Exception(f"Branch output '{prefix}_jobs.csv' has not been written")
+    jobs = {prefix: read_jobs(f'{output_dir}/{prefix}_jobs.csv') for prefix in prefixes}
+
+    # Branch outputs must not contain what the original process wrote after the branch time
+    for prefix in prefixes:
+        if jobs[prefix]['job_id'].duplicated().any() or len(jobs[prefix]) != 6:
+            print(jobs[prefix])
+            raise Exception(f"The jobs of '{prefix}' are not written exactly once")
+
+    # Branch schedulers start from a notification with a state snapshot instead of SIMULATION_BEGINS
+    for branch in [1, 2]:
+        with open(f'{output_dir}/branch{branch}_events.json') as f:
+            events = json.load(f)
+        if events[0]['type'] != 'NOTIFY' or events[0]['data']['type'] != 'simulation_branched':
+            raise Exception(f'The first event received by branch {branch} is not a simulation_branched notification: {events[0]}')
+        snapshot = events[0]['data']
+        if snapshot['branch'] != branch or list(snapshot['pending_jobs'].keys()) != ['w0!6'] or \
+           snapshot['running_jobs'] != {'w0!5': {'alloc': '0-3', 'starting_time': 7}} or \
+           snapshot['machine_states'] != {'computing': '0-3'}:
+            raise Exception(f'Unexpected state snapshot in branch {branch}: {snapshot}')
+
+    # What happened before the branch time is identical in all branches
+    columns = ['job_id', 'success', 'final_state', 'starting_time', 'finish_time', 'allocated_resources']
+    before = {prefix: jobs[prefix][jobs[prefix]['finish_time'] <= branch_at][columns].reset_index(drop=True)
+              for prefix in prefixes}
+    if len(before['batres']) != 2:
+        print(jobs['batres'])
+        raise Exception('Jobs 1 and 2 should have completed before the branch time')
+    for prefix in prefixes[1:]:
+        if not before['batres'].equals(before[prefix]):
+            print(before['batres'])
+            print(before[prefix])
+            raise Exception(f"The jobs completed before the branch time differ in '{prefix}'")
+
+    # Branches diverge afterwards: job 3 is rejected in branch 1, which lets job 4 start sooner.
+    # Job 6 has been scheduled by the branch schedulers from the snapshot.
+    def outcome(prefix, job_name):
+        job = jobs[prefix][jobs[prefix]['job_id'] == job_name].iloc[0]
+        return (job['final_state'], job['finish_time'])
+
+    expected = {
+        'batres': {'3': ('COMPLETED_SUCCESSFULLY', 25), '4': ('COMPLETED_SUCCESSFULLY', 30), '6': ('COMPLETED_SUCCESSFULLY', 17)},
+        'batres_1': {'4': ('COMPLETED_SUCCESSFULLY', 27), '6': ('COMPLETED_SUCCESSFULLY', 17)},
+        'batres_2': {'3': ('COMPLETED_SUCCESSFULLY', 25), '4': ('COMPLETED_SUCCESSFULLY', 30), '6': ('COMPLETED_SUCCESSFULLY', 17)},
+    }
+    for prefix, expected_outcomes in expected.items():
+        for job_name, (final_state, finish_time) in expected_outcomes.items():
+            job_final_state, job_finish_time = outcome(prefix, job_name)
+            if job_final_state != final_state or abs(job_finish_time - finish_time) > 0.01:
+                print(jobs[prefix])
+                raise Exception(f"Unexpected outcome for job {job_name} in '{prefix}': {job_final_state} at {job_finish_time}")
+    if (jobs['batres_1']['job_id'] == '3').any() and outcome('batres_1', '3')[0] == 'COMPLETED_SUCCESSFULLY':
+        raise Exception("Job 3 should have been rejected in 'batres_1'")
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+'''Parallel SimGrid contexts tests.
+
+These tests check that running SimGrid actors in parallel (contexts/nthreads) does not change the simulation results.
+'''
+import json
+import pandas as pd
+from helper import *
+
+def run_with_nthreads(test_name, platform, workload, schedcmd, nthreads):
+    output_dir, robin_filename, _ = init_instance(f'{test_name}-nthreads{nthreads}')
+
+    batcmd = gen_batsim_cmd(platform.filename, workload.filename, output_dir, f"--sg-cfg contexts/nthreads:{nthreads}")
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=schedcmd,
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    jobs = pd.read_csv(f'{output_dir}/batres_jobs.csv')
+    jobs['job_id'] = jobs['job_id'].astype('string')
+    return jobs.sort_values(by=['job_id']).reset_index(drop=True)
+
+def parallel_contexts(test_name, platform, workload, schedcmd):
+    sequential_jobs = run_with_nthreads(test_name, platform, workload, schedcmd, 1)
+    parallel_jobs = run_with_nthreads(test_name, platform, workload, schedcmd, 4)
+
+    columns = ['job_id', 'success', 'final_state', 'starting_time', 'finish_time', 'allocated_resources']
+    merged = pd.merge(sequential_jobs[columns], parallel_jobs[columns], on='job_id', suffixes=('_seq', '_par'))
+    if len(merged) != len(sequential_jobs) or len(merged) != len(parallel_jobs):
+        raise Exception('The sequential and parallel simulations did not execute the same jobs')
+
+    for column in columns[1:]:
+        different = merged[merged[f'{column}_seq'] != merged[f'{column}_par']]
+        if len(different) > 0:
+            print(different)
+            raise Exception(f"The '{column}' of some jobs differ when actors run in parallel")
+
+    return parallel_jobs
+
+def batsched_parallel_contexts(platform, workload, algorithm):
+    test_name = f'parallelcontexts-{algorithm.name}-{platform.name}-{workload.name}'
+    if algorithm.sched_implem != 'batsched': raise Exception('This test only supports batsched for now')
+
+    parallel_contexts(test_name, platform, workload, f"batsched -v '{algorithm.sched_algo_name}'")
+
+def test_parallel_contexts(small_platform, small_workload, basic_algorithm):
+    batsched_parallel_contexts(small_platform, small_workload, basic_algorithm)
+
+def test_parallel_contexts_usage_trace(usage_trace_platform, usage_trace_workload, fcfs_algorithm):
+    batsched_parallel_contexts(usage_trace_platform, usage_trace_workload, fcfs_algorithm)
+
+def test_parallel_contexts_job_messages(small_platform, job_messages_workload):
+    '''Jobs receive messages (sometimes while waiting for them), and are killed while running sequences or waiting.'''
+    test_name = f'parallelcontexts-scripted-{small_platform.name}-{job_messages_workload.name}'
+    output_dir, _, _ = init_instance(test_name)
+
+    def to_job_msg(job_id, delay, msg):
+        return {'delay': delay, 'type': 'TO_JOB_MSG', 'data': {'job_id': job_id, 'msg': msg}}
+    def kill_job(job_id, delay):
+        return {'delay': delay, 'type': 'KILL_JOB', 'data': {'job_ids': [job_id]}}
+
+    script = {
+        'after_start': {
+            'w0!1': [to_job_msg('w0!1', 3, 'go')],
+            'w0!2': [to_job_msg('w0!2', 2, 'nope')],
+            'w0!3': [to_job_msg('w0!3', 1, 'go'), to_job_msg('w0!3', 10, 'go')],
+            'w0!5': [kill_job('w0!5', 4)],
+            'w0!6': [kill_job('w0!6', 7)],
+            'w0!7': [kill_job('w0!7', 2)],
+        }
+    }
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    jobs = parallel_contexts(test_name, small_platform, job_messages_workload, gen_scripted_sched_cmd(script_filename))
+
+    expected = {
+        '1': ('COMPLETED_SUCCESSFULLY', 8),
+        '2': ('COMPLETED_SUCCESSFULLY', 3),
+        '3': ('COMPLETED_SUCCESSFULLY', 15),
+        '4': ('COMPLETED_SUCCESSFULLY', 1),
+        '5': ('COMPLETED_KILLED', 24),
+        '6': ('COMPLETED_KILLED', 27),
+        '7': ('COMPLETED_KILLED', 22),
+        '8': ('COMPLETED_WALLTIME_REACHED', 25),
+    }
+    for _, job in jobs.iterrows():
+        job_name = job['job_id'].split('!')[-1]
+        final_state, finish_time = expected[job_name]
+        if job['final_state'] != final_state or abs(job['finish_time'] - finish_time) > 0.01:
+            print(jobs)
+            raise Exception(f"Unexpected outcome for job {job['job_id']}: {job['final_state']} at {job['finish_time']}")
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 ''' Test for host and zone properties on XML platform. '''
 
+import json
 from helper import *
 import pytest
 
@@ -24,3 +25,68 @@ def simple_platform_properties(platform, workload, algorithm):
 
 def test_simple_platform_properties(properties_platform, mixed_workload, pybatsim_filler_algorithm):
     simple_platform_properties(properties_platform, mixed_workload, pybatsim_filler_algorithm)
+
+def decode_resources(data, field):
+    '''Returns the resources of a SIMULATION_BEGINS field as a map from their id to their name, state and properties,
+    whatever the machine properties format.'''
+    def resource(name, state, property_set):
+        return (name, state, property_set['properties'], property_set['zone_properties'])
+
+    resources = {}
+    if isinstance(data[field], dict): # grouped
+        for interval, group in data[field].items():
+            bounds = [int(bound) for bound in interval.split('-')]
+            ids = range(bounds[0], bounds[-1] + 1)
+            if len(ids) != len(group['names']):
+                raise Exception(f"Group '{interval}' does not have one name per machine: {group}")
+            for machine_id, name in zip(ids, group['names']):
+                resources[machine_id] = resource(name, group['state'], data['property_sets'][group['property_set']])
+    else:
+        for machine in data[field]:
+            property_set = data['property_sets'][machine['property_set']] if 'property_set' in machine else machine
+            resources[machine['id']] = resource(machine['name'], machine['state'], property_set)
+    return resources
+
+def test_machine_properties_format(properties_platform, delays_workload):
+    '''The table and grouped formats decode into the same resources as the full (per-machine) format.'''
+    resources = {}
+    for properties_format in ['full', 'table', 'grouped']:
+        test_name = f'machine-properties-format-{properties_format}-{properties_platform.name}-{delays_workload.name}'
+        output_dir, robin_filename, _ = init_instance(test_name)
+
+        script = {'received_events_file': f'{output_dir}/received_events.json'}
+        script_filename = f'{output_dir}/script.json'
+        write_file(script_filename, json.dumps(script))
+
+        batcmd = gen_batsim_cmd(properties_platform.filename, delays_workload.filename, output_dir,
+                                f'--machine-properties-format {properties_format}')
+        instance = RobinInstance(output_dir=output_dir,
+            batcmd=batcmd,
+            schedcmd=gen_scripted_sched_cmd(script_filename),
+            simulation_timeout=30, ready_timeout=5,
+            success_timeout=10, failure_timeout=0
+        )
+
+        instance.to_file(robin_filename)
+        ret = run_robin(robin_filename)
+        if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+        with open(script['received_events_file']) as f:
+            events = json.load(f)
+        data = next(e['data'] for e in events if e['type'] == 'SIMULATION_BEGINS')
+        if properties_format == 'full' and 'property_sets' in data:
+            raise Exception('Property sets have been sent with the full format')
+        resources[properties_format] = {field: decode_resources(data, field)
+                                        for field in ['compute_resources', 'storage_resources']}
+
+    # The platform must have machines with different properties for the test to be meaningful
+    compute_resources = resources['full']['compute_resources']
+    distinct_properties = {json.dumps(r[2:], sort_keys=True) for r in compute_resources.values()}
+    if len(distinct_properties) < 2:
+        raise Exception(f'The machines of the platform do not have heterogeneous properties: {compute_resources}')
+
+    for properties_format in ['table', 'grouped']:
+        if resources[properties_format] != resources['full']:
+            print(resources['full'])
+            print(resources[properties_format])
+            raise Exception(f"The resources decoded from the '{properties_format}' format differ from the full format")
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+'''Dynamic registration tests.
+
+These tests check that the jobs and profiles registered by the scheduler
+(REGISTER_PROFILE, REGISTER_JOB, REGISTER_PROFILES and REGISTER_JOBS) are executed.
+'''
+import json
+import pandas as pd
+from helper import *
+
+def test_register_jobs_and_profiles(small_platform, delays_workload):
+    '''Profiles and jobs are registered one by one at time 0, then at once at time 5.'''
+    test_name = f'registration-scripted-{small_platform.name}-{delays_workload.name}'
+    output_dir, robin_filename, _ = init_instance(test_name)
+
+    script = {
+        'initial_events': [
+            {'type': 'REGISTER_PROFILE', 'data': {'workload_name': 'dyn', 'profile_name': 'delay_5s',
+                                                  'profile': {'type': 'delay', 'delay': 5}}},
+            {'type': 'REGISTER_JOB', 'data': {'job_id': 'dyn!1',
+                                              'job': {'id': 'dyn!1', 'res': 1, 'profile': 'delay_5s', 'subtime': 0}}},
+        ],
+        'timed_events': [
+            {'timestamp': 5, 'type': 'REGISTER_PROFILES', 'data': {'profiles': [
+                {'workload_name': 'dyn', 'profile_name': 'delay_3s', 'profile': {'type': 'delay', 'delay': 3}},
+                {'workload_name': 'dyn', 'profile_name': 'delay_4s', 'profile': {'type': 'delay', 'delay': 4}},
+            ]}},
+            {'timestamp': 5, 'type': 'REGISTER_JOBS', 'data': {'jobs': [
+                {'job_id': 'dyn!2', 'job': {'id': 'dyn!2', 'res': 1, 'profile': 'delay_3s', 'subtime': 5}},
+                {'job_id': 'dyn!3', 'job': {'id': 'dyn!3', 'res': 2, 'profile': 'delay_4s', 'subtime': 5}},
+            ]}},
+            {'timestamp': 5, 'type': 'NOTIFY', 'data': {'type': 'registration_finished'}},
+        ],
+        'received_events_file': f'{output_dir}/received_events.json',
+    }
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    batcmd = gen_batsim_cmd(small_platform.filename, delays_workload.filename, output_dir,
+                            '--enable-dynamic-jobs --acknowledge-dynamic-jobs')
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=gen_scripted_sched_cmd(script_filename),
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    # Registered jobs are acknowledged with their description
+    with open(script['received_events_file']) as f:
+        events = json.load(f)
+    submitted_jobs = {e['data']['job_id']: e['data'].get('job') for e in events if e['type'] == 'JOB_SUBMITTED'}
+    for job_id, profile in [('dyn!1', 'delay_5s'), ('dyn!2', 'delay_3s'), ('dyn!3', 'delay_4s')]:
+        if job_id not in submitted_jobs or submitted_jobs[job_id]['profile'] != profile:
+            raise Exception(f'The registration of job {job_id} has not been acknowledged correctly: {submitted_jobs.get(job_id)}')
+
+    # Registered jobs complete like the jobs of the workload
+    jobs = pd.read_csv(f'{output_dir}/batres_jobs.csv')
+    jobs = jobs[jobs['workload_name'] == 'dyn']
+    jobs['job_id'] = jobs['job_id'].astype('string')
+    expected = {'1': 5, '2': 3, '3': 4}
+    for job_name, execution_time in expected.items():
+        job = jobs[jobs['job_id'] == job_name]
+        if len(job) != 1:
+            print(jobs)
+            raise Exception(f'Registered job dyn!{job_name} has not been written exactly once')
+        job = job.iloc[0]
+        if job['final_state'] != 'COMPLETED_SUCCESSFULLY' or abs(job['execution_time'] - execution_time) > 0.01:
+            print(jobs)
+            raise Exception(f"Unexpected outcome for registered job dyn!{job_name}: {job['final_state']} after {job['execution_time']}")
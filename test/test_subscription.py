@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+'''Event subscription tests.
+
+These tests check that the scheduler only receives the events and event fields it subscribed to,
+either from its configuration (batsim-subscription) or from SET_SUBSCRIPTION events.
+'''
+import json
+from helper import *
+
+def run_scripted(test_name, platform, workload, script, batsim_flags=''):
+    '''Runs Batsim with a scripted scheduler, and returns the events received by the scheduler.'''
+    output_dir, robin_filename, _ = init_instance(test_name)
+
+    script['received_events_file'] = f'{output_dir}/received_events.json'
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    batcmd = gen_batsim_cmd(platform.filename, workload.filename, output_dir, batsim_flags)
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=gen_scripted_sched_cmd(script_filename),
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    with open(script['received_events_file']) as f:
+        return json.load(f)
+
+def test_subscription_from_sched_config(small_platform, delays_workload):
+    '''The scheduler configuration unsubscribes from NOTIFY events and job descriptions.'''
+    test_name = f'subscription-schedconfig-{small_platform.name}-{delays_workload.name}'
+    _, _, schedconf_filename = init_instance(test_name)
+    write_file(schedconf_filename, json.dumps({
+        'batsim-subscription': {'disabled_events': ['NOTIFY'], 'disabled_fields': ['job']}
+    }))
+
+    events = run_scripted(test_name, small_platform, delays_workload, {},
+                          f"--sched-cfg-file '{schedconf_filename}'")
+
+    notify_events = [e for e in events if e['type'] == 'NOTIFY']
+    if len(notify_events) > 0:
+        raise Exception(f'NOTIFY events have been received despite the subscription: {notify_events}')
+
+    submitted_events = [e for e in events if e['type'] == 'JOB_SUBMITTED']
+    if len(submitted_events) == 0:
+        raise Exception('No JOB_SUBMITTED event has been received')
+    described_jobs = [e['data']['job_id'] for e in submitted_events if 'job' in e['data']]
+    if len(described_jobs) > 0:
+        raise Exception(f'Jobs have been described despite the subscription: {described_jobs}')
+
+def test_set_subscription(small_platform, delays_workload):
+    '''Job descriptions are disabled at time 0 and enabled again at time 10 (jobs are submitted every 3 seconds).'''
+    test_name = f'subscription-set-{small_platform.name}-{delays_workload.name}'
+    script = {
+        'initial_events': [{'type': 'SET_SUBSCRIPTION', 'data': {'disabled_fields': ['job']}}],
+        'timed_events': [{'timestamp': 10, 'type': 'SET_SUBSCRIPTION', 'data': {}}],
+    }
+    events = run_scripted(test_name, small_platform, delays_workload, script)
+
+    submitted_jobs = {e['data']['job_id']: 'job' in e['data'] for e in events if e['type'] == 'JOB_SUBMITTED'}
+
+    # Job 0 is submitted at time 0, possibly before the first subscription is received
+    expected = {f'w0!{job}': job >= 4 for job in range(1, 10)}
+    for job_id, described in expected.items():
+        if job_id not in submitted_jobs:
+            raise Exception(f'The submission of job {job_id} has not been received')
+        if submitted_jobs[job_id] != described:
+            raise Exception(f"Job {job_id} should{('', ' not')[not described]} have been described")
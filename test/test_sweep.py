@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+'''Parameter sweep tests.
+
+These tests check that the workers of a parameter sweep (--sweep) run independent simulations,
+each with its own scheduler, export prefix and scheduler configuration.
+'''
+import json
+import os.path
+import pandas as pd
+from helper import *
+
+def test_sweep_two_workers(small_platform, delays_workload):
+    '''Worker 0 inherits the command-line scheduler configuration, while worker 1 overrides it and rejects a job.'''
+    test_name = f'sweep-scripted-{small_platform.name}-{delays_workload.name}'
+    output_dir, robin_filename, schedconf_filename = init_instance(test_name)
+
+    # The command-line configuration unsubscribes from NOTIFY events, which worker 1 must not inherit
+    write_file(schedconf_filename, json.dumps({'batsim-subscription': {'disabled_events': ['NOTIFY']}}))
+
+    sweep = [
+        {'socket_endpoint': 'tcp://localhost:28001', 'export_prefix': f'{output_dir}/worker0'},
+        {'socket_endpoint': 'tcp://localhost:28002', 'sched_config': {'variant': 'rejecter'}},
+    ]
+    sweep_filename = f'{output_dir}/sweep.json'
+    write_file(sweep_filename, json.dumps(sweep))
+
+    script = {
+        'schedulers': [
+            {'socket_endpoint': 'tcp://*:28001', 'received_events_file': f'{output_dir}/worker0_events.json'},
+            {'socket_endpoint': 'tcp://*:28002', 'rejected_jobs': ['w0!0'],
+             'received_events_file': f'{output_dir}/worker1_events.json'},
+        ]
+    }
+    script_filename = f'{output_dir}/script.json'
+    write_file(script_filename, json.dumps(script))
+
+    batcmd = gen_batsim_cmd(small_platform.filename, delays_workload.filename, output_dir,
+                            f"--sched-cfg-file '{schedconf_filename}' --sweep '{sweep_filename}' --sweep-parallelism 2")
+    instance = RobinInstance(output_dir=output_dir,
+        batcmd=batcmd,
+        schedcmd=gen_scripted_sched_cmd(script_filename),
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    if ret.returncode != 0: raise Exception(f'Bad robin return code ({ret.returncode})')
+
+    # Worker 0 uses its own export prefix, worker 1 the command-line one suffixed by its index
+    jobs = {}
+    for worker, prefix in enumerate(['worker0', 'batres_1']):
+        filename = f'{output_dir}/{prefix}_jobs.csv'
+        if not os.path.isfile(filename):
+            raise Exception(f"The jobs of worker {worker} have not been written in '{filename}'")
+        jobs[worker] = pd.read_csv(filename)
+        jobs[worker]['job_id'] = jobs[worker]['job_id'].astype('string')
+
+    nb_jobs = len(jobs[0])
+    nb_successful_jobs = [len(jobs[worker][jobs[worker]['success'] == 1]) for worker in [0, 1]]
+    if nb_successful_jobs != [nb_jobs, nb_jobs - 1]:
+        print(jobs[0])
+        print(jobs[1])
+        raise Exception(f'Unexpected number of successful jobs per worker: {nb_successful_jobs} (workload has {nb_jobs} jobs)')
+    if jobs[1][jobs[1]['job_id'] == '0']['success'].iloc[0] != 0:
+        raise Exception('Job 0 should have been rejected by worker 1')
+
+    # Each worker uses its own scheduler configuration
+    nb_notify = []
+    for worker in [0, 1]:
+        with open(f'{output_dir}/worker{worker}_events.json') as f:
+            events = json.load(f)
+        nb_notify.append(len([e for e in events if e['type'] == 'NOTIFY']))
+    if nb_notify[0] != 0:
+        raise Exception('Worker 0 received NOTIFY events despite the command-line subscription')
+    if nb_notify[1] == 0:
+        raise Exception('Worker 1 received no NOTIFY events, it inherited the command-line subscription')